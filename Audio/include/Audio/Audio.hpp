@@ -1,7 +1,9 @@
 #pragma once
 #include "AudioStream.hpp"
 #include "Sample.hpp"
-#include <complex>
+#include "Resampler.hpp"
+#include "PcmCache.hpp"
+#include "SpectrumAnalyzer.hpp"
 
 extern class Audio* g_audio;
 
@@ -16,8 +18,10 @@ public:
 	Audio();
 	~Audio();
 	// Initializes the audio device
-	bool Init(bool exclusive);
+	//	bufferSize is the length of the device buffer in frames, 0 uses the default of the driver
+	bool Init(bool exclusive, uint32 bufferSize = 0);
 	void SetGlobalVolume(float vol);
+	void SetResampleQuality(ResampleQuality quality);
 
 	// Opens a stream at path
 	//	settings preload loads the whole file into memory before playing
@@ -27,6 +31,10 @@ public:
 
 	// Target/Output sample rate
 	uint32 GetSampleRate() const;
+	// Keeps decoded and pre-rendered pcm between runs
+	PcmCache& GetPcmCache();
+	// Spectrum of the mixed output
+	SpectrumAnalyzer& GetSpectrumAnalyzer();
 
 	// Private
 	class Audio_Impl* GetImpl();
@@ -35,11 +43,9 @@ public:
 	int64 audioLatency;
 
 	//Skade wrapper for AudioImpl
-	uint32 GetSampleBufferLength(); // uint32 m_sampleBufferLength = 384
+	uint32 GetSampleBufferLength(); // Length of the last mixed block, at most 384
 	const float* GetSampleBuffer();
 
-	void ProcessFFT(float* out_buckets, float* out_bucketsN, uint32 in_bucketAmount);
 private:
-	std::vector<std::complex<double>> Audio::FFT(std::vector<std::complex<double>>& samples);
 	bool m_initialized = false;
 };
\ No newline at end of file
@@ -24,11 +24,14 @@ public:
 
 	void SetAudioBase(class AudioBase *audioBase);
 	inline void RemoveAudioBase() { m_audioBase = nullptr; }
+	inline class AudioBase *GetAudioBase() const { return m_audioBase; }
 	inline void SetSampleRate(uint32 sampleRate) { m_sampleRate = sampleRate; }
 
 	// Process <numSamples> amount of samples in stereo float format
 	virtual void Process(float *out, uint32 numSamples) = 0;
 	virtual const char *GetName() const = 0;
+	// Time range in ms of the pcm read from the audio base, for effects that don't only change the samples they are given
+	virtual bool GetSourceRange(uint32 &start, uint32 &end) const { return false; }
 
 	float mix = 1.0f;
 	uint32 priority = 0;
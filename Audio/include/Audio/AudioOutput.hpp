@@ -15,7 +15,8 @@ public:
 	AudioOutput();
 	~AudioOutput();
 
-	bool Init(bool exclusive);
+	// Buffer size in frames, 0 uses the default of the driver
+	bool Init(bool exclusive, uint32 bufferSize = 0);
 
 	// Safe to start mixing
 	void Start(IMixer* mixer);
@@ -27,6 +28,8 @@ public:
 
 	// The actual length of the buffer in seconds
 	double GetBufferLength() const;
+	// Number of frames the device asks for every time, 0 when it varies
+	uint32_t GetPeriodSize() const;
 	bool IsIntegerFormat() const;
 
 private:
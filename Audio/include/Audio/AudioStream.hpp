@@ -2,6 +2,7 @@
 #include "AudioBase.hpp"
 
 class Audio;
+class CachedPcm;
 
 /*
 	Audio stream object, currently only supports .ogg format
@@ -12,6 +13,8 @@ class AudioStream : public AudioBase
 public:
 	static Ref<AudioStream> Create(Audio *audio, const String &path, bool preload);
 	static Ref<AudioStream> Clone(Audio *audio, Ref<AudioStream> source);
+	// Plays pcm loaded from the pcm cache
+	static Ref<AudioStream> Create(Audio *audio, Ref<CachedPcm> pcm);
 	virtual ~AudioStream() = default;
 	// Starts playback of the stream or continues a paused stream
 	virtual void Play() = 0;
@@ -20,6 +23,11 @@ public:
 	// Sets the playback position in milliseconds
 	// negative time alowed, which will produce no audio for a certain amount of time
 	virtual void SetPosition(int32 pos) = 0;
+	// Preloaded streams can be played while they are still decoding
+	//	blocks until the whole stream is decoded, call this before using all of GetPCM
+	virtual void WaitForDecode() = 0;
+	// Key of the decoded pcm in the pcm cache, empty when it isn't cached
+	virtual const String &GetCacheKey() const = 0;
 
 	virtual void Normalize(float volume = 1.f) = 0;
 };
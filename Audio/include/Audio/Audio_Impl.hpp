@@ -1,6 +1,9 @@
 #pragma once
 #include "AudioOutput.hpp"
 #include "AudioBase.hpp"
+#include "Resampler.hpp"
+#include "PcmCache.hpp"
+#include "SpectrumAnalyzer.hpp"
 
 #include <array>
 
@@ -26,8 +29,19 @@ public:
 
 	uint32 GetSampleRate() const;
 	double GetSecondsPerSample() const;
+	// Picks a block length that divides the period of the device, so every callback mixes the same number of whole blocks
+	void SetPeriodSize(uint32 periodSize);
+	uint32 GetBlockLength() const { return m_blockLength; }
+	// Used to split work on preloaded pcm into parts, such as resampling and pre-rendering effects
+	static class WorkerPool& GetWorkerPool();
 
 	float globalVolume = 0.0f;
+	// Used by streams that play at a different rate than the output
+	ResampleQuality resampleQuality = ResampleQuality::Medium;
+	// Decoded pcm of preloaded streams, disabled until it is opened
+	PcmCache pcmCache;
+	// Gets every mixed block, before the global volume is applied
+	SpectrumAnalyzer spectrum;
 
 	mutex lock;
 	Vector<AudioBase*> itemsToRender;
@@ -47,6 +61,8 @@ public:
 protected:
 	// Used to limit rendering to a fixed number of samples
 	constexpr static uint32 m_sampleBufferLength = 384;
+	// Number of samples rendered at once, at most m_sampleBufferLength
+	uint32 m_blockLength = m_sampleBufferLength;
 	std::array<float, 2*m_sampleBufferLength> m_sampleBuffer;
 	std::array<float, 2*m_sampleBufferLength> m_sampleBufferN; //< Normal SampleBuffer, no global volume applied
 	
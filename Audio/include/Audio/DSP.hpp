@@ -31,6 +31,61 @@ private:
 	float za[2]{};
 };
 
+/*
+	Cascade of biquad sections that filters both channels of interleaved stereo at once
+	Sections are applied one after another to each frame, so the whole cascade is done in one pass over the samples
+	Coefficients that change while playing are reached over one block of samples, so they can be set once per block instead of every sample
+*/
+class StereoBiquad
+{
+public:
+	static constexpr uint32 maxSections = 12;
+	// Number of frames over which new coefficients are interpolated
+	static constexpr uint32 blockSize = 32;
+
+	StereoBiquad(uint32 numSections = 1);
+
+	// Keeps the coefficients and state of sections that are still used
+	void SetNumSections(uint32 numSections);
+	uint32 GetNumSections() const { return m_numSections; }
+	// Sets the coefficients of a section for both channels, or for each channel
+	void SetSection(uint32 section, const BQF &filter);
+	void SetSection(uint32 section, const BQF &left, const BQF &right);
+	// Clears the filter state
+	void Reset();
+
+	// Filters interleaved stereo
+	void Process(float *out, uint32 numFrames);
+
+	// Amount of the output of the last section that is added to the input of the first section
+	float feedback = 0.0f;
+
+private:
+	struct alignas(16) Section
+	{
+		// b0, b1, b2, a1, a2 divided by a0, with the left and right channel in the first two lanes
+		float coefficients[5][4]{};
+		float target[5][4]{};
+		float step[5][4]{};
+		// Input and output delay buffers
+		float x[2][4]{};
+		float y[2][4]{};
+	};
+
+	template<bool ramp>
+	void m_Process(float *out, uint32 numFrames);
+	void m_StartRamp();
+
+	Section m_sections[maxSections];
+	alignas(16) float m_output[4]{};
+	uint32 m_numSections = 1;
+	uint32 m_rampRemaining = 0;
+	// Coefficients were set since the last time the filter was processed
+	bool m_changed = false;
+	// Coefficients are used straight away until the filter is first processed
+	bool m_started = false;
+};
+
 class PanDSP : public DSP
 {
 public:
@@ -54,7 +109,7 @@ public:
 	void SetHighPass(float q, float freq);
 
 private:
-	BQF m_filters[2];
+	StereoBiquad m_filter;
 };
 
 // Combinded Low/High-pass and Peaking filter
@@ -69,8 +124,8 @@ public:
 	virtual void Process(float *out, uint32 numSamples);
 
 private:
-	BQFDSP a;
-	BQFDSP peak;
+	// Low/High-pass followed by peaking
+	StereoBiquad m_filter;
 };
 
 // Basic limiter
@@ -158,6 +213,7 @@ public:
 
 	virtual void Process(float *out, uint32 numSamples);
 	virtual const char *GetName() const { return "RetriggerDSP"; }
+	virtual bool GetSourceRange(uint32 &start, uint32 &end) const;
 
 private:
 	float m_gating = 0.75f;
@@ -185,7 +241,7 @@ public:
 	virtual const char *GetName() const { return "WobbleDSP"; }
 
 private:
-	BQF m_filters[2];
+	StereoBiquad m_filter;
 	uint32 m_length{};
 	uint32 m_currentSample = 0;
 };
@@ -212,9 +268,8 @@ public:
 private:
 	uint32 m_length = 0;
 	uint32 m_stage = 6;
-	BQF m_apf[12][2];
-	BQF m_hiShelf[2];
-	float za[2] = {0.0f};
+	StereoBiquad m_allPass;
+	StereoBiquad m_hiShelf;
 	uint32 m_currentSample = 0;
 };
 
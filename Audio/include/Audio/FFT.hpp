@@ -0,0 +1,30 @@
+#pragma once
+
+/*
+	Fast Fourier transform of real samples, the size is a power of two
+	The twiddle factors and the bit reversed order are made when the size is set, so transforms don't allocate
+*/
+class RealFFT
+{
+public:
+	RealFFT(uint32 size = 0);
+
+	// Rounded down to a power of two of at least 4
+	void SetSize(uint32 size);
+	uint32 GetSize() const { return m_size; }
+
+	// Transforms size real samples in place
+	//	the result is packed as the real part of bin 0 and of bin size/2, followed by the real and imaginary parts of bins 1 to size/2-1
+	void Forward(float* data) const;
+
+private:
+	// Transforms interleaved complex values, half the size of the real input
+	void m_ComplexForward(float* data) const;
+
+	uint32 m_size = 0;
+	Vector<uint32> m_bitReverse;
+	// exp(-2*pi*i*k/(size/2)) as pairs of cosine and sine, for the complex transform
+	Vector<float> m_twiddles;
+	// exp(-2*pi*i*k/size), for splitting the complex result into the real transform
+	Vector<float> m_realTwiddles;
+};
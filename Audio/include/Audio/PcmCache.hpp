@@ -0,0 +1,100 @@
+#pragma once
+#include <Shared/MappedFile.hpp>
+#include <list>
+#include <mutex>
+
+// How samples are stored in cache files
+DefineEnum(PcmCacheFormat,
+	Float,
+	Int16)
+
+/*
+	Decoded interleaved stereo pcm loaded from a cache file
+	Float files are used straight from the mapped file, 16-bit files are converted when they are loaded
+	The data can be changed, changes are never written back to the file
+*/
+class CachedPcm : Unique
+{
+public:
+	bool Open(const String& path);
+
+	float* GetData() { return m_data; }
+	uint64 GetNumFrames() const { return m_numFrames; }
+	uint32 GetSampleRate() const { return m_sampleRate; }
+
+private:
+	MappedFile m_file;
+	Vector<float> m_converted;
+	float* m_data = nullptr;
+	uint64 m_numFrames = 0;
+	uint32 m_sampleRate = 0;
+};
+
+/*
+	Directory of decoded and pre-rendered pcm, so songs are only decoded the first time they are played
+	Entries are named by a key made from a hash of the source file and of everything else that changed the pcm
+	The directory is kept under a maximum size by removing the entries that were used least recently
+	Can be used from multiple threads
+*/
+class PcmCache : Unique
+{
+public:
+	// Loads the entries in a directory and removes entries until they fit in maxSize
+	//	a maximum size of 0 disables the cache but keeps the entries, it can be opened again to change the size
+	void Open(const String& directory, uint64 maxSize);
+	bool IsEnabled() const;
+	// Format of new entries
+	void SetFormat(PcmCacheFormat format);
+
+	// Makes a key from source data and the parameters that changed the pcm made from it
+	//	pass another key as the data for pcm that is made from cached pcm
+	static String MakeKey(const void* data, size_t size, const String& params);
+
+	// Returns null when the key isn't cached
+	Ref<CachedPcm> Load(const String& key);
+	// Adds pcm to the cache, removing old entries to make space for it
+	bool Store(const String& key, const float* pcm, uint64 numFrames, uint32 sampleRate);
+
+	// Size of all entries in bytes
+	uint64 GetSize() const;
+	size_t GetNumEntries() const;
+	uint32 GetNumHits() const { return m_numHits; }
+	uint32 GetNumMisses() const { return m_numMisses; }
+	uint32 GetNumEvictions() const { return m_numEvictions; }
+
+private:
+	struct Entry
+	{
+		String key;
+		uint64 size;
+	};
+	using EntryList = std::list<Entry>;
+
+	String m_GetPath(const String& key) const;
+	String m_GetIndexPath() const;
+	void m_Remove(EntryList::iterator it);
+	// Retries deleting files of removed entries that were still in use
+	void m_DeletePending();
+	// Removes the least recently used entries until maxSize is left
+	void m_Evict(uint64 maxSize);
+	// Writes the order of the entries, so it is kept for the next time the cache is opened
+	void m_SaveIndex();
+
+	mutable std::mutex m_lock;
+	String m_directory;
+	uint64 m_maxSize = 0;
+	PcmCacheFormat m_format = PcmCacheFormat::Float;
+
+	// Least recently used first
+	EntryList m_entries;
+	Map<String, EntryList::iterator> m_lookup;
+	// Keys that are being written
+	Set<String> m_storing;
+	// Files of removed entries that couldn't be deleted yet, Windows keeps files open while a stream has them mapped
+	Set<String> m_pendingDeletes;
+	uint64 m_size = 0;
+
+	uint32 m_numHits = 0;
+	uint32 m_numMisses = 0;
+	uint32 m_numEvictions = 0;
+};
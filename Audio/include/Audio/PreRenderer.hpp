@@ -0,0 +1,17 @@
+#pragma once
+#include "AudioBase.hpp"
+
+class WorkerPool;
+
+/*
+	Applies effects to decoded pcm ahead of playback
+	Effects are split into groups that don't share any samples, the groups are rendered at the same time on a worker pool
+	Within a group effects are applied in the order they are given, so the result is the same as applying all of them one after another
+*/
+class PreRenderer
+{
+public:
+	// Renders every effect over its time range, straight into the interleaved stereo pcm
+	//	effects are given the pcm as their audio base while rendering, pass no pool to render on the calling thread
+	static void Render(float *pcm, uint64 numFrames, uint32 sampleRate, const Vector<DSP *> &DSPs, WorkerPool *pool);
+};
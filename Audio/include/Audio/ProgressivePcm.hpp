@@ -0,0 +1,61 @@
+#pragma once
+#include <Shared/Thread.hpp>
+#include "PcmCache.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+
+/*
+	Interleaved stereo pcm that is decoded on a background thread while the start of it is already being played
+	The buffer is allocated at the expected length up front so it never moves while it is read
+	Readers wait only when they get ahead of the decoder
+*/
+class ProgressivePcm : public Unique
+{
+public:
+	// Decodes by calling Append, runs on the decode thread and should return early when IsStopping is set
+	using DecodeFunction = std::function<void(ProgressivePcm&)>;
+
+	~ProgressivePcm();
+
+	// Allocates numFrames and starts decoding, frames past the expected length are dropped
+	void Start(uint64 numFrames, DecodeFunction decode);
+	// Uses pcm that is already decoded completely
+	void Set(Vector<float>&& pcm);
+	// Uses pcm loaded from the cache
+	void Set(Ref<CachedPcm> pcm);
+	// Stops decoding and waits for the decode thread to finish
+	void Stop();
+
+	// Adds decoded frames, only call this from the decode function
+	void Append(const float* left, const float* right, uint32 numFrames);
+	void Append(const float* in, uint32 numFrames);
+	bool IsStopping() const { return m_stop.load(std::memory_order_relaxed); }
+
+	// Blocks until numFrames are decoded or decoding ended
+	// returns the number of frames that can be read, which is only less than numFrames at the end
+	uint64 WaitFor(uint64 numFrames);
+	// Blocks until everything is decoded
+	void Wait();
+
+	bool IsDecoding() const { return !m_done.load(std::memory_order_acquire); }
+	uint64 GetDecodedFrames() const { return m_decoded.load(std::memory_order_acquire); }
+	// Expected length while decoding, the decoded length after that
+	uint64 GetNumFrames() const { return m_numFrames.load(std::memory_order_acquire); }
+	// Only frames below GetDecodedFrames are valid while decoding
+	float* GetData() { return m_cached ? m_cached->GetData() : m_data.data(); }
+
+private:
+	void m_Finish();
+
+	Vector<float> m_data;
+	Ref<CachedPcm> m_cached;
+	std::atomic<uint64> m_decoded = { 0 };
+	std::atomic<uint64> m_numFrames = { 0 };
+	std::atomic<bool> m_done = { true };
+	std::atomic<bool> m_stop = { false };
+
+	Mutex m_lock;
+	std::condition_variable m_progress;
+	Thread m_thread;
+};
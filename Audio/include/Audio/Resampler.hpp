@@ -0,0 +1,76 @@
+#pragma once
+
+/*
+	Resampling quality
+		Linear interpolates between neighbouring samples, the higher qualities use windowed sinc filters
+*/
+DefineEnum(ResampleQuality,
+	Linear,
+	Medium,
+	High)
+
+/*
+	Band-limited stereo resampler using a polyphase windowed sinc filter
+	Input frames are pushed in, output frames are pulled at any ratio of input frames per output frame
+	The filter is centered on the current input frame so it adds no delay, but it needs half the filter length of input ahead of it
+*/
+class Resampler
+{
+public:
+	Resampler(ResampleQuality quality = ResampleQuality::Medium);
+
+	// Keeps the input that hasn't been played yet
+	void SetQuality(ResampleQuality quality);
+	ResampleQuality GetQuality() const { return m_quality; }
+	uint32 GetNumTaps() const { return m_numTaps; }
+
+	// Clears all input, call when seeking
+	void Reset();
+	// Adds planar stereo input
+	void Push(const float* left, const float* right, uint32 numFrames);
+	// Adds interleaved stereo input
+	void Push(const float* in, uint32 numFrames);
+
+	// Writes at most numFrames interleaved stereo frames, advancing ratio input frames for every output frame
+	// returns the number of frames written, which is less than requested when more input is needed
+	uint32 Process(float* out, uint32 numFrames, double ratio);
+
+	// Resamples part of a whole interleaved stereo buffer, with silence around it
+	//	output frames are at the same positions as when the whole buffer goes through Process,
+	//	so a buffer can be converted in parts that are independent of each other
+	void ProcessBuffer(const float* in, uint64 numInFrames, float* out, uint64 firstFrame, uint32 numFrames, double ratio) const;
+	// Number of output frames ProcessBuffer makes from a whole buffer
+	static uint64 GetNumOutputFrames(uint64 numFrames, double ratio);
+	// Prepares the filter for a ratio, Process does this when the ratio changes
+	void SetRatio(double ratio);
+
+	// Number of input frames that were pushed but not played yet
+	uint32 GetPendingFrames() const { return m_numFrames > m_position ? m_numFrames - m_position : 0; }
+
+	// Fractional bits of the input position
+	static constexpr uint32 fractionBits = 32;
+	// Number of filter phases between two input frames, the filter is interpolated between phases
+	static constexpr uint32 phaseBits = 8;
+	static constexpr uint32 maxTaps = 64;
+
+private:
+	// Filter cutoff in cycles per input frame
+	double m_GetCutoff(double ratio) const;
+	void m_BuildTable(double cutoff);
+	// Makes room for numFrames more input frames
+	float* m_Reserve(uint32 numFrames);
+
+	ResampleQuality m_quality;
+	uint32 m_numTaps = 0;
+	double m_attenuation = 0.0;
+	double m_cutoff = 0.0;
+
+	// Interleaved coefficients for every phase, each repeated for both channels
+	Vector<float> m_table;
+
+	// Interleaved input frames, the first ones are history kept for the filter
+	Vector<float> m_input;
+	uint32 m_numFrames = 0;
+	uint32 m_position = 0;
+	uint64 m_fraction = 0;
+};
@@ -2,12 +2,16 @@
 #include "AudioBase.hpp"
 
 /*
-	Audio sample, only supports wav files in signed 16 bit stereo or mono
+	Audio sample, decoded completely when it is loaded
+	Plays overlap, up to a fixed number of them are mixed at the same time
+	Play and Stop don't wait for the mixer, but they should only be called from one thread
 */
 class SampleRes : public AudioBase
 {
 public:
 	static Ref<SampleRes> Create(class Audio* audio, const String& path);
+	// Makes a sample of interleaved stereo pcm at the output sample rate
+	static Ref<SampleRes> Create(class Audio* audio, const float* pcm, uint64 numFrames);
 	virtual ~SampleRes() = default;
 
 public:
@@ -15,8 +19,10 @@ public:
 	virtual uint32 GetBitsPerSample() const = 0;
 	virtual uint32 GetNumChannels() const = 0;
 
-	// Plays this sample from the start
+	// Plays this sample from the start, on top of earlier plays that are still going
+	//	a looping play restarts the loop that is already playing
 	virtual void Play(bool looping = false) = 0;
+	// Stops all plays
 	virtual void Stop() = 0;
 	virtual bool IsPlaying() const = 0;
 };
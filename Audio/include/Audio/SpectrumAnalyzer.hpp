@@ -0,0 +1,45 @@
+#pragma once
+#include "FFT.hpp"
+#include <atomic>
+
+/*
+	Frequency spectrum of the mixed output, for visualizations in skins
+	The mixer pushes every block it renders, the game takes the spectrum of the latest window of samples
+	Pushing and processing don't allocate, only changing the window size or number of buckets does
+*/
+class SpectrumAnalyzer : Unique
+{
+public:
+	static constexpr uint32 minWindowSize = 64;
+	static constexpr uint32 maxWindowSize = 8192;
+	static constexpr uint32 maxBuckets = 128;
+
+	SpectrumAnalyzer();
+
+	// The window size is rounded down to a power of two
+	void SetSize(uint32 windowSize, uint32 numBuckets);
+	void SetSampleRate(uint32 sampleRate);
+	uint32 GetWindowSize() const { return m_fft.GetSize(); }
+	uint32 GetNumBuckets() const { return m_numBuckets; }
+
+	// Adds interleaved stereo output, called from the audio thread
+	void Push(const float* samples, uint32 numFrames);
+	// Fills numBuckets values scaled for display, and the unscaled peak magnitude of every bucket
+	void Process(float* buckets, float* bucketsN);
+
+private:
+	void m_UpdateBuckets();
+
+	RealFFT m_fft;
+	uint32 m_numBuckets = 16;
+	uint32 m_sampleRate = 44100;
+	Vector<float> m_window;
+	Vector<float> m_buffer;
+	// First and last frequency bin of each bucket
+	Vector<std::pair<uint32, uint32>> m_bucketBins;
+	Vector<float> m_magnitudes;
+
+	// Mono history of the output, twice the largest window so the latest window isn't overwritten while it is read
+	Vector<float> m_history;
+	std::atomic<uint64> m_numPushed = { 0 };
+};
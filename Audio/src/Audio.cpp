@@ -4,9 +4,8 @@
 #include "Audio_Impl.hpp"
 #include "AudioOutput.hpp"
 #include "DSP.hpp"
-
-#include <complex>
-# define M_PI           3.14159265358979323846  /* pi */
+#include <Shared/Profiling.hpp>
+#include <Shared/WorkerPool.hpp>
 
 Audio* g_audio = nullptr;
 static Audio_Impl g_impl;
@@ -20,6 +19,7 @@ Audio_Impl::Audio_Impl()
 
 void Audio_Impl::Mix(void* data, uint32& numSamples)
 {
+	ProfilerZone $("Audio::Mix", ProfilerCounter::MixTime);
 	double adv = GetSecondsPerSample();
 
 	uint32 outputChannels = this->output->GetNumChannels();
@@ -48,17 +48,17 @@ void Audio_Impl::Mix(void* data, uint32& numSamples)
 			{
 				// Clear per-channel data
 				m_itemBuffer.fill(0);
-				item->Process(m_itemBuffer.data(), m_sampleBufferLength);
+				item->Process(m_itemBuffer.data(), m_blockLength);
 #if _DEBUG
 				CheckMemoryGuard();
 #endif
-				item->ProcessDSPs(m_itemBuffer.data(), m_sampleBufferLength);
+				item->ProcessDSPs(m_itemBuffer.data(), m_blockLength);
 #if _DEBUG
 				CheckMemoryGuard();
 #endif
 
 				// Mix into buffer and apply volume scaling
-				for (uint32 i = 0; i < m_sampleBufferLength; i++)
+				for (uint32 i = 0; i < m_blockLength; i++)
 				{
 					m_sampleBuffer[i * 2 + 0] += m_itemBuffer[i * 2] * item->GetVolume();
 					m_sampleBuffer[i * 2 + 1] += m_itemBuffer[i * 2 + 1] * item->GetVolume();
@@ -68,12 +68,12 @@ void Audio_Impl::Mix(void* data, uint32& numSamples)
 			// Process global DSPs
 			for (auto dsp : globalDSPs)
 			{
-				dsp->Process(m_sampleBuffer.data(), m_sampleBufferLength);
+				dsp->Process(m_sampleBuffer.data(), m_blockLength);
 			}
 			lock.unlock();
 
 			// Apply volume levels
-			for (uint32 i = 0; i < m_sampleBufferLength; i++)
+			for (uint32 i = 0; i < m_blockLength; i++)
 			{
 				// Assign normal Sample Buffer before applying leveling.
 				m_sampleBufferN[i * 2 + 0] = m_sampleBuffer[i * 2 + 0];
@@ -86,13 +86,14 @@ void Audio_Impl::Mix(void* data, uint32& numSamples)
 				m_sampleBuffer[i * 2 + 0] = fmin(fmax(m_sampleBuffer[i * 2 + 0], -1.f), 1.f);
 				m_sampleBuffer[i * 2 + 1] = fmin(fmax(m_sampleBuffer[i * 2 + 1], -1.f), 1.f);
 			}
+			spectrum.Push(m_sampleBufferN.data(), m_blockLength);
 
 			// Set new remaining buffer data
-			m_remainingSamples = m_sampleBufferLength;
+			m_remainingSamples = m_blockLength;
 		}
 
 		// Copy samples from sample buffer
-		uint32 sampleOffset = m_sampleBufferLength - m_remainingSamples;
+		uint32 sampleOffset = m_blockLength - m_remainingSamples;
 		uint32 maxSamples = Math::Min(numSamples - currentNumberOfSamples, m_remainingSamples);
 		for (uint32 c = 0; c < outputChannels; c++)
 		{
@@ -157,6 +158,34 @@ double Audio_Impl::GetSecondsPerSample() const
 {
 	return 1.0 / (double)GetSampleRate();
 }
+void Audio_Impl::SetPeriodSize(uint32 periodSize)
+{
+	m_remainingSamples = 0;
+	if (periodSize == 0)
+	{
+		m_blockLength = m_sampleBufferLength;
+		return;
+	}
+
+	// The fewest blocks per period that divide it evenly, without making blocks too short to be worth rendering
+	const uint32 minBlockLength = 64;
+	const uint32 minBlocks = (periodSize + m_sampleBufferLength - 1) / m_sampleBufferLength;
+	for (uint32 numBlocks = minBlocks; periodSize / numBlocks >= minBlockLength; numBlocks++)
+	{
+		if (periodSize % numBlocks == 0)
+		{
+			m_blockLength = periodSize / numBlocks;
+			return;
+		}
+	}
+	// Blocks are as even as possible, a few callbacks will be split between blocks
+	m_blockLength = (periodSize + minBlocks - 1) / minBlocks;
+}
+WorkerPool& Audio_Impl::GetWorkerPool()
+{
+	static WorkerPool pool(Math::Clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, 4));
+	return pool;
+}
 
 void* Audio_Impl::GetSampleBuffer()
 {
@@ -165,7 +194,7 @@ void* Audio_Impl::GetSampleBuffer()
 
 uint32 Audio_Impl::GetSampleBufferLength()
 {
-	return m_sampleBufferLength;
+	return m_blockLength;
 }
 
 Audio::Audio()
@@ -186,18 +215,21 @@ Audio::~Audio()
 	assert(g_audio == this);
 	g_audio = nullptr;
 }
-bool Audio::Init(bool exclusive)
+bool Audio::Init(bool exclusive, uint32 bufferSize)
 {
 	audioLatency = 0;
 
 	g_impl.output = new AudioOutput();
-	if (!g_impl.output->Init(exclusive))
+	if (!g_impl.output->Init(exclusive, bufferSize))
 	{
 		delete g_impl.output;
 		g_impl.output = nullptr;
 		return false;
 	}
 
+	g_impl.spectrum.SetSampleRate(g_impl.output->GetSampleRate());
+	g_impl.SetPeriodSize(g_impl.output->GetPeriodSize());
+	Logf("Mixing in blocks of %d samples", Logger::Severity::Info, g_impl.GetBlockLength());
 	g_impl.Start();
 
 	return m_initialized = true;
@@ -206,10 +238,22 @@ void Audio::SetGlobalVolume(float vol)
 {
 	g_impl.globalVolume = vol;
 }
+void Audio::SetResampleQuality(ResampleQuality quality)
+{
+	g_impl.resampleQuality = quality;
+}
 uint32 Audio::GetSampleRate() const
 {
 	return g_impl.output->GetSampleRate();
 }
+PcmCache& Audio::GetPcmCache()
+{
+	return g_impl.pcmCache;
+}
+SpectrumAnalyzer& Audio::GetSpectrumAnalyzer()
+{
+	return g_impl.spectrum;
+}
 class Audio_Impl* Audio::GetImpl()
 {
 	return &g_impl;
@@ -225,102 +269,6 @@ uint32 Audio::GetSampleBufferLength()
 	return g_impl.GetSampleBufferLength();
 }
 
-void Audio::ProcessFFT(float* out_buckets, float* out_bucketsN, uint32 in_bucketAmount)
-{
-	const float* sampleBuffer = GetSampleBuffer();
-
-	std::vector<std::complex<double>> samplesHann;
-
-	for (int i = 0; i < 384; i++)
-	{
-		// assign left samples from sample buffer
-		samplesHann.push_back(sampleBuffer[i*2]);
-
-		//apply hann window
-		samplesHann[i] = std::sin((M_PI*i)/384) * std::sin((M_PI*i)/384) * samplesHann[i];
-	}
-
-	std::vector<std::complex<double>> samplesFFT = FFT(samplesHann);
-
-	int samplingFrequency = samplesFFT.size();
-	int subset[] = { 0, 200, 400, 600, 800, 1000, 1250, 1500, 1750, 2000, 2500, 3000, 3500, 4000, 5000, 6000, 20000 };
-
-	std::vector<double> bins(in_bucketAmount);
-	double max_magnitude = 0.0;
-
-	for (int j = 0; j < samplingFrequency / 2; j++) {
-
-		// Calculates magnitude from freq bin
-		double real = samplesFFT[j].real() * 2 / samplingFrequency;
-		double imag = samplesFFT[j].imag() * 2 / samplingFrequency;
-		double magnitude = sqrt(pow(real, 2) + pow(imag, 2));
-		double freq = j * GetSampleRate() / samplingFrequency;
-
-		for (int i = 0; i < in_bucketAmount; i++)
-		{
-			if (freq >= subset[i] && freq <= subset[i + 1] && magnitude > bins[i])
-			{
-				bins[i] = magnitude;
-				if (magnitude > max_magnitude) max_magnitude = magnitude;
-			}
-		}
-	}
-
-	// scale output
-	for (int i = 0; i < in_bucketAmount; i++)
-	{
-		double base = 0.5 * (bins[i] * 6.0); // bass
-		double mag = 0.2 * (bins[i] * 0.5 / max_magnitude); // mid
-		double lin = 0.7 * bins[i] * i; // high notes
-		double exp = 0.6 * std::log(bins[i] * 1000.0f) * 0.125f;
-		double cus = (base + lin + mag + exp)*0.75;
-
-		out_buckets[i] = (float) cus;
-		out_bucketsN[i] = (float) bins[i];
-	}
-
-	//TODO find a way to increase volume of quieter songs
-	// normalize volume so that louder songs and quieter songs cancel
-	//float nrmzd = 0.0;
-	//for (int i=0;i<in_bucketAmount;++i)
-	//	nrmzd += out_buckets[i];
-	//for (int i=0;i<in_bucketAmount;++i)
-	//	out_buckets[i] = out_buckets[i]/nrmzd*5.0;
-}
-
-std::vector<std::complex<double>> Audio::FFT(std::vector<std::complex<double>>& samples)
-{
-	int size = samples.size();
-	if (size <= 1) return samples;
-
-	// split samples in even/odd
-	int newSize = size / 2;
-	std::vector<std::complex<double>> even(newSize, 0);
-	std::vector<std::complex<double>> odd(newSize, 0);
-
-	for (int i = 0; i < newSize; i++)
-	{
-		even[i] = samples[i * 2];
-		odd[i] = samples[i * 2+1];
-	}
-
-	// apply FFT on 2 sub vectors
-	std::vector<std::complex<double>> evenF(newSize, 0);
-	evenF = FFT(even);
-	std::vector<std::complex<double>> oddF(newSize, 0);
-	oddF = FFT(odd);
-
-	std::vector<std::complex<double>> result(size, 0);
-
-	for (int i = 0; i < newSize; i++)
-	{
-		std::complex<double> w = (std::complex<double>) (std::polar(1.0, -2 * M_PI * i / size) * (std::complex<double>) oddF[i]);
-		result[i] = evenF[i] + w;
-		result[i + newSize] = evenF[i] - w;
-	}
-
-	return result;
-}
 Ref<AudioStream> Audio::CreateStream(const String &path, bool preload)
 {
 	return AudioStream::Create(this, path, preload);
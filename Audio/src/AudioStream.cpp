@@ -51,8 +51,17 @@ Ref<AudioStream> AudioStream::Create(Audio *audio, const String &path, bool prel
 	return impl;
 }
 
+Ref<AudioStream> AudioStream::Create(Audio *audio, Ref<CachedPcm> pcm)
+{
+	auto impl = AudioStreamPcm::Create(audio, pcm);
+	if (impl)
+		audio->GetImpl()->Register(impl.get());
+	return impl;
+}
+
 Ref<AudioStream> AudioStream::Clone(Audio *audio, Ref<AudioStream> source)
 {
+	source->WaitForDecode();
 	auto clone = AudioStreamPcm::Create(audio, source);
 	if (clone)
 		audio->GetImpl()->Register(clone.get());
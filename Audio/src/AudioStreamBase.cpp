@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "Shared/Profiling.hpp"
 #include "AudioStreamBase.hpp"
+#include "Shared/WorkerPool.hpp"
 
 // Fixed point format for resampling
 const uint64 AudioStreamBase::fp_sampleStep = 1ull << 48;
@@ -31,6 +32,26 @@ bool AudioStreamBase::Init(Audio *audio, const String &path, bool preload)
 
 	return true;
 }
+void AudioStreamBase::m_initCacheKey(const String &params)
+{
+	// Hashing the file is only worth it when the result can be used
+	if (!m_data.empty() && m_audio->GetPcmCache().IsEnabled())
+		m_cacheKey = PcmCache::MakeKey(m_data.data(), m_data.size(), params);
+}
+Ref<CachedPcm> AudioStreamBase::m_loadCached()
+{
+	if (m_cacheKey.empty())
+		return nullptr;
+	ProfilerScope $("Load cached audio");
+	return m_audio->GetPcmCache().Load(m_cacheKey);
+}
+void AudioStreamBase::m_storeCached(const float *pcm, uint64 numFrames, uint32 sampleRate)
+{
+	if (m_cacheKey.empty())
+		return;
+	ProfilerScope $("Store cached audio");
+	m_audio->GetPcmCache().Store(m_cacheKey, pcm, numFrames, sampleRate);
+}
 void AudioStreamBase::m_initSampling(uint32 sampleRate)
 {
 	// Calculate the sample step if the rate is not the same as the output rate
@@ -44,6 +65,36 @@ void AudioStreamBase::m_initSampling(uint32 sampleRate)
 		m_readBuffer[c] = new float[m_bufferSize];
 	}
 }
+uint32 AudioStreamBase::m_resamplePreloaded(Vector<float> &pcm, uint32 sampleRate)
+{
+	const uint32 outputRate = m_audio->GetSampleRate();
+	if (sampleRate == outputRate || pcm.empty())
+		return sampleRate;
+
+	ProfilerScope $("Resample preloaded audio");
+	const double ratio = (double)sampleRate / (double)outputRate;
+	Resampler resampler(m_audio->GetImpl()->resampleQuality);
+	resampler.SetRatio(ratio);
+
+	// Split into parts that are resampled at the same time
+	const uint64 numFrames = pcm.size() / 2;
+	const uint64 numOutput = Resampler::GetNumOutputFrames(numFrames, ratio);
+	const uint64 partSize = 1 << 16;
+	Vector<float> resampled(numOutput * 2);
+	WorkerPool &pool = Audio_Impl::GetWorkerPool();
+	for (uint64 first = 0; first < numOutput; first += partSize)
+	{
+		pool.Queue([&, first]()
+		{
+			const uint32 count = (uint32)Math::Min(partSize, numOutput - first);
+			resampler.ProcessBuffer(pcm.data(), numFrames, resampled.data() + first * 2, first, count, ratio);
+		});
+	}
+	pool.Wait();
+
+	pcm = std::move(resampled);
+	return outputRate;
+}
 
 void AudioStreamBase::Play()
 {
@@ -109,6 +160,7 @@ void AudioStreamBase::SetPosition(int32 pos)
 {
 	m_lock.lock();
 	m_remainingBufferData = 0;
+	m_resampler.Reset();
 	m_samplePos = m_secondsToSamples((double)pos / 1000.0);
 	SetPosition_Internal((int32)m_samplePos);
 	m_ended = false;
@@ -139,6 +191,10 @@ void AudioStreamBase::PreRenderDSPs(Vector<DSP *> &DSPs)
 {
 	PreRenderDSPs_Internal(DSPs);
 }
+void AudioStreamBase::WaitForDecode()
+{
+	WaitForDecode_Internal();
+}
 void AudioStreamBase::Process(float *out, uint32 numSamples)
 {
 	if (!m_playing || m_paused)
@@ -147,52 +203,43 @@ void AudioStreamBase::Process(float *out, uint32 numSamples)
 	m_lock.lock();
 
 	const uint64 sampleStepIncrement = static_cast<uint64>(m_sampleStepIncrement * PlaybackSpeed);
+	const double sampleStep = (double)sampleStepIncrement / (double)fp_sampleStep;
+
+	const ResampleQuality quality = m_audio->GetImpl()->resampleQuality;
+	if (m_resampler.GetQuality() != quality)
+		m_resampler.SetQuality(quality);
 
 	uint32 outCount = 0;
-	while (outCount < numSamples)
+	// Silence until the start of the stream
+	while (outCount < numSamples && m_samplePos < 0)
 	{
-		if (m_remainingBufferData > 0)
-		{
-			uint32 idxStart = (m_currentBufferSize - m_remainingBufferData);
-			uint32 readOffset = 0; // Offset from the start to read from
-			for (uint32 i = 0; outCount < numSamples && readOffset < m_remainingBufferData; i++)
-			{
-				if (m_samplePos < 0)
-				{
-					out[outCount * 2] = 0.0f;
-					out[outCount * 2 + 1] = 0.0f;
-				}
-				else
-				{
-					out[outCount * 2] = m_readBuffer[0][idxStart + readOffset];
-					out[outCount * 2 + 1] = m_readBuffer[1][idxStart + readOffset];
-				}
-				outCount++;
-
-				// Increment source sample with resampling
-				m_sampleStep += sampleStepIncrement;
-				while (m_sampleStep >= fp_sampleStep)
-				{
-					m_sampleStep -= fp_sampleStep;
-					if (m_samplePos >= 0)
-						readOffset++;
-					m_samplePos++;
-				}
-			}
+		out[outCount * 2] = 0.0f;
+		out[outCount * 2 + 1] = 0.0f;
+		outCount++;
 
-			if (readOffset > m_remainingBufferData)
-			{
-				m_remainingBufferData = 0;
-			}
-			else
-			{
-				m_remainingBufferData -= readOffset;
-			}
+		m_sampleStep += sampleStepIncrement;
+		while (m_sampleStep >= fp_sampleStep)
+		{
+			m_sampleStep -= fp_sampleStep;
+			m_samplePos++;
 		}
+	}
 
+	while (outCount < numSamples)
+	{
+		outCount += m_resampler.Process(out + outCount * 2, numSamples - outCount, sampleStep);
 		if (outCount >= numSamples)
 			break;
 
+		// Pass decoded data to the resampler
+		if (m_remainingBufferData > 0)
+		{
+			uint32 idxStart = (m_currentBufferSize - m_remainingBufferData);
+			m_resampler.Push(m_readBuffer[0] + idxStart, m_readBuffer[1] + idxStart, m_remainingBufferData);
+			m_remainingBufferData = 0;
+			continue;
+		}
+
 		// Read more data
 		if (DecodeData_Internal() <= 0)
 		{
@@ -204,10 +251,11 @@ void AudioStreamBase::Process(float *out, uint32 numSamples)
 		}
 	}
 
-	// Store timing info
-	if (m_samplePos > 0)
+	// Store timing info, decoded frames waiting in the resampler haven't been played yet
+	if (m_samplePos >= 0)
 	{
-		m_samplePos = GetStreamPosition_Internal() - (int64)m_remainingBufferData;
+		m_samplePos = GetStreamPosition_Internal() - (int64)m_remainingBufferData - (int64)m_resampler.GetPendingFrames();
+		m_samplePos = Math::Max<int64>(m_samplePos, 0);
 	}
 
 	if (m_samplePos > 0)
@@ -249,6 +297,7 @@ void AudioStreamBase::Process(float *out, uint32 numSamples)
 
 void AudioStreamBase::Normalize(float volume)
 {
+	WaitForDecode();
 	uint64_t pcm_len = GetPCMCount();
 	float* pcm = GetPCM();
 	float max = 0.f;
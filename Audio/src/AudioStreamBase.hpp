@@ -2,6 +2,7 @@
 #include "Audio.hpp"
 #include "AudioStream.hpp"
 #include "Audio_Impl.hpp"
+#include "Resampler.hpp"
 
 class AudioStreamBase : public AudioStream
 {
@@ -17,6 +18,12 @@ protected:
 	bool m_preloaded = false;
 	BinaryStream &m_reader();
 
+	// Made from the preloaded file and whatever else changes the decoded pcm
+	String m_cacheKey;
+	void m_initCacheKey(const String &params);
+	Ref<CachedPcm> m_loadCached();
+	void m_storeCached(const float *pcm, uint64 numFrames, uint32 sampleRate);
+
 	mutex m_lock;
 
 	float **m_readBuffer = nullptr;
@@ -31,6 +38,7 @@ protected:
 	// Resampling values
 	uint64 m_sampleStep = 0;
 	uint64 m_sampleStepIncrement = 0;
+	Resampler m_resampler;
 
 	Timer m_deltaTimer;
 	Timer m_streamTimer;
@@ -46,6 +54,9 @@ protected:
 
 	float m_volume = 0.8f;
 	void m_initSampling(uint32 sampleRate);
+	// Converts preloaded interleaved pcm to the output rate so playback at normal speed is a straight copy
+	// returns the new sample rate
+	uint32 m_resamplePreloaded(Vector<float> &pcm, uint32 sampleRate);
 	uint64 m_secondsToSamples(double s) const;
 	void m_restartTiming();
 	double m_getPositionSeconds(bool allowFreezeSkip = true) const;
@@ -57,6 +68,7 @@ protected:
 	virtual uint32 GetSampleRate_Internal() const = 0;
 	virtual uint64 GetSampleCount_Internal() const = 0;
 	virtual void PreRenderDSPs_Internal(Vector<DSP *> &DSPs){};
+	virtual void WaitForDecode_Internal(){};
 	// Internal sample rate
 	virtual int32 GetStreamRate_Internal() = 0;
 	// Implementation specific decode
@@ -76,6 +88,8 @@ public:
 	virtual uint64 GetPCMCount() const override;
 	virtual uint32 GetSampleRate() const override;
 	virtual void PreRenderDSPs(Vector<DSP *> &DSPs) override;
+	virtual void WaitForDecode() override;
+	virtual const String &GetCacheKey() const override { return m_cacheKey; }
 	virtual void Process(float *out, uint32 numSamples) override;
 
 	virtual void Normalize(float volume = 1.f) override;
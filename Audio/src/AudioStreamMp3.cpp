@@ -134,16 +134,28 @@ bool AudioStreamMp3::Init(Audio *audio, const String &path, bool preload)
 
 	if (preload)
 	{
+		// Preloaded mp3 files are played at their own rate
+		m_initCacheKey("mp3");
+		m_cached = m_loadCached();
 		int totalSamples = 0;
-		while (r > 0)
+		if (m_cached && m_cached->GetSampleRate() == (uint32)m_samplingRate)
 		{
-			for (int32 i = 0; i < r; i++)
+			totalSamples = (int)m_cached->GetNumFrames();
+		}
+		else
+		{
+			m_cached.reset();
+			while (r > 0)
 			{
-				m_pcm.Add(m_readBuffer[0][i]);
-				m_pcm.Add(m_readBuffer[1][i]);
+				for (int32 i = 0; i < r; i++)
+				{
+					m_pcm.Add(m_readBuffer[0][i]);
+					m_pcm.Add(m_readBuffer[1][i]);
+				}
+				totalSamples += r;
+				r = DecodeData_Internal();
 			}
-			totalSamples += r;
-			r = DecodeData_Internal();
+			m_storeCached(m_pcm.data(), totalSamples, m_samplingRate);
 		}
 		m_data.clear();
 		m_dataSource = nullptr;
@@ -204,7 +216,7 @@ uint64 AudioStreamMp3::GetSampleCount_Internal() const
 float *AudioStreamMp3::GetPCM_Internal()
 {
 	if (m_preloaded)
-		return &m_pcm.front();
+		return m_cached ? m_cached->GetData() : m_pcm.data();
 
 	return nullptr;
 }
@@ -213,6 +225,7 @@ int32 AudioStreamMp3::DecodeData_Internal()
 	if (m_preloaded)
 	{
 		uint32 samplesPerRead = 128;
+		const float *pcm = GetPCM_Internal();
 
 		for (size_t i = 0; i < samplesPerRead; i++)
 		{
@@ -230,8 +243,8 @@ int32 AudioStreamMp3::DecodeData_Internal()
 				m_playing = false;
 				return i;
 			}
-			m_readBuffer[0][i] = m_pcm[m_playPos * 2];
-			m_readBuffer[1][i] = m_pcm[m_playPos * 2 + 1];
+			m_readBuffer[0][i] = pcm[m_playPos * 2];
+			m_readBuffer[1][i] = pcm[m_playPos * 2 + 1];
 			m_playPos++;
 		}
 		m_currentBufferSize = samplesPerRead;
@@ -16,6 +16,8 @@ class AudioStreamMp3 : public AudioStreamBase
 
 	Map<int32, size_t> m_frameIndices;
 	Vector<float> m_pcm;
+	// Used instead of m_pcm when the decoded file was cached
+	Ref<CachedPcm> m_cached;
 	int64 m_playPos;
 
 	bool m_firstFrame = true;
@@ -2,8 +2,14 @@
 #include "AudioStreamOgg.hpp"
 #include <vorbis/vorbisfile.h>
 
+// Seconds of a preloaded stream that are decoded before it can be played
+// decoding is much faster than playback, this only covers hiccups of the decode thread
+static const double preloadLeadTime = 1.0;
+
 AudioStreamOgg::~AudioStreamOgg()
 {
+	// The decode thread uses the vorbis file
+	m_pcm.Stop();
 	Deregister();
 
 	for (size_t i = 0; i < m_numChannels; i++)
@@ -44,45 +50,123 @@ bool AudioStreamOgg::Init(Audio *audio, const String &path, bool preload)
 
 	if (preload)
 	{
-		float **readBuffer;
-		int r;
-		int totalRead = 0;
-		while (true)
+		// Decoded pcm is converted to the output rate, so that is part of the key
+		const uint32 sourceRate = m_info.rate;
+		const uint32 outputRate = m_audio->GetSampleRate();
+		if (sourceRate == outputRate)
+			m_initCacheKey(Utility::Sprintf("ogg %d", outputRate));
+		else
+			m_initCacheKey(Utility::Sprintf("ogg %d %s", outputRate, Enum_ResampleQuality::ToString(m_audio->GetImpl()->resampleQuality)));
+
+		const int64 pcmTotal = ov_pcm_total(&m_ovf, -1);
+		Ref<CachedPcm> cached = m_loadCached();
+		if (cached && cached->GetSampleRate() == outputRate)
 		{
-			r = ov_read_float(&m_ovf, &readBuffer, 1024, 0);
-			if (r < 0)
-				continue;
-			if (r == 0)
-				break;
-			else
+			ov_clear(&m_ovf);
+			m_pcm.Set(cached);
+			m_info.rate = outputRate;
+		}
+		else if (pcmTotal > 0)
+		{
+			// Decode in the background, playback can start as soon as the beginning is there
+			const double ratio = (double)sourceRate / (double)outputRate;
+			const uint64 numFrames = sourceRate == outputRate ? pcmTotal : Resampler::GetNumOutputFrames(pcmTotal, ratio);
+			m_pcm.Start(numFrames, [this, pcmTotal, ratio, outputRate](ProgressivePcm &pcm)
 			{
-				if (m_info.channels == 2)
-				{
-					for (int i = 0; i < r; i++)
-					{
-						m_pcm.Add(readBuffer[0][i]);
-						m_pcm.Add(readBuffer[1][i]);
-					}
-				}
-				else if (m_info.channels == 1)
-				{
-					for (int i = 0; i < r; i++)
-					{
-						m_pcm.Add(readBuffer[0][i]);
-						m_pcm.Add(readBuffer[0][i]);
-					}
-				}
-				totalRead += r;
+				m_DecodePreloaded(pcm, pcmTotal, ratio);
+				if (!pcm.IsStopping())
+					m_storeCached(pcm.GetData(), pcm.GetDecodedFrames(), outputRate);
+			});
+			m_info.rate = outputRate;
+			m_pcm.WaitFor((uint64)(preloadLeadTime * outputRate));
+		}
+		else
+		{
+			// Unknown length, decode everything now
+			Vector<float> pcm;
+			float **readBuffer;
+			int r;
+			while ((r = ov_read_float(&m_ovf, &readBuffer, 4096, 0)) != 0)
+			{
+				if (r > 0)
+					m_AppendInterleaved(pcm, readBuffer, r);
 			}
+			ov_clear(&m_ovf);
+
+			// The pcm is at the output rate from here on
+			m_info.rate = m_resamplePreloaded(pcm, m_info.rate);
+			m_storeCached(pcm.data(), pcm.size() / 2, m_info.rate);
+			m_pcm.Set(std::move(pcm));
 		}
-		m_samplesTotal = totalRead;
-		ov_clear(&m_ovf);
 		m_playPos = 0;
+		m_samplesTotal = m_pcm.GetNumFrames();
 	}
 	m_initSampling(m_info.rate);
 	return true;
 }
 
+void AudioStreamOgg::m_AppendInterleaved(Vector<float> &pcm, float **readBuffer, int32 numFrames) const
+{
+	// Mono is played on both channels
+	const float *left = readBuffer[0];
+	const float *right = readBuffer[m_info.channels > 1 ? 1 : 0];
+	const size_t offset = pcm.size();
+	pcm.resize(offset + (size_t)numFrames * 2);
+	float *dst = pcm.data() + offset;
+	for (int32 i = 0; i < numFrames; i++)
+	{
+		dst[i * 2] = left[i];
+		dst[i * 2 + 1] = right[i];
+	}
+}
+void AudioStreamOgg::m_DecodePreloaded(ProgressivePcm &pcm, uint64 numSourceFrames, double ratio)
+{
+	float **readBuffer;
+	int32 r;
+	if (ratio == 1.0)
+	{
+		while (!pcm.IsStopping() && (r = ov_read_float(&m_ovf, &readBuffer, 4096, 0)) != 0)
+		{
+			if (r > 0)
+				pcm.Append(readBuffer[0], readBuffer[m_info.channels > 1 ? 1 : 0], r);
+		}
+		ov_clear(&m_ovf);
+		return;
+	}
+
+	// Convert to the output rate while decoding, every output frame needs the input under the whole filter
+	Resampler resampler(m_audio->GetImpl()->resampleQuality);
+	resampler.SetRatio(ratio);
+	const uint64 halfTaps = resampler.GetNumTaps() / 2;
+	Vector<float> source;
+	source.reserve(numSourceFrames * 2);
+	Vector<float> block;
+	uint64 numConverted = 0;
+	while (!pcm.IsStopping())
+	{
+		r = ov_read_float(&m_ovf, &readBuffer, 4096, 0);
+		if (r < 0)
+			continue;
+		if (r > 0)
+			m_AppendInterleaved(source, readBuffer, r);
+
+		const uint64 numSource = source.size() / 2;
+		const uint64 numReady = r == 0 ? Resampler::GetNumOutputFrames(numSource, ratio)
+			: Resampler::GetNumOutputFrames(numSource > halfTaps ? numSource - halfTaps : 0, ratio);
+		if (numReady > numConverted)
+		{
+			const uint32 count = (uint32)(numReady - numConverted);
+			block.resize(count * 2);
+			resampler.ProcessBuffer(source.data(), numSource, block.data(), numConverted, count, ratio);
+			pcm.Append(block.data(), count);
+			numConverted = numReady;
+		}
+		if (r == 0)
+			break;
+	}
+	ov_clear(&m_ovf);
+}
+
 void AudioStreamOgg::SetPosition_Internal(int32 pos)
 {
 	if (m_preloaded)
@@ -113,7 +197,7 @@ int32 AudioStreamOgg::GetStreamRate_Internal()
 float *AudioStreamOgg::GetPCM_Internal()
 {
 	if (m_preloaded)
-		return &m_pcm.front();
+		return m_pcm.GetData();
 	return nullptr;
 }
 
@@ -121,11 +205,17 @@ uint64 AudioStreamOgg::GetSampleCount_Internal() const
 {
 	if (m_preloaded)
 	{
-		return m_samplesTotal;
+		return m_pcm.GetNumFrames();
 	}
 	return 0;
 }
 
+void AudioStreamOgg::WaitForDecode_Internal()
+{
+	if (m_preloaded)
+		m_pcm.Wait();
+}
+
 uint32 AudioStreamOgg::GetSampleRate_Internal() const
 {
 	return m_info.rate;
@@ -137,6 +227,9 @@ int32 AudioStreamOgg::DecodeData_Internal()
 	{
 		uint32 samplesPerRead = 128;
 		int32 retVal = samplesPerRead;
+		// Only waits when playback got ahead of the decode thread
+		const uint64 numDecoded = m_pcm.WaitFor(Math::Max<int64>(m_playPos, 0) + samplesPerRead);
+		const float *pcm = m_pcm.GetData();
 		bool earlyOut = false;
 		for (size_t i = 0; i < samplesPerRead; i++)
 		{
@@ -147,7 +240,7 @@ int32 AudioStreamOgg::DecodeData_Internal()
 				m_playPos++;
 				continue;
 			}
-			else if ((uint64)m_playPos >= m_samplesTotal)
+			else if ((uint64)m_playPos >= numDecoded)
 			{
 				m_currentBufferSize = m_bufferSize;
 				m_remainingBufferData = m_bufferSize;
@@ -160,8 +253,8 @@ int32 AudioStreamOgg::DecodeData_Internal()
 				}
 				continue;
 			}
-			m_readBuffer[0][i] = m_pcm[m_playPos * 2];
-			m_readBuffer[1][i] = m_pcm[m_playPos * 2 + 1];
+			m_readBuffer[0][i] = pcm[m_playPos * 2];
+			m_readBuffer[1][i] = pcm[m_playPos * 2 + 1];
 			m_playPos++;
 		}
 		m_currentBufferSize = samplesPerRead;
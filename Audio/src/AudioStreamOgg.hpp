@@ -1,6 +1,7 @@
 #pragma once
 #include "stdafx.h"
 #include "AudioStreamBase.hpp"
+#include "ProgressivePcm.hpp"
 #include <vorbis/vorbisfile.h>
 
 class AudioStreamOgg : public AudioStreamBase
@@ -8,7 +9,8 @@ class AudioStreamOgg : public AudioStreamBase
 protected:
 	OggVorbis_File m_ovf;
 	vorbis_info m_info;
-	Vector<float> m_pcm;
+	// Decoded when preloading
+	ProgressivePcm m_pcm;
 	int64 m_playPos;
 
 	bool Init(Audio *audio, const String &path, bool preload) override;
@@ -19,8 +21,12 @@ protected:
 	uint32 GetSampleRate_Internal() const override;
 	uint64 GetSampleCount_Internal() const override;
 	int32 DecodeData_Internal() override;
+	void WaitForDecode_Internal() override;
 
 private:
+	void m_AppendInterleaved(Vector<float> &pcm, float **readBuffer, int32 numFrames) const;
+	// Runs on the decode thread
+	void m_DecodePreloaded(ProgressivePcm &pcm, uint64 numSourceFrames, double ratio);
 	static size_t m_Read(void *ptr, size_t size, size_t nmemb, AudioStreamOgg *self);
 	static int m_Seek(AudioStreamOgg *self, int64 offset, int whence);
 	static long m_Tell(AudioStreamOgg *self);
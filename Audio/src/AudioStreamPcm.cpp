@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "AudioStreamPcm.hpp"
+#include "PreRenderer.hpp"
 
 bool AudioStreamPcm::Init(Audio *audio, const String &path, bool preload)
 {
@@ -71,37 +72,15 @@ uint64 AudioStreamPcm::GetSampleCount_Internal() const
 }
 void AudioStreamPcm::PreRenderDSPs_Internal(Vector<DSP *> &DSPs)
 {
-    auto originalPlayPos = m_playPos;
-    for (auto &&dsp : DSPs)
-    {
-        m_playPos = ((uint64)dsp->startTime * (uint64)m_sampleRate) / 1000;
-        m_samplePos = m_playPos;
-        int64 endSamplePos = ((uint64)dsp->endTime * (uint64)m_sampleRate) / 1000;
-        endSamplePos = Math::Min(endSamplePos, (int64)m_samplesTotal);
-        if (m_playPos >= endSamplePos)
-        {
-            Logf("Effect %s at %dms not rendered", Logger::Severity::Debug, dsp->GetName(), dsp->startTime);
-            continue;
-        }
-
-        uint32 numSamples = endSamplePos - m_playPos;
-        float *buffer = new float[numSamples * 2];
-        memcpy(buffer, m_pcm + m_playPos * 2, numSamples * 2 * sizeof(float));
-        dsp->Process(buffer, numSamples);
-        memcpy(m_pcm + m_playPos * 2, buffer, numSamples * 2 * sizeof(float));
-        Logf("Rendered %s at %dms with %d samples", Logger::Severity::Debug, dsp->GetName(), dsp->startTime, numSamples);
-        delete[] buffer;
-    }
-    m_playPos = originalPlayPos;
-    m_samplePos = m_playPos;
+    PreRenderer::Render(m_pcm, m_samplesTotal, m_sampleRate, DSPs, &Audio_Impl::GetWorkerPool());
 }
 
 AudioStreamPcm::~AudioStreamPcm()
 {
     Deregister();
-    if (m_pcm)
+    if (m_pcm && !m_cached)
     {
-        delete m_pcm;
+        delete[] m_pcm;
     }
 }
 
@@ -126,4 +105,16 @@ Ref<AudioStream> AudioStreamPcm::Create(class Audio *audio, const Ref<AudioStrea
         impl->Init(audio, "", false);
     }
     return Ref<AudioStream>(impl);
-}
\ No newline at end of file
+}
+
+Ref<AudioStream> AudioStreamPcm::Create(class Audio *audio, Ref<CachedPcm> pcm)
+{
+    AudioStreamPcm *impl = new AudioStreamPcm();
+    impl->m_cached = pcm;
+    impl->m_pcm = pcm->GetData();
+    impl->m_playPos = 0;
+    impl->m_sampleRate = pcm->GetSampleRate();
+    impl->m_samplesTotal = pcm->GetNumFrames();
+    impl->Init(audio, "", false);
+    return Ref<AudioStream>(impl);
+}
@@ -6,6 +6,8 @@ class AudioStreamPcm : public AudioStreamBase
 {
 protected:
     float *m_pcm;
+    // Owns m_pcm instead of this stream when it was loaded from the cache
+    Ref<CachedPcm> m_cached;
     uint32 m_sampleRate;
     int64 m_playPos;
 
@@ -23,4 +25,5 @@ public:
     AudioStreamPcm() = default;
     ~AudioStreamPcm();
     static Ref<AudioStream> Create(class Audio *audio, const Ref<AudioStream> &other);
+    static Ref<AudioStream> Create(class Audio *audio, Ref<CachedPcm> pcm);
 };
\ No newline at end of file
@@ -3,6 +3,11 @@
 #include "AudioOutput.hpp"
 #include "Audio_Impl.hpp"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define DSP_SSE
+#include <xmmintrin.h>
+#endif
+
 void BQF::SetLowPass(float q, float freq, float sampleRate)
 {
 	// Limit q
@@ -108,6 +113,177 @@ float BQF::Update(float in)
 	return filtered;
 }
 
+StereoBiquad::StereoBiquad(uint32 numSections)
+{
+	SetNumSections(numSections);
+	for (Section &section : m_sections)
+	{
+		// Pass through until coefficients are set
+		for (uint32 c = 0; c < 2; c++)
+			section.coefficients[0][c] = section.target[0][c] = 1.0f;
+	}
+}
+void StereoBiquad::SetNumSections(uint32 numSections)
+{
+	m_numSections = Math::Min(numSections, maxSections);
+}
+void StereoBiquad::SetSection(uint32 section, const BQF &filter)
+{
+	SetSection(section, filter, filter);
+}
+void StereoBiquad::SetSection(uint32 section, const BQF &left, const BQF &right)
+{
+	assert(section < maxSections);
+	const BQF *filters[2] = { &left, &right };
+	Section &s = m_sections[section];
+	for (uint32 c = 0; c < 2; c++)
+	{
+		const BQF &f = *filters[c];
+		const float target[5] = { f.b0 / f.a0, f.b1 / f.a0, f.b2 / f.a0, f.a1 / f.a0, f.a2 / f.a0 };
+		for (uint32 k = 0; k < 5; k++)
+		{
+			// Parameters are often set to the same values again
+			if (s.target[k][c] != target[k])
+			{
+				s.target[k][c] = target[k];
+				m_changed = true;
+			}
+		}
+	}
+}
+void StereoBiquad::Reset()
+{
+	for (Section &section : m_sections)
+	{
+		memset(section.x, 0, sizeof(section.x));
+		memset(section.y, 0, sizeof(section.y));
+	}
+	memset(m_output, 0, sizeof(m_output));
+}
+void StereoBiquad::m_StartRamp()
+{
+	m_changed = false;
+	if (!m_started)
+	{
+		for (Section &section : m_sections)
+			memcpy(section.coefficients, section.target, sizeof(section.target));
+		m_rampRemaining = 0;
+		return;
+	}
+
+	// Also restarts sections that were still moving to older coefficients
+	for (uint32 i = 0; i < m_numSections; i++)
+	{
+		Section &section = m_sections[i];
+		for (uint32 k = 0; k < 5; k++)
+		{
+			for (uint32 c = 0; c < 2; c++)
+				section.step[k][c] = (section.target[k][c] - section.coefficients[k][c]) / (float)blockSize;
+		}
+	}
+	m_rampRemaining = blockSize;
+}
+void StereoBiquad::Process(float *out, uint32 numFrames)
+{
+	if (m_changed)
+		m_StartRamp();
+	m_started = true;
+
+	while (numFrames > 0)
+	{
+		if (m_rampRemaining == 0)
+		{
+			m_Process<false>(out, numFrames);
+			return;
+		}
+
+		const uint32 count = Math::Min(numFrames, m_rampRemaining);
+		m_Process<true>(out, count);
+		out += count * 2;
+		numFrames -= count;
+		m_rampRemaining -= count;
+		if (m_rampRemaining == 0)
+		{
+			// Removes the rounding error of adding the steps
+			for (uint32 i = 0; i < m_numSections; i++)
+				memcpy(m_sections[i].coefficients, m_sections[i].target, sizeof(m_sections[i].target));
+		}
+	}
+}
+template<bool ramp>
+void StereoBiquad::m_Process(float *out, uint32 numFrames)
+{
+#ifdef DSP_SSE
+	const __m128 feedback = _mm_set1_ps(this->feedback);
+	__m128 output = _mm_load_ps(m_output);
+	for (uint32 i = 0; i < numFrames; i++)
+	{
+		__m128 in = _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *)(out + i * 2));
+		in = _mm_add_ps(in, _mm_mul_ps(feedback, output));
+		for (uint32 j = 0; j < m_numSections; j++)
+		{
+			Section &s = m_sections[j];
+			__m128 c[5];
+			for (uint32 k = 0; k < 5; k++)
+			{
+				c[k] = _mm_load_ps(s.coefficients[k]);
+				if (ramp)
+				{
+					c[k] = _mm_add_ps(c[k], _mm_load_ps(s.step[k]));
+					_mm_store_ps(s.coefficients[k], c[k]);
+				}
+			}
+			const __m128 x1 = _mm_load_ps(s.x[0]);
+			const __m128 y1 = _mm_load_ps(s.y[0]);
+			__m128 filtered = _mm_mul_ps(c[0], in);
+			filtered = _mm_add_ps(filtered, _mm_mul_ps(c[1], x1));
+			filtered = _mm_add_ps(filtered, _mm_mul_ps(c[2], _mm_load_ps(s.x[1])));
+			filtered = _mm_sub_ps(filtered, _mm_mul_ps(c[3], y1));
+			filtered = _mm_sub_ps(filtered, _mm_mul_ps(c[4], _mm_load_ps(s.y[1])));
+
+			_mm_store_ps(s.x[1], x1);
+			_mm_store_ps(s.x[0], in);
+			_mm_store_ps(s.y[1], y1);
+			_mm_store_ps(s.y[0], filtered);
+			in = filtered;
+		}
+		output = in;
+		_mm_storel_pi((__m64 *)(out + i * 2), output);
+	}
+	_mm_store_ps(m_output, output);
+#else
+	for (uint32 i = 0; i < numFrames; i++)
+	{
+		for (uint32 c = 0; c < 2; c++)
+		{
+			float in = out[i * 2 + c] + feedback * m_output[c];
+			for (uint32 j = 0; j < m_numSections; j++)
+			{
+				Section &s = m_sections[j];
+				if (ramp)
+				{
+					for (uint32 k = 0; k < 5; k++)
+						s.coefficients[k][c] += s.step[k][c];
+				}
+				const float filtered =
+					s.coefficients[0][c] * in +
+					s.coefficients[1][c] * s.x[0][c] +
+					s.coefficients[2][c] * s.x[1][c] -
+					s.coefficients[3][c] * s.y[0][c] -
+					s.coefficients[4][c] * s.y[1][c];
+				s.x[1][c] = s.x[0][c];
+				s.x[0][c] = in;
+				s.y[1][c] = s.y[0][c];
+				s.y[0][c] = filtered;
+				in = filtered;
+			}
+			m_output[c] = in;
+			out[i * 2 + c] = in;
+		}
+	}
+#endif
+}
+
 void PanDSP::Process(float *out, uint32 numSamples)
 {
 	for (uint32 i = 0; i < numSamples; i++)
@@ -125,56 +301,50 @@ BQFDSP::BQFDSP(uint32 sampleRate) : DSP()
 }
 void BQFDSP::Process(float *out, uint32 numSamples)
 {
-	for (uint32 c = 0; c < 2; c++)
-	{
-		for (uint32 i = 0; i < numSamples; i++)
-		{
-			out[i * 2 + c] = m_filters[c].Update(out[i * 2 + c]);
-		}
-	}
+	m_filter.Process(out, numSamples);
 }
 void BQFDSP::SetLowPass(float q, float freq)
 {
-	for (uint32 c = 0; c < 2; c++)
-	{
-		m_filters[c].SetLowPass(q, freq, (float)m_sampleRate);
-	}
+	BQF filter;
+	filter.SetLowPass(q, freq, (float)m_sampleRate);
+	m_filter.SetSection(0, filter);
 }
 void BQFDSP::SetHighPass(float q, float freq)
 {
-	for (uint32 c = 0; c < 2; c++)
-	{
-		m_filters[c].SetHighPass(q, freq, (float)m_sampleRate);
-	}
+	BQF filter;
+	filter.SetHighPass(q, freq, (float)m_sampleRate);
+	m_filter.SetSection(0, filter);
 }
 void BQFDSP::SetPeaking(float q, float freq, float gain)
 {
-	for (uint32 c = 0; c < 2; c++)
-	{
-		m_filters[c].SetPeaking(q, freq, gain, (float)m_sampleRate);
-	}
+	BQF filter;
+	filter.SetPeaking(q, freq, gain, (float)m_sampleRate);
+	m_filter.SetSection(0, filter);
 }
 
-CombinedFilterDSP::CombinedFilterDSP(uint32 sampleRate) : DSP(), a(sampleRate), peak(sampleRate)
+CombinedFilterDSP::CombinedFilterDSP(uint32 sampleRate) : DSP(), m_filter(2)
 {
 	SetSampleRate(sampleRate);
 }
 void CombinedFilterDSP::SetLowPass(float q, float freq, float peakQ, float peakGain)
 {
-	a.SetLowPass(q, freq);
-	peak.SetPeaking(peakQ, freq, peakGain);
+	BQF filter, peak;
+	filter.SetLowPass(q, freq, (float)m_sampleRate);
+	peak.SetPeaking(peakQ, freq, peakGain, (float)m_sampleRate);
+	m_filter.SetSection(0, filter);
+	m_filter.SetSection(1, peak);
 }
 void CombinedFilterDSP::SetHighPass(float q, float freq, float peakQ, float peakGain)
 {
-	a.SetHighPass(q, freq);
-	peak.SetPeaking(peakQ, freq, peakGain);
+	BQF filter, peak;
+	filter.SetHighPass(q, freq, (float)m_sampleRate);
+	peak.SetPeaking(peakQ, freq, peakGain, (float)m_sampleRate);
+	m_filter.SetSection(0, filter);
+	m_filter.SetSection(1, peak);
 }
 void CombinedFilterDSP::Process(float *out, uint32 numSamples)
 {
-	a.mix = mix;
-	peak.mix = mix;
-	a.Process(out, numSamples);
-	peak.Process(out, numSamples);
+	m_filter.Process(out, numSamples);
 }
 
 LimiterDSP::LimiterDSP(uint32 sampleRate) : DSP()
@@ -432,6 +602,13 @@ void RetriggerDSP::Process(float *out, uint32 numSamples)
 		m_currentSample = (m_currentSample + 1) % m_length;
 	}
 }
+bool RetriggerDSP::GetSourceRange(uint32 &start, uint32 &end) const
+{
+	// Repeats samples from the last timing point up to one loop past the end
+	start = Math::Min(startTime, (uint32)Math::Max(lastTimingPoint, 0));
+	end = endTime + (uint32)(((uint64)m_length * 1000 + m_sampleRate - 1) / Math::Max(m_sampleRate, 1u)) + 1;
+	return true;
+}
 
 WobbleDSP::WobbleDSP(uint32 sampleRate) : DSP()
 {
@@ -451,27 +628,31 @@ void WobbleDSP::Process(float *out, uint32 numSamples)
 	const uint32 startSample = GetStartSample();
 	const uint32 currentSample = GetCurrentSample();
 
-	for (uint32 i = 0; i < numSamples; i++)
+	uint32 i = currentSample < startSample ? Math::Min(startSample - currentSample, numSamples) : 0;
+	float filtered[StereoBiquad::blockSize * 2];
+	while (i < numSamples)
 	{
-		if (currentSample + i < startSample)
-		{
-			continue;
-		}
+		const uint32 count = Math::Min(StereoBiquad::blockSize, numSamples - i);
+
+		// The cutoff at the end of the block, the filter moves to it over the block
+		m_currentSample = (m_currentSample + count) % m_length;
 		float f = abs(2.0f * ((float)m_currentSample / (float)m_length) - 1.0f);
 		f = easing.Sample(f);
 		float freq = fmin + (fmax - fmin) * f;
-
-		for (uint32 c = 0; c < 2; c++) {
-			m_filters[c].SetLowPass(q, freq, (float)m_sampleRate);
-			out[i * 2 + c] = m_filters[c].Update(out[i * 2 + c]) * mix + out[i * 2 + c] * (1.0f - mix);
-		}
-
-		m_currentSample++;
-		m_currentSample %= m_length;
+		BQF filter;
+		filter.SetLowPass(q, freq, (float)m_sampleRate);
+		m_filter.SetSection(0, filter);
+
+		float *block = out + i * 2;
+		memcpy(filtered, block, count * 2 * sizeof(float));
+		m_filter.Process(filtered, count);
+		for (uint32 j = 0; j < count * 2; j++)
+			block[j] = filtered[j] * mix + block[j] * (1.0f - mix);
+		i += count;
 	}
 }
 
-PhaserDSP::PhaserDSP(uint32 sampleRate) : DSP()
+PhaserDSP::PhaserDSP(uint32 sampleRate) : DSP(), m_allPass(m_stage)
 {
 	SetSampleRate(sampleRate);
 }
@@ -484,6 +665,7 @@ void PhaserDSP::SetStage(uint32 stage)
 {
 	stage = Math::Clamp(stage, 0u, 12u);
 	m_stage = (stage / 2) * 2;
+	m_allPass.SetNumSections(m_stage);
 }
 void PhaserDSP::Process(float *out, uint32 numSamples)
 {
@@ -495,36 +677,45 @@ void PhaserDSP::Process(float *out, uint32 numSamples)
 
 	// logarithmic center
 	float freqCenter = sqrt(fmin*fmax);
-	for (uint32 c = 0; c < 2; c++) {
-		m_hiShelf[c].SetHighShelf(1.5f, freqCenter, hiCutGain, (float)m_sampleRate);
-	}
-
-	for (uint32 i = 0; i < numSamples; i++)
+	BQF hiShelf;
+	hiShelf.SetHighShelf(1.5f, freqCenter, hiCutGain, (float)m_sampleRate);
+	m_hiShelf.SetSection(0, hiShelf);
+	m_allPass.feedback = feedback;
+
+	uint32 i = currentSample < startSample ? Math::Min(startSample - currentSample, numSamples) : 0;
+	float output[StereoBiquad::blockSize * 2];
+	float shelved[StereoBiquad::blockSize * 2];
+	while (i < numSamples)
 	{
-		if (currentSample + i < startSample)
-		{
-			continue;
-		}
+		const uint32 count = Math::Min(StereoBiquad::blockSize, numSamples - i);
 
+		// The sweep position at the end of the block, the filters move to it over the block
+		m_currentSample = (m_currentSample + count) % m_length;
 		float fLeft = abs(2.0f * ((float)m_currentSample / (float)m_length) - 1.0f);
 		float fRight = abs(2.0f * fmodf((float)m_currentSample / (float)m_length + stereoWidth, 1.0f) - 1.0f);
 		float f[2] = {fLeft, fRight};
+		BQF apf[2];
 		for (uint32 c = 0; c < 2; c++) {
 			// logarithmic interpolation
 			float freq = pow(fmin, f[c]) * pow(fmax, 1-f[c]);
-			float output = feedback * za[c] + out[i * 2 + c];
-			for (uint32 j = 0; j < m_stage; j++) {
-				m_apf[j][c].SetAllPass(q, freq, (float)m_sampleRate);
-				output = m_apf[j][c].Update(output);
-			}
-			za[c] = output;
+			apf[c].SetAllPass(q, freq, (float)m_sampleRate);
+		}
+		for (uint32 j = 0; j < m_stage; j++)
+			m_allPass.SetSection(j, apf[0], apf[1]);
+
+		float *block = out + i * 2;
+		memcpy(output, block, count * 2 * sizeof(float));
+		m_allPass.Process(output, count);
+		for (uint32 j = 0; j < count * 2; j++)
+		{
 			// effect strongest when mix = 0.5
-			output = (mix/2) * output + (1-mix/2) * out[i * 2 + c];
-			float shelved = m_hiShelf[c].Update(output);
-			out[i * 2 + c] = mix * shelved + (1-mix) * output;
+			output[j] = (mix/2) * output[j] + (1-mix/2) * block[j];
 		}
-		m_currentSample++;
-		m_currentSample %= m_length;
+		memcpy(shelved, output, count * 2 * sizeof(float));
+		m_hiShelf.Process(shelved, count);
+		for (uint32 j = 0; j < count * 2; j++)
+			block[j] = mix * shelved[j] + (1-mix) * output[j];
+		i += count;
 	}
 }
 
@@ -0,0 +1,122 @@
+#include "stdafx.h"
+#include "FFT.hpp"
+
+RealFFT::RealFFT(uint32 size)
+{
+	if (size > 0)
+		SetSize(size);
+}
+
+void RealFFT::SetSize(uint32 size)
+{
+	uint32 powerOfTwo = 4;
+	while (powerOfTwo * 2 <= size)
+		powerOfTwo *= 2;
+	if (powerOfTwo == m_size)
+		return;
+	m_size = powerOfTwo;
+
+	const uint32 half = m_size / 2;
+	uint32 numBits = 0;
+	while ((1u << numBits) < half)
+		numBits++;
+	m_bitReverse.resize(half);
+	for (uint32 i = 0; i < half; i++)
+	{
+		uint32 reversed = 0;
+		for (uint32 b = 0; b < numBits; b++)
+			reversed |= ((i >> b) & 1) << (numBits - 1 - b);
+		m_bitReverse[i] = reversed;
+	}
+
+	m_twiddles.resize(half);
+	for (uint32 k = 0; k < half / 2; k++)
+	{
+		const double angle = -2.0 * Math::pi * (double)k / (double)half;
+		m_twiddles[k * 2] = (float)cos(angle);
+		m_twiddles[k * 2 + 1] = (float)sin(angle);
+	}
+	m_realTwiddles.resize(half);
+	for (uint32 k = 0; k < half / 2; k++)
+	{
+		const double angle = -2.0 * Math::pi * (double)k / (double)m_size;
+		m_realTwiddles[k * 2] = (float)cos(angle);
+		m_realTwiddles[k * 2 + 1] = (float)sin(angle);
+	}
+}
+
+void RealFFT::m_ComplexForward(float* data) const
+{
+	const uint32 n = m_size / 2;
+	for (uint32 i = 0; i < n; i++)
+	{
+		const uint32 j = m_bitReverse[i];
+		if (j > i)
+		{
+			std::swap(data[i * 2], data[j * 2]);
+			std::swap(data[i * 2 + 1], data[j * 2 + 1]);
+		}
+	}
+
+	// Iterative radix-2 butterflies
+	for (uint32 length = 2; length <= n; length *= 2)
+	{
+		const uint32 halfLength = length / 2;
+		const uint32 step = n / length;
+		for (uint32 start = 0; start < n; start += length)
+		{
+			for (uint32 k = 0; k < halfLength; k++)
+			{
+				const float wr = m_twiddles[k * step * 2];
+				const float wi = m_twiddles[k * step * 2 + 1];
+				float* a = data + (start + k) * 2;
+				float* b = data + (start + k + halfLength) * 2;
+				const float tr = b[0] * wr - b[1] * wi;
+				const float ti = b[0] * wi + b[1] * wr;
+				b[0] = a[0] - tr;
+				b[1] = a[1] - ti;
+				a[0] += tr;
+				a[1] += ti;
+			}
+		}
+	}
+}
+
+void RealFFT::Forward(float* data) const
+{
+	assert(m_size > 0);
+
+	// Even samples are used as the real part and odd samples as the imaginary part of a transform of half the size
+	m_ComplexForward(data);
+
+	const uint32 n = m_size / 2;
+	const float dc = data[0] + data[1];
+	const float nyquist = data[0] - data[1];
+	data[0] = dc;
+	data[1] = nyquist;
+
+	// Each pair of bins k and n-k is made from the same two complex values
+	for (uint32 k = 1; k <= n / 2; k++)
+	{
+		const uint32 m = n - k;
+		const float ar = data[k * 2], ai = data[k * 2 + 1];
+		const float br = data[m * 2], bi = -data[m * 2 + 1];
+
+		// Transforms of the even and odd samples
+		const float er = (ar + br) * 0.5f, ei = (ai + bi) * 0.5f;
+		const float or_ = (ai - bi) * 0.5f, oi = -(ar - br) * 0.5f;
+
+		const float wr = k < n / 2 ? m_realTwiddles[k * 2] : 0.0f;
+		const float wi = k < n / 2 ? m_realTwiddles[k * 2 + 1] : -1.0f;
+		const float tr = or_ * wr - oi * wi;
+		const float ti = or_ * wi + oi * wr;
+
+		data[k * 2] = er + tr;
+		data[k * 2 + 1] = ei + ti;
+		if (m != k)
+		{
+			data[m * 2] = er - tr;
+			data[m * 2 + 1] = -(ei - ti);
+		}
+	}
+}
@@ -0,0 +1,330 @@
+#include "stdafx.h"
+#include "PcmCache.hpp"
+#include <Shared/Files.hpp>
+
+// Start of every cache file, the samples follow it
+struct PcmCacheHeader
+{
+	char magic[4];
+	uint32 version;
+	uint32 format;
+	uint32 sampleRate;
+	uint64 numFrames;
+	uint64 reserved;
+};
+static_assert(sizeof(PcmCacheHeader) == 32, "Samples should be aligned after the header");
+
+static const char pcmCacheMagic[4] = { 'U', 'P', 'C', 'M' };
+// Bump this when decoding or rendering changes, so old entries are not used anymore
+static const uint32 pcmCacheVersion = 1;
+static const char* pcmCacheExtension = "pcm";
+static const char* pcmCacheIndex = "index";
+
+static uint64 GetBytesPerFrame(PcmCacheFormat format)
+{
+	return format == PcmCacheFormat::Int16 ? 2 * sizeof(int16) : 2 * sizeof(float);
+}
+
+static bool WriteEntry(const String& path, PcmCacheFormat format, const float* pcm, uint64 numFrames, uint32 sampleRate)
+{
+	File file;
+	if (!file.OpenWrite(path))
+		return false;
+
+	PcmCacheHeader header = {};
+	memcpy(header.magic, pcmCacheMagic, sizeof(pcmCacheMagic));
+	header.version = pcmCacheVersion;
+	header.format = (uint32)format;
+	header.sampleRate = sampleRate;
+	header.numFrames = numFrames;
+	if (file.Write(&header, sizeof(header)) != sizeof(header))
+		return false;
+
+	if (format == PcmCacheFormat::Float)
+	{
+		const size_t size = numFrames * 2 * sizeof(float);
+		return file.Write(pcm, size) == size;
+	}
+
+	const uint64 blockSize = 16384;
+	Vector<int16> block(blockSize * 2);
+	for (uint64 i = 0; i < numFrames; i += blockSize)
+	{
+		const uint64 count = Math::Min(blockSize, numFrames - i) * 2;
+		for (uint64 j = 0; j < count; j++)
+			block[j] = (int16)(Math::Clamp(pcm[i * 2 + j], -1.0f, 1.0f) * 32767.0f);
+		if (file.Write(block.data(), count * sizeof(int16)) != count * sizeof(int16))
+			return false;
+	}
+	return true;
+}
+
+bool CachedPcm::Open(const String& path)
+{
+	if (!m_file.Open(path))
+		return false;
+
+	if (m_file.GetSize() < sizeof(PcmCacheHeader))
+		return false;
+	const PcmCacheHeader& header = *(const PcmCacheHeader*)m_file.GetData();
+	if (memcmp(header.magic, pcmCacheMagic, sizeof(pcmCacheMagic)) != 0 || header.version != pcmCacheVersion)
+		return false;
+	if (header.format >= (uint32)PcmCacheFormat::_Length || header.numFrames == 0)
+		return false;
+	const PcmCacheFormat format = (PcmCacheFormat)header.format;
+	if (m_file.GetSize() != sizeof(PcmCacheHeader) + header.numFrames * GetBytesPerFrame(format))
+		return false;
+
+	m_numFrames = header.numFrames;
+	m_sampleRate = header.sampleRate;
+	uint8* samples = m_file.GetData() + sizeof(PcmCacheHeader);
+	if (format == PcmCacheFormat::Float)
+	{
+		m_data = (float*)samples;
+		return true;
+	}
+
+	const int16* in = (const int16*)samples;
+	m_converted.resize(m_numFrames * 2);
+	for (size_t i = 0; i < m_converted.size(); i++)
+		m_converted[i] = (float)in[i] / 32767.0f;
+	m_data = m_converted.data();
+	m_file.Close();
+	return true;
+}
+
+void PcmCache::Open(const String& directory, uint64 maxSize)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_directory = directory;
+	m_maxSize = maxSize;
+	m_entries.clear();
+	m_lookup.clear();
+	m_size = 0;
+	if (m_maxSize == 0)
+		return;
+
+	if (!Path::IsDirectory(m_directory))
+		Path::CreateDirRecursive(m_directory);
+	m_DeletePending();
+
+	// Left over from entries that were being written when the game closed
+	for (const FileInfo& file : Files::ScanFiles(m_directory, "tmp"))
+		Path::Delete(file.fullPath);
+
+	// Oldest files first
+	Vector<FileInfo> files = Files::ScanFiles(m_directory, pcmCacheExtension);
+	std::sort(files.begin(), files.end(), [](const FileInfo& l, const FileInfo& r) { return l.lastWriteTime < r.lastWriteTime; });
+	Map<String, uint64> found;
+	Vector<String> order;
+	for (const FileInfo& file : files)
+	{
+		// The file name without the extension
+		String key;
+		Path::RemoveLast(file.fullPath, &key);
+		key.resize(key.size() - strlen(pcmCacheExtension) - 1);
+		if (m_pendingDeletes.Contains(m_GetPath(key)))
+			continue;
+		File entry;
+		if (!entry.OpenRead(file.fullPath))
+			continue;
+		found.Add(key, entry.GetSize());
+		order.Add(key);
+	}
+
+	// The index has the order in which entries were used, entries that are missing from it were used before all others
+	File indexFile;
+	if (Path::FileExists(m_GetIndexPath()) && indexFile.OpenRead(m_GetIndexPath()))
+	{
+		String index;
+		index.resize(indexFile.GetSize());
+		if (!index.empty())
+			indexFile.Read(&index.front(), index.size());
+		for (const String& key : index.Explode("\n", false))
+		{
+			auto it = std::find(order.begin(), order.end(), key);
+			if (it == order.end())
+				continue;
+			order.erase(it);
+			order.Add(key);
+		}
+	}
+
+	for (const String& key : order)
+	{
+		m_entries.push_back({ key, found[key] });
+		m_lookup.Add(key, std::prev(m_entries.end()));
+		m_size += found[key];
+	}
+
+	m_Evict(m_maxSize);
+	m_SaveIndex();
+}
+bool PcmCache::IsEnabled() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_maxSize > 0 && !m_directory.empty();
+}
+void PcmCache::SetFormat(PcmCacheFormat format)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_format = format;
+}
+
+String PcmCache::MakeKey(const void* data, size_t size, const String& params)
+{
+	// 64-bit FNV-1a over the data and the parameters
+	uint64 hash = 0xcbf29ce484222325ull;
+	auto add = [&](const uint8* bytes, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 0x100000001b3ull;
+		}
+	};
+	add((const uint8*)data, size);
+	add((const uint8*)params.data(), params.size());
+	return Utility::Sprintf("%08x%08x", (uint32)(hash >> 32), (uint32)hash);
+}
+
+Ref<CachedPcm> PcmCache::Load(const String& key)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	if (m_maxSize == 0)
+		return nullptr;
+
+	auto it = m_lookup.find(key);
+	if (it == m_lookup.end())
+	{
+		m_numMisses++;
+		return nullptr;
+	}
+
+	Ref<CachedPcm> pcm = std::make_shared<CachedPcm>();
+	if (!pcm->Open(m_GetPath(key)))
+	{
+		Logf("Removing invalid pcm cache entry %s", Logger::Severity::Warning, key);
+		m_Remove(it->second);
+		m_SaveIndex();
+		m_numMisses++;
+		return nullptr;
+	}
+
+	m_entries.splice(m_entries.end(), m_entries, it->second);
+	m_SaveIndex();
+	m_numHits++;
+	return pcm;
+}
+bool PcmCache::Store(const String& key, const float* pcm, uint64 numFrames, uint32 sampleRate)
+{
+	PcmCacheFormat format;
+	String path;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		format = m_format;
+		const uint64 size = sizeof(PcmCacheHeader) + numFrames * GetBytesPerFrame(format);
+		if (m_maxSize == 0 || numFrames == 0 || size > m_maxSize)
+			return false;
+		// Another stream of the same file may be storing it already
+		if (m_lookup.Contains(key) || m_storing.Contains(key))
+			return true;
+
+		m_storing.Add(key);
+		m_Evict(m_maxSize - size);
+		m_DeletePending();
+		path = m_GetPath(key);
+	}
+
+	// Written under another name first, so the entry never exists half written
+	const String tempPath = path + ".tmp";
+	const bool written = WriteEntry(tempPath, format, pcm, numFrames, sampleRate) && Path::Rename(tempPath, path, true);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_storing.erase(key);
+	if (!written)
+	{
+		Path::Delete(tempPath);
+		Logf("Failed to write pcm cache entry %s", Logger::Severity::Warning, key);
+		return false;
+	}
+
+	const uint64 size = sizeof(PcmCacheHeader) + numFrames * GetBytesPerFrame(format);
+	if (!m_lookup.Contains(key))
+	{
+		m_entries.push_back({ key, size });
+		m_lookup.Add(key, std::prev(m_entries.end()));
+		m_size += size;
+	}
+	m_Evict(m_maxSize);
+	m_SaveIndex();
+	return true;
+}
+
+uint64 PcmCache::GetSize() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_size;
+}
+size_t PcmCache::GetNumEntries() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_entries.size();
+}
+
+// Not normalized, that only works for files that exist already on some platforms
+String PcmCache::m_GetPath(const String& key) const
+{
+	return m_directory + Path::sep + key + "." + pcmCacheExtension;
+}
+String PcmCache::m_GetIndexPath() const
+{
+	return m_directory + Path::sep + pcmCacheIndex;
+}
+void PcmCache::m_Remove(EntryList::iterator it)
+{
+	// Streams that still use a removed entry keep their mapping of it,
+	//	on Windows the file can't be deleted until they are done so it is tried again later
+	const String path = m_GetPath(it->key);
+	if (!Path::Delete(path) && Path::FileExists(path))
+		m_pendingDeletes.Add(path);
+	m_size -= it->size;
+	m_lookup.erase(it->key);
+	m_entries.erase(it);
+}
+void PcmCache::m_DeletePending()
+{
+	for (auto it = m_pendingDeletes.begin(); it != m_pendingDeletes.end();)
+	{
+		if (Path::Delete(*it) || !Path::FileExists(*it))
+			it = m_pendingDeletes.erase(it);
+		else
+			++it;
+	}
+}
+void PcmCache::m_Evict(uint64 maxSize)
+{
+	while (m_size > maxSize && !m_entries.empty())
+	{
+		Logf("Removing pcm cache entry %s", Logger::Severity::Debug, m_entries.front().key);
+		m_Remove(m_entries.begin());
+		m_numEvictions++;
+	}
+}
+void PcmCache::m_SaveIndex()
+{
+	if (m_directory.empty())
+		return;
+	String index;
+	for (const Entry& entry : m_entries)
+		index += entry.key + "\n";
+	// Replaced in one go, writing over the old index would keep its end when the new one is shorter
+	const String tempPath = m_GetIndexPath() + ".tmp";
+	{
+		File file;
+		if (!file.OpenWrite(tempPath))
+			return;
+		file.Write(index.data(), index.size());
+	}
+	Path::Rename(tempPath, m_GetIndexPath(), true);
+}
@@ -0,0 +1,153 @@
+#include "stdafx.h"
+#include "PreRenderer.hpp"
+#include <Shared/WorkerPool.hpp>
+
+/*
+	Stands in for the stream while one group of effects is rendered
+	effects read their position from this, so groups don't share the position of the stream
+*/
+class PreRenderSource : public AudioBase
+{
+public:
+	PreRenderSource(float *pcm, uint64 numFrames, uint32 sampleRate) : m_pcm(pcm), m_numFrames(numFrames), m_sampleRate(sampleRate)
+	{
+	}
+
+	void Process(float *out, uint32 numSamples) override
+	{
+	}
+	int32 GetPosition() const override
+	{
+		return (int32)(samplePos * 1000 / m_sampleRate);
+	}
+	uint32 GetSampleRate() const override
+	{
+		return m_sampleRate;
+	}
+	uint64 GetSamplePos() const override
+	{
+		return samplePos;
+	}
+	float *GetPCM() override
+	{
+		return m_pcm;
+	}
+	uint64 GetPCMCount() const override
+	{
+		return m_numFrames;
+	}
+	void PreRenderDSPs(Vector<DSP *> &DSPs) override
+	{
+	}
+
+	uint64 samplePos = 0;
+
+private:
+	float *m_pcm;
+	uint64 m_numFrames;
+	uint32 m_sampleRate;
+};
+
+// Samples an effect changes, and the samples it reads from its audio base
+struct PreRenderRange
+{
+	size_t index;
+	uint64 start;
+	uint64 end;
+	uint64 sourceStart;
+	uint64 sourceEnd;
+	bool readsSource;
+};
+
+static void RenderGroup(float *pcm, uint64 numFrames, uint32 sampleRate, const Vector<DSP *> &DSPs, const Vector<PreRenderRange> &group)
+{
+	PreRenderSource source(pcm, numFrames, sampleRate);
+	Vector<float> buffer;
+	for (const PreRenderRange &range : group)
+	{
+		DSP *dsp = DSPs[range.index];
+		AudioBase *audioBase = dsp->GetAudioBase();
+		dsp->SetAudioBase(&source);
+		source.samplePos = range.start;
+
+		const uint32 numSamples = (uint32)(range.end - range.start);
+		float *samples = pcm + range.start * 2;
+		if (range.readsSource)
+		{
+			// The effect has to see its samples as they were before it changed them
+			buffer.assign(samples, samples + numSamples * 2);
+			dsp->Process(buffer.data(), numSamples);
+			memcpy(samples, buffer.data(), numSamples * 2 * sizeof(float));
+		}
+		else
+		{
+			dsp->Process(samples, numSamples);
+		}
+		dsp->SetAudioBase(audioBase);
+		Logf("Rendered %s at %dms with %d samples", Logger::Severity::Debug, dsp->GetName(), dsp->startTime, numSamples);
+	}
+}
+
+void PreRenderer::Render(float *pcm, uint64 numFrames, uint32 sampleRate, const Vector<DSP *> &DSPs, WorkerPool *pool)
+{
+	Vector<PreRenderRange> ranges;
+	for (size_t i = 0; i < DSPs.size(); i++)
+	{
+		const DSP *dsp = DSPs[i];
+		PreRenderRange range;
+		range.index = i;
+		range.start = ((uint64)dsp->startTime * (uint64)sampleRate) / 1000;
+		range.end = Math::Min(((uint64)dsp->endTime * (uint64)sampleRate) / 1000, numFrames);
+		if (range.start >= range.end)
+		{
+			Logf("Effect %s at %dms not rendered", Logger::Severity::Debug, dsp->GetName(), dsp->startTime);
+			continue;
+		}
+
+		range.sourceStart = range.start;
+		range.sourceEnd = range.end;
+		uint32 sourceStart, sourceEnd;
+		range.readsSource = dsp->GetSourceRange(sourceStart, sourceEnd);
+		if (range.readsSource)
+		{
+			range.sourceStart = Math::Min(range.start, ((uint64)sourceStart * (uint64)sampleRate) / 1000);
+			range.sourceEnd = Math::Max(range.end, ((uint64)sourceEnd * (uint64)sampleRate) / 1000 + 1);
+		}
+		ranges.Add(range);
+	}
+
+	// Effects that overlap, directly or through other effects, go in the same group
+	std::stable_sort(ranges.begin(), ranges.end(), [](const PreRenderRange &l, const PreRenderRange &r) { return l.sourceStart < r.sourceStart; });
+	Vector<Vector<PreRenderRange>> groups;
+	uint64 groupEnd = 0;
+	for (const PreRenderRange &range : ranges)
+	{
+		if (groups.empty() || range.sourceStart >= groupEnd)
+		{
+			groups.emplace_back();
+			groupEnd = 0;
+		}
+		groups.back().Add(range);
+		groupEnd = Math::Max(groupEnd, range.sourceEnd);
+	}
+	for (Vector<PreRenderRange> &group : groups)
+	{
+		std::sort(group.begin(), group.end(), [](const PreRenderRange &l, const PreRenderRange &r) { return l.index < r.index; });
+	}
+
+	if (!pool || groups.size() < 2)
+	{
+		for (const Vector<PreRenderRange> &group : groups)
+			RenderGroup(pcm, numFrames, sampleRate, DSPs, group);
+		return;
+	}
+
+	for (const Vector<PreRenderRange> &group : groups)
+	{
+		pool->Queue([&]()
+		{
+			RenderGroup(pcm, numFrames, sampleRate, DSPs, group);
+		});
+	}
+	pool->Wait();
+}
@@ -0,0 +1,98 @@
+#include "stdafx.h"
+#include "ProgressivePcm.hpp"
+
+ProgressivePcm::~ProgressivePcm()
+{
+	Stop();
+}
+
+void ProgressivePcm::Start(uint64 numFrames, DecodeFunction decode)
+{
+	Stop();
+	m_cached.reset();
+	m_data.resize(numFrames * 2);
+	m_decoded.store(0, std::memory_order_relaxed);
+	m_numFrames.store(numFrames, std::memory_order_release);
+	m_stop.store(false, std::memory_order_relaxed);
+	m_done.store(false, std::memory_order_release);
+
+	m_thread = Thread([this, decode]()
+	{
+		decode(*this);
+		m_Finish();
+	});
+}
+void ProgressivePcm::Set(Vector<float>&& pcm)
+{
+	Stop();
+	m_cached.reset();
+	m_data = std::move(pcm);
+	m_decoded.store(m_data.size() / 2, std::memory_order_release);
+	m_numFrames.store(m_data.size() / 2, std::memory_order_release);
+}
+void ProgressivePcm::Set(Ref<CachedPcm> pcm)
+{
+	Stop();
+	m_data.clear();
+	m_cached = pcm;
+	m_decoded.store(m_cached->GetNumFrames(), std::memory_order_release);
+	m_numFrames.store(m_cached->GetNumFrames(), std::memory_order_release);
+}
+void ProgressivePcm::Stop()
+{
+	m_stop.store(true, std::memory_order_relaxed);
+	if (m_thread.joinable())
+		m_thread.join();
+}
+void ProgressivePcm::m_Finish()
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_numFrames.store(m_decoded.load(std::memory_order_relaxed), std::memory_order_release);
+	m_done.store(true, std::memory_order_release);
+	m_progress.notify_all();
+}
+
+void ProgressivePcm::Append(const float* left, const float* right, uint32 numFrames)
+{
+	const uint64 decoded = m_decoded.load(std::memory_order_relaxed);
+	numFrames = (uint32)Math::Min<uint64>(numFrames, m_data.size() / 2 - decoded);
+	float* dst = m_data.data() + decoded * 2;
+	for (uint32 i = 0; i < numFrames; i++)
+	{
+		dst[i * 2] = left[i];
+		dst[i * 2 + 1] = right[i];
+	}
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_decoded.store(decoded + numFrames, std::memory_order_release);
+	m_progress.notify_all();
+}
+void ProgressivePcm::Append(const float* in, uint32 numFrames)
+{
+	const uint64 decoded = m_decoded.load(std::memory_order_relaxed);
+	numFrames = (uint32)Math::Min<uint64>(numFrames, m_data.size() / 2 - decoded);
+	memcpy(m_data.data() + decoded * 2, in, numFrames * 2 * sizeof(float));
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_decoded.store(decoded + numFrames, std::memory_order_release);
+	m_progress.notify_all();
+}
+
+uint64 ProgressivePcm::WaitFor(uint64 numFrames)
+{
+	uint64 decoded = m_decoded.load(std::memory_order_acquire);
+	if (decoded < numFrames && IsDecoding())
+	{
+		std::unique_lock<std::mutex> lock(m_lock);
+		m_progress.wait(lock, [&]()
+		{
+			return m_decoded.load(std::memory_order_acquire) >= numFrames || !IsDecoding();
+		});
+		decoded = m_decoded.load(std::memory_order_acquire);
+	}
+	return Math::Min(numFrames, decoded);
+}
+void ProgressivePcm::Wait()
+{
+	WaitFor(GetNumFrames());
+}
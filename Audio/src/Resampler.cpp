@@ -0,0 +1,255 @@
+#include "stdafx.h"
+#include "Resampler.hpp"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define RESAMPLER_SSE
+#include <xmmintrin.h>
+#endif
+
+static constexpr uint64 fractionOne = 1ull << Resampler::fractionBits;
+static constexpr uint32 numPhases = 1 << Resampler::phaseBits;
+static constexpr uint32 phaseShift = Resampler::fractionBits - Resampler::phaseBits;
+static constexpr float phaseWeightScale = 1.0f / (float)(1 << phaseShift);
+
+// Zeroth order modified bessel function, used by the kaiser window
+static double BesselI0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+	for (int32 k = 1; k < 50; k++)
+	{
+		double t = x / (2.0 * k);
+		term *= t * t;
+		sum += term;
+		if (term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+Resampler::Resampler(ResampleQuality quality)
+{
+	SetQuality(quality);
+}
+void Resampler::SetQuality(ResampleQuality quality)
+{
+	const uint32 numPending = GetPendingFrames();
+	Vector<float> pending(numPending * 2);
+	if (numPending > 0)
+		memcpy(pending.data(), m_input.data() + m_position * 2, numPending * 2 * sizeof(float));
+
+	m_quality = quality;
+	switch (quality)
+	{
+	case ResampleQuality::Linear:
+		m_numTaps = 2;
+		break;
+	case ResampleQuality::High:
+		m_numTaps = maxTaps;
+		m_attenuation = 90.0;
+		break;
+	case ResampleQuality::Medium:
+	default:
+		m_numTaps = 32;
+		m_attenuation = 70.0;
+		break;
+	}
+	m_BuildTable(m_GetCutoff(1.0));
+
+	Reset();
+	Push(pending.data(), numPending);
+}
+void Resampler::Reset()
+{
+	// Start with silence before the first frame
+	m_numFrames = m_numTaps / 2 - 1;
+	m_position = m_numFrames;
+	m_fraction = 0;
+	m_input.assign(m_numFrames * 2, 0.0f);
+}
+float* Resampler::m_Reserve(uint32 numFrames)
+{
+	// Drop frames that are no longer in reach of the filter
+	const uint32 firstUsed = Math::Min(m_position + 1 - m_numTaps / 2, m_numFrames);
+	if (firstUsed > 0)
+	{
+		memmove(m_input.data(), m_input.data() + firstUsed * 2, (m_numFrames - firstUsed) * 2 * sizeof(float));
+		m_numFrames -= firstUsed;
+		m_position -= firstUsed;
+	}
+	if (m_input.size() < (m_numFrames + numFrames) * 2)
+		m_input.resize((m_numFrames + numFrames) * 2);
+	float* dst = m_input.data() + m_numFrames * 2;
+	m_numFrames += numFrames;
+	return dst;
+}
+void Resampler::Push(const float* left, const float* right, uint32 numFrames)
+{
+	float* dst = m_Reserve(numFrames);
+	for (uint32 i = 0; i < numFrames; i++)
+	{
+		dst[i * 2] = left[i];
+		dst[i * 2 + 1] = right[i];
+	}
+}
+void Resampler::Push(const float* in, uint32 numFrames)
+{
+	float* dst = m_Reserve(numFrames);
+	memcpy(dst, in, numFrames * 2 * sizeof(float));
+}
+
+double Resampler::m_GetCutoff(double ratio) const
+{
+	// Lower the cutoff when downsampling to remove everything above the new nyquist frequency
+	const double transition = (m_attenuation - 7.95) / (14.36 * m_numTaps);
+	return (0.5 - transition * 0.5) * Math::Min(1.0, 1.0 / ratio);
+}
+void Resampler::m_BuildTable(double cutoff)
+{
+	m_cutoff = cutoff;
+	const int32 halfTaps = m_numTaps / 2;
+	const double beta = 0.1102 * (m_attenuation - 8.7);
+	const double windowScale = 1.0 / BesselI0(beta);
+
+	m_table.resize((numPhases + 1) * m_numTaps * 2);
+	for (uint32 p = 0; p <= numPhases; p++)
+	{
+		const double offset = (double)p / (double)numPhases;
+		float* coeffs = m_table.data() + p * m_numTaps * 2;
+		double kernel[maxTaps];
+		double sum = 0.0;
+		for (int32 k = 0; k < (int32)m_numTaps; k++)
+		{
+			// Distance from the tap to the output position
+			const double d = (double)(k - halfTaps + 1) - offset;
+			double h;
+			if (m_quality == ResampleQuality::Linear)
+			{
+				h = Math::Max(0.0, 1.0 - fabs(d));
+			}
+			else
+			{
+				const double x = d / halfTaps;
+				const double window = fabs(x) < 1.0 ? BesselI0(beta * sqrt(1.0 - x * x)) * windowScale : 0.0;
+				const double t = 2.0 * cutoff * d;
+				const double sinc = fabs(t) < 1e-9 ? 1.0 : sin(Math::pi * t) / (Math::pi * t);
+				h = sinc * window;
+			}
+			kernel[k] = h;
+			sum += h;
+		}
+		// Normalize every phase to unity gain so constant input stays constant
+		for (uint32 k = 0; k < m_numTaps; k++)
+		{
+			coeffs[k * 2] = (float)(kernel[k] / sum);
+			coeffs[k * 2 + 1] = (float)(kernel[k] / sum);
+		}
+	}
+}
+
+void Resampler::SetRatio(double ratio)
+{
+	if (m_quality == ResampleQuality::Linear)
+		return;
+	const double cutoff = m_GetCutoff(ratio);
+	if (fabs(cutoff - m_cutoff) > 1e-4)
+		m_BuildTable(cutoff);
+}
+
+// Filters one output frame, in points at the first input frame under the filter
+static inline void FilterFrame(const float* in, const float* table, uint32 numTaps, uint64 fraction, float* out)
+{
+	const uint32 numValues = numTaps * 2;
+	const uint32 phase = (uint32)(fraction >> phaseShift);
+	const float weight = (float)(fraction & ((1 << phaseShift) - 1)) * phaseWeightScale;
+	const float* c0 = table + phase * numValues;
+	const float* c1 = c0 + numValues;
+
+#ifdef RESAMPLER_SSE
+	// Two stereo frames at a time
+	const __m128 w = _mm_set1_ps(weight);
+	__m128 acc = _mm_setzero_ps();
+	for (uint32 i = 0; i < numValues; i += 4)
+	{
+		const __m128 a = _mm_loadu_ps(c0 + i);
+		const __m128 b = _mm_loadu_ps(c1 + i);
+		const __m128 c = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), w));
+		acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(in + i), c));
+	}
+	acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+	_mm_storel_pi((__m64*)out, acc);
+#else
+	float acc[4] = { 0.0f };
+	for (uint32 i = 0; i < numValues; i += 4)
+	{
+		for (uint32 j = 0; j < 4; j++)
+			acc[j] += in[i + j] * (c0[i + j] + (c1[i + j] - c0[i + j]) * weight);
+	}
+	out[0] = acc[0] + acc[2];
+	out[1] = acc[1] + acc[3];
+#endif
+}
+
+uint32 Resampler::Process(float* out, uint32 numFrames, double ratio)
+{
+	const uint64 increment = (uint64)(ratio * (double)fractionOne);
+	const uint32 halfTaps = m_numTaps / 2;
+	uint32 written = 0;
+
+	// Same rate and on a frame, no filtering needed
+	if (increment == fractionOne && m_fraction == 0)
+	{
+		if (m_position + halfTaps < m_numFrames)
+			written = Math::Min(numFrames, m_numFrames - halfTaps - m_position);
+		memcpy(out, m_input.data() + m_position * 2, written * 2 * sizeof(float));
+		m_position += written;
+		return written;
+	}
+
+	SetRatio(ratio);
+	while (written < numFrames && m_position + halfTaps < m_numFrames)
+	{
+		FilterFrame(m_input.data() + (m_position + 1 - halfTaps) * 2, m_table.data(), m_numTaps, m_fraction, out + written * 2);
+		written++;
+
+		m_fraction += increment;
+		m_position += (uint32)(m_fraction >> fractionBits);
+		m_fraction &= fractionOne - 1;
+	}
+	return written;
+}
+
+uint64 Resampler::GetNumOutputFrames(uint64 numFrames, double ratio)
+{
+	const uint64 increment = (uint64)(ratio * (double)fractionOne);
+	return ((numFrames << fractionBits) + increment - 1) / increment;
+}
+void Resampler::ProcessBuffer(const float* in, uint64 numInFrames, float* out, uint64 firstFrame, uint32 numFrames, double ratio) const
+{
+	const uint64 increment = (uint64)(ratio * (double)fractionOne);
+	const int64 halfTaps = m_numTaps / 2;
+	float edge[maxTaps * 2];
+	for (uint32 i = 0; i < numFrames; i++)
+	{
+		// Same positions as when the whole buffer goes through Process
+		const uint64 position = (firstFrame + i) * increment;
+		const int64 first = (int64)(position >> fractionBits) + 1 - halfTaps;
+		const uint64 fraction = position & (fractionOne - 1);
+		if (first >= 0 && first + m_numTaps <= (int64)numInFrames)
+		{
+			FilterFrame(in + first * 2, m_table.data(), m_numTaps, fraction, out + i * 2);
+		}
+		else
+		{
+			// Silence outside of the buffer
+			for (int64 k = 0; k < (int64)m_numTaps; k++)
+			{
+				const int64 frame = first + k;
+				const bool inside = frame >= 0 && frame < (int64)numInFrames;
+				edge[k * 2] = inside ? in[frame * 2] : 0.0f;
+				edge[k * 2 + 1] = inside ? in[frame * 2 + 1] : 0.0f;
+			}
+			FilterFrame(edge, m_table.data(), m_numTaps, fraction, out + i * 2);
+		}
+	}
+}
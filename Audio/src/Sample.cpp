@@ -2,6 +2,7 @@
 #include "Sample.hpp"
 #include "Audio_Impl.hpp"
 #include "Audio.hpp"
+#include <Shared/SPSCQueue.hpp>
 
 #include "extras/dr_wav.h"   // Enables WAV decoding.
 #include "extras/dr_flac.h"  // Enables FLAC decoding.
@@ -11,43 +12,75 @@
 
 #include "miniaudio.h"
 
+// Sent from the thread that plays a sample to the mixer
+enum class SampleCommand : uint8
+{
+	Play,
+	PlayLooping,
+	Stop,
+};
+
 class Sample_Impl : public SampleRes
 {
 public:
+	// Number of plays of one sample that can be heard at the same time
+	static constexpr uint32 maxVoices = 16;
+
+	struct Voice
+	{
+		uint64 position = 0;
+		// Order in which voices were started, the oldest voice is replaced when all are playing
+		uint64 startIndex = 0;
+		bool active = false;
+		bool looping = false;
+	};
+
 	Buffer m_data;
 	Audio *m_audio;
 	float *m_pcm = nullptr;
-
-	mutex m_lock;
-
-	uint64 m_playbackPointer = 0;
+	// Set for samples made from pcm instead of decoded by miniaudio
+	Vector<float> m_ownedPcm;
 	uint64 m_length = 0;
-	bool m_playing = false;
-	bool m_looping = false;
+
+	// Only used by the mixer
+	Voice m_voices[maxVoices];
+	uint64 m_numStarted = 0;
+
+	SPSCQueue<SampleCommand> m_commands = SPSCQueue<SampleCommand>(256);
+	std::atomic<uint32> m_numPlaying = { 0 };
+	// Counts of queued commands, only changed by the thread that plays the sample
+	std::atomic<uint32> m_numPlaysQueued = { 0 };
+	std::atomic<uint32> m_numStopsQueued = { 0 };
+	// Number of plays that were queued when the sample was stopped last
+	std::atomic<uint32> m_numPlaysAtStop = { 0 };
+	// Counts of commands the mixer has applied, only changed by the mixer
+	std::atomic<uint32> m_numPlaysProcessed = { 0 };
+	std::atomic<uint32> m_numStopsProcessed = { 0 };
+	// Position of the voice that was started last
+	std::atomic<uint64> m_playbackPointer = { 0 };
 
 public:
 	~Sample_Impl()
 	{
 		Deregister();
-		if (m_pcm)
+		if (m_pcm && m_ownedPcm.empty())
 		{
 			ma_free(m_pcm);
 		}
 	}
 	virtual void Play(bool looping) override
 	{
-		m_lock.lock();
-		m_playing = true;
-		m_playbackPointer = 0;
-		m_looping = looping;
-		m_lock.unlock();
+		// Dropped when the mixer is too far behind to play it anyway
+		if (m_commands.TryPush(looping ? SampleCommand::PlayLooping : SampleCommand::Play))
+			m_numPlaysQueued.fetch_add(1, std::memory_order_release);
 	}
 	virtual void Stop() override
 	{
-		m_lock.lock();
-		m_playing = false;
-		m_looping = false;
-		m_lock.unlock();
+		if (m_commands.TryPush(SampleCommand::Stop))
+		{
+			m_numPlaysAtStop.store(m_numPlaysQueued.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			m_numStopsQueued.fetch_add(1, std::memory_order_release);
+		}
 	}
 	bool Init(const String &path)
 	{
@@ -61,34 +94,93 @@ public:
 
 		return true;
 	}
+	void Init(const float *pcm, uint64 numFrames)
+	{
+		m_ownedPcm.assign(pcm, pcm + numFrames * 2);
+		m_pcm = m_ownedPcm.data();
+		m_length = numFrames;
+	}
+	void m_StartVoice(bool looping)
+	{
+		Voice *voice = nullptr;
+		for (Voice &v : m_voices)
+		{
+			// A looping sample that is played again restarts its loop instead of adding another one
+			if (v.active && looping && v.looping)
+			{
+				voice = &v;
+				break;
+			}
+			if (!voice || (!v.active && voice->active) || (v.active && voice->active && v.startIndex < voice->startIndex))
+				voice = &v;
+		}
+		voice->position = 0;
+		voice->startIndex = m_numStarted++;
+		voice->active = true;
+		voice->looping = looping;
+	}
 	virtual void Process(float *out, uint32 numSamples) override
 	{
-		if (!m_playing)
-			return;
-
-		m_lock.lock();
+		SampleCommand command;
+		uint32 numPlays = 0;
+		uint32 numStops = 0;
+		while (m_commands.TryPop(command))
+		{
+			if (command == SampleCommand::Stop)
+			{
+				for (Voice &voice : m_voices)
+					voice.active = false;
+				numStops++;
+			}
+			else
+			{
+				m_StartVoice(command == SampleCommand::PlayLooping);
+				numPlays++;
+			}
+		}
 
-		for (uint32 i = 0; i < numSamples; i++)
+		uint32 numPlaying = 0;
+		uint64 startIndex = 0;
+		for (Voice &voice : m_voices)
 		{
-			if (m_playbackPointer >= m_length)
+			if (!voice.active)
+				continue;
+
+			for (uint32 i = 0; i < numSamples; i++)
 			{
-				if (m_looping)
+				if (voice.position >= m_length)
 				{
-					m_playbackPointer = 0;
+					if (voice.looping && m_length > 0)
+					{
+						voice.position = 0;
+					}
+					else
+					{
+						// Playback ended
+						voice.active = false;
+						break;
+					}
 				}
-				else
+
+				out[i * 2] += m_pcm[voice.position * 2];
+				out[i * 2 + 1] += m_pcm[voice.position * 2 + 1];
+				voice.position++;
+			}
+
+			if (voice.active)
+			{
+				numPlaying++;
+				if (voice.startIndex >= startIndex)
 				{
-					// Playback ended
-					m_playing = false;
-					break;
+					startIndex = voice.startIndex;
+					m_playbackPointer.store(voice.position, std::memory_order_relaxed);
 				}
 			}
-
-			out[i * 2] = m_pcm[m_playbackPointer * 2];
-			out[i * 2 + 1] = m_pcm[m_playbackPointer * 2 + 1];
-			m_playbackPointer++;
 		}
-		m_lock.unlock();
+		m_numPlaying.store(numPlaying, std::memory_order_release);
+		// Published after the voices, so whoever sees the commands applied also sees the voices they changed
+		m_numPlaysProcessed.fetch_add(numPlays, std::memory_order_release);
+		m_numStopsProcessed.fetch_add(numStops, std::memory_order_release);
 	}
 	const Buffer &GetData() const override
 	{
@@ -104,7 +196,7 @@ public:
 	}
 	int32 GetPosition() const override
 	{
-		return m_playbackPointer;
+		return (int32)m_playbackPointer.load(std::memory_order_relaxed);
 	}
 	float *GetPCM() override
 	{
@@ -120,12 +212,21 @@ public:
 	}
 	bool IsPlaying() const override
 	{
-		return m_playing;
+		// Plays that the mixer hasn't started yet count as playing, unless they were stopped again
+		const uint32 numQueued = m_numPlaysQueued.load(std::memory_order_acquire);
+		const uint32 numPending = numQueued - m_numPlaysProcessed.load(std::memory_order_acquire);
+		const uint32 numSinceStop = numQueued - m_numPlaysAtStop.load(std::memory_order_relaxed);
+		if (Math::Min(numPending, numSinceStop) > 0)
+			return true;
+		// Voices only count once the mixer has applied every stop
+		if (m_numStopsProcessed.load(std::memory_order_acquire) != m_numStopsQueued.load(std::memory_order_acquire))
+			return false;
+		return m_numPlaying.load(std::memory_order_acquire) > 0;
 	}
 	void PreRenderDSPs(Vector<DSP *> &DSPs) override {}
 	uint64 GetSamplePos() const override
 	{
-		return m_playbackPointer;
+		return m_playbackPointer.load(std::memory_order_relaxed);
 	}
 };
 
@@ -142,5 +243,13 @@ Sample SampleRes::Create(Audio *audio, const String &path)
 
 	audio->GetImpl()->Register(res);
 
+	return Sample(res);
+}
+Sample SampleRes::Create(Audio *audio, const float *pcm, uint64 numFrames)
+{
+	Sample_Impl *res = new Sample_Impl();
+	res->m_audio = audio;
+	res->Init(pcm, numFrames);
+	audio->GetImpl()->Register(res);
 	return Sample(res);
 }
\ No newline at end of file
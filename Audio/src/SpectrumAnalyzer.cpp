@@ -0,0 +1,107 @@
+#include "stdafx.h"
+#include "SpectrumAnalyzer.hpp"
+
+// Bucket edges in Hz of the original 16 bucket spectrum, other bucket counts are spread over the same curve
+static const float bucketEdges[] = { 0, 200, 400, 600, 800, 1000, 1250, 1500, 1750, 2000, 2500, 3000, 3500, 4000, 5000, 6000, 20000 };
+static const uint32 numBucketEdges = sizeof(bucketEdges) / sizeof(bucketEdges[0]);
+
+static float GetBucketEdge(uint32 bucket, uint32 numBuckets)
+{
+	const float position = (float)bucket / (float)numBuckets * (float)(numBucketEdges - 1);
+	const uint32 index = Math::Min((uint32)position, numBucketEdges - 2);
+	const float t = position - (float)index;
+	return bucketEdges[index] + (bucketEdges[index + 1] - bucketEdges[index]) * t;
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer()
+{
+	m_history.resize(maxWindowSize * 2);
+	SetSize(1024, 16);
+}
+
+void SpectrumAnalyzer::SetSize(uint32 windowSize, uint32 numBuckets)
+{
+	m_fft.SetSize(Math::Clamp(windowSize, minWindowSize, maxWindowSize));
+	m_numBuckets = Math::Clamp(numBuckets, 1u, maxBuckets);
+
+	// Hann window
+	const uint32 size = m_fft.GetSize();
+	m_window.resize(size);
+	for (uint32 i = 0; i < size; i++)
+	{
+		const double s = sin(Math::pi * (double)i / (double)size);
+		m_window[i] = (float)(s * s);
+	}
+	m_buffer.resize(size);
+	m_magnitudes.resize(m_numBuckets);
+	m_UpdateBuckets();
+}
+void SpectrumAnalyzer::SetSampleRate(uint32 sampleRate)
+{
+	m_sampleRate = Math::Max(sampleRate, 1u);
+	m_UpdateBuckets();
+}
+void SpectrumAnalyzer::m_UpdateBuckets()
+{
+	const uint32 size = m_fft.GetSize();
+	m_bucketBins.resize(m_numBuckets);
+	for (uint32 i = 0; i < m_numBuckets; i++)
+	{
+		// Bins with a frequency from the start to the end of the bucket, including both edges
+		const double binsPerHz = (double)size / (double)m_sampleRate;
+		const uint32 first = (uint32)ceil(GetBucketEdge(i, m_numBuckets) * binsPerHz);
+		const uint32 last = Math::Min((uint32)floor(GetBucketEdge(i + 1, m_numBuckets) * binsPerHz), size / 2 - 1);
+		m_bucketBins[i] = { first, last };
+	}
+}
+
+void SpectrumAnalyzer::Push(const float* samples, uint32 numFrames)
+{
+	const uint64 numPushed = m_numPushed.load(std::memory_order_relaxed);
+	const uint64 mask = m_history.size() - 1;
+	for (uint32 i = 0; i < numFrames; i++)
+		m_history[(numPushed + i) & mask] = (samples[i * 2] + samples[i * 2 + 1]) * 0.5f;
+	m_numPushed.store(numPushed + numFrames, std::memory_order_release);
+}
+
+void SpectrumAnalyzer::Process(float* buckets, float* bucketsN)
+{
+	const uint32 size = m_fft.GetSize();
+	const uint64 numPushed = m_numPushed.load(std::memory_order_acquire);
+	const uint64 mask = m_history.size() - 1;
+	for (uint32 i = 0; i < size; i++)
+	{
+		// Silence before the first pushed samples
+		const uint64 position = numPushed + i;
+		m_buffer[i] = position >= size ? m_history[(position - size) & mask] * m_window[i] : 0.0f;
+	}
+
+	m_fft.Forward(m_buffer.data());
+
+	float maxMagnitude = 0.0f;
+	for (uint32 i = 0; i < m_numBuckets; i++)
+	{
+		float peak = 0.0f;
+		for (uint32 bin = m_bucketBins[i].first; bin <= m_bucketBins[i].second; bin++)
+		{
+			// Bin 0 is packed with the real part of the highest bin
+			const float real = m_buffer[bin * 2];
+			const float imag = bin > 0 ? m_buffer[bin * 2 + 1] : 0.0f;
+			peak = Math::Max(peak, sqrtf(real * real + imag * imag) * 2.0f / (float)size);
+		}
+		m_magnitudes[i] = peak;
+		maxMagnitude = Math::Max(maxMagnitude, peak);
+	}
+
+	// scale output
+	for (uint32 i = 0; i < m_numBuckets; i++)
+	{
+		const double bin = m_magnitudes[i];
+		double base = 0.5 * (bin * 6.0); // bass
+		double mag = maxMagnitude > 0.0f ? 0.2 * (bin * 0.5 / maxMagnitude) : 0.0; // mid
+		double lin = 0.7 * bin * i * 16.0 / m_numBuckets; // high notes
+		double exp = 0.6 * std::log(Math::Max(bin, 1e-6) * 1000.0) * 0.125;
+		buckets[i] = (float)((base + lin + mag + exp) * 0.75);
+		bucketsN[i] = (float)bin;
+	}
+}
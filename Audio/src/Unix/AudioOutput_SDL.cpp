@@ -59,7 +59,7 @@ public:
 			SDL_CloseAudioDevice(m_deviceId);
 		m_deviceId = 0;
 	}
-	bool OpenDevice(const char* dev)
+	bool OpenDevice(const char* dev, uint32 bufferSize)
 	{
 		CloseDevice();
 
@@ -69,7 +69,8 @@ public:
 		desiredSpec.freq = 44100;
 		desiredSpec.format = AUDIO_F32;
 		desiredSpec.channels = 2;    /* 1 = mono, 2 = stereo */
-		desiredSpec.samples = 1024;  /* Good low-latency value for callback */
+		// 0 is passed on, SDL then picks its own default (about 46ms, or the SDL_AUDIO_SAMPLES hint)
+		desiredSpec.samples = (Uint16)Math::Min(bufferSize, 8192u);
 		desiredSpec.callback = (SDL_AudioCallback)&AudioOutput_Impl::FillBuffer;
 		desiredSpec.userdata = this;
 
@@ -84,20 +85,24 @@ public:
 		}
 
 
-		m_deviceId = SDL_OpenAudioDevice(dev, 0, &desiredSpec, &m_audioSpec, SDL_AUDIO_ALLOW_ANY_CHANGE);
+		// The mixer only writes floats
+		m_deviceId = SDL_OpenAudioDevice(dev, 0, &desiredSpec, &m_audioSpec,
+			SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_CHANNELS_CHANGE | SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
 		if(m_deviceId == 0 || m_deviceId < 2)
 		{
             const char* errMsg = SDL_GetError();
             Logf("Failed to open SDL audio device: %s", Logger::Severity::Error, errMsg);
 			return false;
         }
+		Logf("Opened audio device: %dHz, %d channels, %d frames per callback (%.1fms), %d requested", Logger::Severity::Info,
+			m_audioSpec.freq, m_audioSpec.channels, m_audioSpec.samples, m_audioSpec.samples * 1000.0 / m_audioSpec.freq, desiredSpec.samples);
 
 		SDL_PauseAudioDevice(m_deviceId, 0);
 		return true;
 	}
-	bool Init()
+	bool Init(uint32 bufferSize)
 	{
-		OpenDevice(nullptr);
+		OpenDevice(nullptr, bufferSize);
 		return true;
 	}
 	static void SDLCALL FillBuffer(AudioOutput_Impl* self, float* data, int len)
@@ -116,9 +121,9 @@ AudioOutput::~AudioOutput()
 {
 	delete m_impl;
 }
-bool AudioOutput::Init(bool exclusive)
+bool AudioOutput::Init(bool exclusive, uint32 bufferSize)
 {
-	return m_impl->Init();
+	return m_impl->Init(bufferSize);
 }
 uint32_t AudioOutput::GetNumChannels() const
 {
@@ -130,7 +135,13 @@ uint32_t AudioOutput::GetSampleRate() const
 }
 double AudioOutput::GetBufferLength() const
 {
-	return 0;
+	if (m_impl->m_audioSpec.freq == 0)
+		return 0;
+	return (double)m_impl->m_audioSpec.samples / (double)m_impl->m_audioSpec.freq;
+}
+uint32_t AudioOutput::GetPeriodSize() const
+{
+	return m_impl->m_audioSpec.samples;
 }
 void AudioOutput::Start(IMixer* mixer)
 {
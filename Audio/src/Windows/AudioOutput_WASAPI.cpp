@@ -66,6 +66,8 @@ public:
 	NotificationClient m_notificationClient;
 
 	double m_bufferLength;
+	// Requested buffer size in frames, 0 for the default length
+	uint32 m_bufferSize = 0;
 
 	// Dummy audio output
 	static const uint32 m_dummyChannelCount = 2;
@@ -190,6 +192,8 @@ public:
 		WAVEFORMATEX* mixFormat = nullptr;
 		WAVEFORMATEX* closestFormat = nullptr;
 		res = m_audioClient->GetMixFormat(&mixFormat);
+		const REFERENCE_TIME duration = m_bufferSize > 0 ?
+			(REFERENCE_TIME)m_bufferSize * REFTIMES_PER_SEC / mixFormat->nSamplesPerSec : bufferDuration;
 		if (m_exclusive)
 		{
 			// Aquire format and initialize device for exclusive mode
@@ -254,7 +258,7 @@ public:
 			}
 			// Init client
 			res = m_audioClient->Initialize(AUDCLNT_SHAREMODE_EXCLUSIVE, 0,
-				bufferDuration, defaultDevicePeriod, mixFormat, nullptr);
+				Math::Max(duration, defaultDevicePeriod), defaultDevicePeriod, mixFormat, nullptr);
 		}
 		else
 		{
@@ -266,7 +270,7 @@ public:
 			}
 			// Init client
 			res = m_audioClient->Initialize(AUDCLNT_SHAREMODE_SHARED, 0,
-				bufferDuration, 0, mixFormat, nullptr);
+				duration, 0, mixFormat, nullptr);
 		}
 		// Store selected format
 		m_format = *mixFormat;
@@ -428,8 +432,9 @@ AudioOutput::~AudioOutput()
 {
 	delete m_impl;
 }
-bool AudioOutput::Init(bool exclusive)
+bool AudioOutput::Init(bool exclusive, uint32 bufferSize)
 {
+	m_impl->m_bufferSize = bufferSize;
 	return m_impl->Init(exclusive);
 }
 void AudioOutput::Start(IMixer* mixer)
@@ -454,6 +459,11 @@ double AudioOutput::GetBufferLength() const
 {
 	return m_impl->m_bufferLength;
 }
+uint32_t AudioOutput::GetPeriodSize() const
+{
+	// The mixer thread fills whatever part of the buffer was played
+	return 0;
+}
 bool AudioOutput::IsIntegerFormat() const
 {
 	///TODO: check more cases?
@@ -2,6 +2,7 @@
 #include "Beatmap.hpp"
 #include "json.hpp"
 #include "PlaybackOptions.hpp"
+#include <Shared/SortKey.hpp>
 
 struct SimpleHitStat
 {
@@ -95,6 +96,17 @@ struct ChartIndex
 	uint64 lwt;
 	int32 custom_offset = 0;
 	Vector<ScoreIndex*> scores;
+
+	// Case folded title, artist and effector used for sorting, see SortKey
+	String title_sortkey;
+	String artist_sortkey;
+	String effector_sortkey;
+	void UpdateSortKeys()
+	{
+		title_sortkey = SortKey::Make(title);
+		artist_sortkey = SortKey::Make(artist);
+		effector_sortkey = SortKey::Make(effector);
+	}
 };
 
 // Map located in database
@@ -119,6 +131,8 @@ struct ChallengeIndex
 	int32 totalNumCharts; // Note: This is not the number found
 	nlohmann::json settings;
 	String title;
+	// Case folded title used for sorting
+	String title_sortkey;
 	int32 clearMark;
 	int32 bestScore;
 	String reqText;
@@ -203,7 +217,10 @@ public:
 	void PauseSearching();
 	void ResumeSearching();
 	void StopSearching();
-	void LoadDatabaseWithoutSearching();
+	// Scores are read on a worker and added by Update unless waitForScores is set
+	void LoadDatabaseWithoutSearching(bool waitForScores = true);
+	// Charts are available right after loading, their scores are still being added by Update while this is true
+	bool IsLoadingScores() const;
 
 	// Finds maps using the search query provided
 	// search artist/title/tags for maps for any space separated terms
@@ -232,6 +249,8 @@ public:
 
 	//Attempts to add to collection, if that fails attempt to remove from collection
 	void AddOrRemoveToCollection(const String& name, int32 mapid);
+	// Changes every time a collection changes
+	uint32 GetCollectionsVersion() const;
 	void AddSearchPath(const String& path);
 	void AddScore(ScoreIndex* score);
 
@@ -242,6 +261,8 @@ public:
 	void UpdateChartOffset(const ChartIndex* chart);
 
 	void SetChartUpdateBehavior(bool transferScores);
+	// Seconds between rescans of the search paths when the platform can't notify about changes to them
+	void SetWatchPollInterval(float seconds);
 
 	Delegate<String> OnSearchStatusUpdated;
 	// (mapId, mapIndex)
@@ -266,4 +287,5 @@ public:
 private:
 	class MapDatabase_Impl* m_impl;
 	bool m_transferScores = false;
+	float m_watchPollInterval = 60.0f;
 };
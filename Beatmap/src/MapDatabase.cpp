@@ -5,6 +5,7 @@
 #include "TinySHA1.hpp"
 #include "Shared/Profiling.hpp"
 #include "Shared/Files.hpp"
+#include "Shared/FileWatcher.hpp"
 #include "Shared/Time.hpp"
 #include "KShootMap.hpp"
 #include <thread>
@@ -47,6 +48,9 @@ public:
 	int32 m_nextChalId = 1;
 	String m_sortField = "title";
 	bool m_transferScores = true;
+	std::atomic<float> m_watchPollInterval = { 60.0f };
+	// Incremented whenever a collection changes
+	uint32 m_collectionsVersion = 0;
 
 	struct SearchState
 	{
@@ -80,8 +84,9 @@ public:
 		String path;
 		// Current lwt of file
 		uint64 lwt;
-		// Id of the map
-		int32 id;
+		// Id of the map, -1 if it's not known yet
+		//	these are matched to existing charts by their path when the change is applied
+		int32 id = -1;
 		// Scanned map data, for added/updated maps
 		BeatmapSettings* mapData = nullptr;
 		nlohmann::json json;
@@ -90,6 +95,24 @@ public:
 	List<Event> m_pendingChanges;
 	mutex m_pendingChangesLock;
 
+	// Scores are read by a worker after the charts are loaded, so charts can be shown before all scores are read
+	//	scores up to the last one that existed when loading started are read, in order of their rowid
+	//	Update adds the scores that were read so far to their charts
+	thread m_scoreThread;
+	mutex m_loadedScoresLock;
+	Vector<ScoreIndex*> m_loadedScores;
+	std::atomic<bool> m_scoresRead = { false };
+	std::atomic<bool> m_stopReadingScores = { false };
+	int32 m_scoreStreamMaxId = 0;
+	// Charts that were loaded without their scores, charts added later read their own scores
+	Set<int32> m_chartsAwaitingScores;
+	// Ids of those charts by the hash they had when loaded, which is what their streamed scores are stored under
+	//	the chart's hash can change while its scores are still being read
+	Map<String, int32> m_chartsAwaitingScoresByHash;
+	// Folders to send an update for once all scores are loaded
+	Set<int32> m_scoreStreamFolders;
+	static constexpr int32 m_scoreStreamBatchSize = 1000;
+
 	static const int32 m_version = 20;
 
 public:
@@ -443,6 +466,7 @@ public:
 	~MapDatabase_Impl()
 	{
 		StopSearching();
+		m_StopReadingScores();
 		m_CleanupMapIndex();
 
 		//discard pending changes, probably should apply them(?)
@@ -453,18 +477,26 @@ public:
 				delete c.mapData;
 		}
 	}
-	void LoadDatabaseWithoutSearching()
+	void LoadDatabaseWithoutSearching(bool waitForScores)
 	{
 		// Apply previous diff to prevent duplicated entry 
 		Update();
 		// Create initial data set to compare to when evaluating if a file is added/removed/updated
 		m_LoadInitialData();
+		if(waitForScores && m_scoreThread.joinable())
+		{
+			m_scoreThread.join();
+			m_AddLoadedScores();
+		}
 	}
 	void StartSearching()
 	{
 		if(m_searching)
 			return;
 
+		// Stop watching for changes after the previous search
+		m_interruptSearch = true;
+		ResumeSearching();
 		if(m_thread.joinable())
 			m_thread.join();
 		// Apply previous diff to prevent duplicated entry 
@@ -511,6 +543,13 @@ public:
 		m_pendingChanges.emplace_back(change);
 		m_pendingChangesLock.unlock();
 	}
+	// Add multiple changes at once, so they get applied in the same update
+	void AddChanges(List<Event>& changes)
+	{
+		m_pendingChangesLock.lock();
+		m_pendingChanges.splice(m_pendingChanges.end(), changes);
+		m_pendingChangesLock.unlock();
+	}
 	// Removes changes from the queue and returns them
 	//	additionally you can specify the maximum amount of changes to remove from the queue
 	List<Event> FlushChanges(size_t maxChanges = -1)
@@ -609,6 +648,7 @@ public:
 	// TODO(itszn) make this not case sensitive
 	Map<int32, FolderIndex*> FindFoldersByPath(const String& searchString)
 	{
+		ProfilerZone $("MapDatabase::FindFoldersByPath");
 		String stmt = "SELECT DISTINCT folderId FROM Charts WHERE path LIKE ?";
 		DBStatement search = m_database.Query(stmt);
 		search.BindString(1, "%" + searchString + "%");
@@ -629,6 +669,7 @@ public:
 
 	Map<int32, ChallengeIndex*> FindChallenges(const String& searchString)
 	{
+		ProfilerZone $("MapDatabase::FindChallenges");
 		WString test = Utility::ConvertToWString(searchString);
 		String stmt = "SELECT DISTINCT rowid FROM Challenges WHERE";
 
@@ -672,6 +713,7 @@ public:
 
 	Map<int32, FolderIndex*> FindFoldersWithFilter(const String& searchString, const Vector<std::pair<String, String>> filters)
 	{
+		ProfilerZone $("MapDatabase::FindFolders");
 		WString test = Utility::ConvertToWString(searchString);
 		String stmt = "SELECT DISTINCT folderId FROM Charts";
 
@@ -791,6 +833,7 @@ public:
 
 	Map<int32, FolderIndex*> FindFoldersByCollection(const String& collection)
 	{
+		ProfilerZone $("MapDatabase::FindFoldersByCollection");
 		String stmt = "SELECT folderid FROM Collections WHERE collection==?";
 		DBStatement search = m_database.Query(stmt);
 		search.BindString(1, collection);
@@ -812,6 +855,7 @@ public:
 
 	Map<int32, FolderIndex*> FindFoldersByFolder(const String& folder)
 	{
+		ProfilerZone $("MapDatabase::FindFoldersByFolder");
 		char csep[2];
 		csep[0] = Path::sep;
 		csep[1] = 0;
@@ -834,9 +878,17 @@ public:
 
 		return res;
 	}
+	bool IsLoadingScores() const
+	{
+		return m_scoreStreamMaxId > 0;
+	}
+
 	// Processes pending database changes
 	void Update()
 	{
+		if(IsLoadingScores())
+			m_AddLoadedScores();
+
 		List<Event> changes = FlushChanges();
 		if(changes.empty())
 			return;
@@ -874,6 +926,12 @@ public:
 		m_database.Exec("BEGIN");
 		for(Event& e : changes)
 		{
+			if(e.type == Event::Chart && !m_ResolveChart(e))
+			{
+				if(e.mapData)
+					delete e.mapData;
+				continue;
+			}
 			if (e.type == Event::Challenge && (e.action == Event::Added || e.action == Event::Updated))
 			{
 				ChallengeIndex* chal;
@@ -896,6 +954,7 @@ public:
 				}
 				chal->settings = e.json;
 				chal->settings["title"].get_to(chal->title);
+				chal->title_sortkey = SortKey::Make(chal->title);
 				chal->path = e.path;
 				chal->settings["level"].get_to(chal->level);
 				if (e.action == Event::Added)
@@ -1022,40 +1081,13 @@ public:
 				chart->illustrator = e.mapData->illustrator;
 				chart->jacket_path = e.mapData->jacketPath;
 				chart->hash = e.hash;
+				chart->UpdateSortKeys();
 
 				// Check for existing scores for this chart
 				scoreScan.BindString(1, chart->hash);
 				while (scoreScan.StepRow())
 				{
-					ScoreIndex* score = new ScoreIndex();
-					score->id = scoreScan.IntColumn(0);
-					score->score = scoreScan.IntColumn(1);
-					score->crit = scoreScan.IntColumn(2);
-					score->almost = scoreScan.IntColumn(3);
-					score->early = scoreScan.IntColumn(4);
-					score->late = scoreScan.IntColumn(5);
-					score->combo = scoreScan.IntColumn(6);
-					score->miss = scoreScan.IntColumn(7);
-					score->gauge = (float)scoreScan.DoubleColumn(8);
-					score->autoFlags = (AutoFlags)scoreScan.IntColumn(9);
-					score->replayPath = scoreScan.StringColumn(10);
-
-					score->timestamp = scoreScan.Int64Column(11);
-					score->chartHash = scoreScan.StringColumn(12);
-					score->userName = scoreScan.StringColumn(13);
-					score->userId = scoreScan.StringColumn(14);
-					score->localScore = scoreScan.IntColumn(15);
-
-					score->hitWindowPerfect = scoreScan.IntColumn(16);
-					score->hitWindowGood = scoreScan.IntColumn(17);
-					score->hitWindowHold = scoreScan.IntColumn(18);
-					score->hitWindowMiss = scoreScan.IntColumn(19);
-					score->hitWindowSlam = scoreScan.IntColumn(20);
-
-					score->gaugeType = (GaugeType)scoreScan.IntColumn(21);
-					score->gaugeOption = scoreScan.IntColumn(22);
-					score->mirror = scoreScan.IntColumn(23) == 1;
-					score->random = scoreScan.IntColumn(24) == 1;
+					ScoreIndex* score = m_ReadScore(scoreScan);
 					chart->scores.Add(score);
 				}
 				scoreScan.Rewind();
@@ -1146,6 +1178,7 @@ public:
 				chart->bpm = e.mapData->bpm;
 				chart->illustrator = e.mapData->illustrator;
 				chart->jacket_path = e.mapData->jacketPath;
+				chart->UpdateSortKeys();
 
 
 				// Check if the hash has changed...
@@ -1155,6 +1188,13 @@ public:
 					moveScores.Step();
 					moveScores.Rewind();
 				}
+				if (chart->hash != e.hash)
+				{
+					auto itHash = m_chartsByHash.find(chart->hash);
+					if (itHash != m_chartsByHash.end() && itHash->second == chart)
+						m_chartsByHash.erase(itHash);
+					m_chartsByHash.Add(e.hash, chart);
+				}
 				chart->hash = e.hash;
 
 
@@ -1174,6 +1214,11 @@ public:
 
 				itFolder->second->charts.Remove(itChart->second);
 
+				auto itHash = m_chartsByHash.find(itChart->second->hash);
+				if (itHash != m_chartsByHash.end() && itHash->second == itChart->second)
+					m_chartsByHash.erase(itHash);
+				m_chartsAwaitingScores.erase(e.id);
+
 				for (auto s : itChart->second->scores)
 				{
 					delete s;
@@ -1448,6 +1493,7 @@ public:
 			remColl.Step();
 			remColl.Rewind();
 		}
+		m_collectionsVersion++;
 	}
 
 	ChartIndex* GetRandomChart()
@@ -1494,6 +1540,10 @@ public:
 		m_transferScores = transferScores;
 	}
 
+	void SetWatchPollInterval(float seconds) {
+		m_watchPollInterval.store(seconds);
+	}
+
 private:
 	void m_CleanupMapIndex()
 	{
@@ -1516,6 +1566,8 @@ private:
 		}
 		m_folders.clear();
 		m_charts.clear();
+		m_chartsByHash.clear();
+		m_foldersByPath.clear();
 		m_practiceSetups.clear();
 		m_practiceSetupsByChartId.clear();
 	}
@@ -1626,6 +1678,7 @@ private:
 		m_searchState.difficulties.clear();
 
 		// Scan original maps
+		m_StopReadingScores();
 		m_CleanupMapIndex();
 
 		// Select Maps
@@ -1688,6 +1741,7 @@ private:
 			chart->preview_length = chartScan.IntColumn(18);
 			chart->lwt = chartScan.Int64Column(19);
 			chart->custom_offset = chartScan.IntColumn(20);
+			chart->UpdateSortKeys();
 
 			// Add existing diff
 			m_charts.Add(chart->id, chart);
@@ -1697,7 +1751,6 @@ private:
 			auto folderIt = m_folders.find(chart->folderId);
 			assert(folderIt != m_folders.end());
 			folderIt->second->charts.Add(chart);
-			m_SortCharts(folderIt->second);
 
 			// Add to search state
 			SearchState::ExistingFileEntry ed;
@@ -1713,53 +1766,25 @@ private:
 			m_searchState.difficulties.Add(chart->path, ed);
 		}
 
-		// Select Scores
-		DBStatement scoreScan = m_database.Query("SELECT "
-			"rowid,score,crit,near,early,late,combo,miss,gauge,auto_flags,replay,timestamp,chart_hash,user_name,user_id,local_score,window_perfect,window_good,window_hold,window_miss,window_slam,gauge_type,gauge_opt,mirror,random "
-			"FROM Scores");
-		
-		while (scoreScan.StepRow())
-		{
-			ScoreIndex* score = new ScoreIndex();
-			score->id = scoreScan.IntColumn(0);
-			score->score = scoreScan.IntColumn(1);
-			score->crit = scoreScan.IntColumn(2);
-			score->almost = scoreScan.IntColumn(3);
-			score->early = scoreScan.IntColumn(4);
-			score->late = scoreScan.IntColumn(5);
-			score->combo = scoreScan.IntColumn(6);
-			score->miss = scoreScan.IntColumn(7);
-			score->gauge = (float) scoreScan.DoubleColumn(8);
-			score->autoFlags = (AutoFlags)scoreScan.IntColumn(9);
-			score->replayPath = scoreScan.StringColumn(10);
-
-			score->timestamp = scoreScan.Int64Column(11);
-			score->chartHash = scoreScan.StringColumn(12);
-			score->userName = scoreScan.StringColumn(13);
-			score->userId = scoreScan.StringColumn(14);
-			score->localScore = scoreScan.IntColumn(15);
-
-			score->hitWindowPerfect = scoreScan.IntColumn(16);
-			score->hitWindowGood = scoreScan.IntColumn(17);
-			score->hitWindowHold = scoreScan.IntColumn(18);
-			score->hitWindowMiss = scoreScan.IntColumn(19);
-			score->hitWindowSlam = scoreScan.IntColumn(20);
-
-			score->gaugeType = (GaugeType)scoreScan.IntColumn(21);
-			score->gaugeOption = scoreScan.IntColumn(22);
-			score->mirror = scoreScan.IntColumn(23) == 1;
-			score->random = scoreScan.IntColumn(24) == 1;
+		// Sort once all charts are in their folders
+		for(auto& folder : m_folders)
+			m_SortCharts(folder.second);
 
-			// Add difficulty to map and resort difficulties
-			auto diffIt = m_chartsByHash.find(score->chartHash);
-			if (diffIt == m_chartsByHash.end()) // If for whatever reason the diff that the score is attatched to is not in the db, ignore the score.
+		// Scores are read in afterwards
+		DBStatement lastScore = m_database.Query("SELECT MAX(rowid) FROM Scores");
+		if(lastScore.StepRow())
+			m_scoreStreamMaxId = lastScore.IntColumn(0);
+		lastScore.Finish();
+		if(m_scoreStreamMaxId > 0)
+		{
+			for(auto& chart : m_charts)
 			{
-				delete score;
-				continue;
+				m_chartsAwaitingScores.Add(chart.first);
+				m_chartsAwaitingScoresByHash.Add(chart.second->hash, chart.first);
 			}
-
-			diffIt->second->scores.Add(score);
-			m_SortScores(diffIt->second);
+			m_scoresRead = false;
+			m_stopReadingScores = false;
+			m_scoreThread = thread(&MapDatabase_Impl::m_ReadScores, this, m_scoreStreamMaxId);
 		}
 
 		// Select Practice setups
@@ -1817,6 +1842,7 @@ private:
 			ChallengeIndex* chal = new ChallengeIndex();
 			chal->id = chalScan.IntColumn(0);
 			chal->title = chalScan.StringColumn(1);
+			chal->title_sortkey = SortKey::Make(chal->title);
 			String chartsString = chalScan.StringColumn(2);
 			chal->clearMark = chalScan.IntColumn(3);
 			chal->bestScore = chalScan.IntColumn(4);
@@ -1878,10 +1904,164 @@ private:
 			return a->score > b->score;
 		});
 	}
+	// Reads a score selected with the columns used by all score queries
+	ScoreIndex* m_ReadScore(DBStatement& scoreScan)
+	{
+		ScoreIndex* score = new ScoreIndex();
+		score->id = scoreScan.IntColumn(0);
+		score->score = scoreScan.IntColumn(1);
+		score->crit = scoreScan.IntColumn(2);
+		score->almost = scoreScan.IntColumn(3);
+		score->early = scoreScan.IntColumn(4);
+		score->late = scoreScan.IntColumn(5);
+		score->combo = scoreScan.IntColumn(6);
+		score->miss = scoreScan.IntColumn(7);
+		score->gauge = (float) scoreScan.DoubleColumn(8);
+		score->autoFlags = (AutoFlags)scoreScan.IntColumn(9);
+		score->replayPath = scoreScan.StringColumn(10);
+
+		score->timestamp = scoreScan.Int64Column(11);
+		score->chartHash = scoreScan.StringColumn(12);
+		score->userName = scoreScan.StringColumn(13);
+		score->userId = scoreScan.StringColumn(14);
+		score->localScore = scoreScan.IntColumn(15);
+
+		score->hitWindowPerfect = scoreScan.IntColumn(16);
+		score->hitWindowGood = scoreScan.IntColumn(17);
+		score->hitWindowHold = scoreScan.IntColumn(18);
+		score->hitWindowMiss = scoreScan.IntColumn(19);
+		score->hitWindowSlam = scoreScan.IntColumn(20);
+
+		score->gaugeType = (GaugeType)scoreScan.IntColumn(21);
+		score->gaugeOption = scoreScan.IntColumn(22);
+		score->mirror = scoreScan.IntColumn(23) == 1;
+		score->random = scoreScan.IntColumn(24) == 1;
+		return score;
+	}
+	// Score worker, reads the scores up to maxId in batches so the database isn't held by a single query
+	//	the connection is shared with the main thread, sqlite serializes the calls
+	void m_ReadScores(int32 maxId)
+	{
+		ProfilerScope $("Chart Database - Read Scores");
+		int32 lastId = 0;
+		int32 numScores = m_scoreStreamBatchSize;
+		while (numScores == m_scoreStreamBatchSize && !m_stopReadingScores)
+		{
+			DBStatement scoreScan = m_database.Query("SELECT "
+				"rowid,score,crit,near,early,late,combo,miss,gauge,auto_flags,replay,timestamp,chart_hash,user_name,user_id,local_score,window_perfect,window_good,window_hold,window_miss,window_slam,gauge_type,gauge_opt,mirror,random "
+				"FROM Scores WHERE rowid > ? AND rowid <= ? ORDER BY rowid LIMIT ?");
+			scoreScan.BindInt(1, lastId);
+			scoreScan.BindInt(2, maxId);
+			scoreScan.BindInt(3, m_scoreStreamBatchSize);
+
+			Vector<ScoreIndex*> scores;
+			scores.reserve(m_scoreStreamBatchSize);
+			while (scoreScan.StepRow())
+				scores.Add(m_ReadScore(scoreScan));
+			scoreScan.Finish();
+			numScores = (int32)scores.size();
+			if (!scores.empty())
+				lastId = scores.back()->id;
+
+			m_loadedScoresLock.lock();
+			m_loadedScores.insert(m_loadedScores.end(), scores.begin(), scores.end());
+			m_loadedScoresLock.unlock();
+		}
+		m_scoresRead = true;
+	}
+	// Adds the scores the worker has read so far to the charts that were loaded without them
+	//	folders of charts that got scores are updated once all scores are loaded
+	void m_AddLoadedScores()
+	{
+		// Checked before taking the scores, so no score is read after it is set
+		const bool allRead = m_scoresRead;
+		Vector<ScoreIndex*> scores;
+		m_loadedScoresLock.lock();
+		scores.swap(m_loadedScores);
+		m_loadedScoresLock.unlock();
+
+		Set<ChartIndex*> scoredCharts;
+		for (ScoreIndex* score : scores)
+		{
+			// Scores are stored under the hash the chart was loaded with, unless they were moved to its new hash before being read
+			ChartIndex* chart = nullptr;
+			int32* chartId = m_chartsAwaitingScoresByHash.Find(score->chartHash);
+			if (chartId)
+			{
+				ChartIndex** found = m_charts.Find(*chartId);
+				chart = found ? *found : nullptr;
+			}
+			else
+			{
+				ChartIndex** found = m_chartsByHash.Find(score->chartHash);
+				chart = found ? *found : nullptr;
+			}
+
+			// If for whatever reason the diff that the score is attatched to is not in the db, ignore the score.
+			// Charts added after loading already have their scores.
+			if (!chart || !m_chartsAwaitingScores.Contains(chart->id))
+			{
+				delete score;
+				continue;
+			}
+
+			chart->scores.Add(score);
+			scoredCharts.Add(chart);
+		}
+
+		for (ChartIndex* chart : scoredCharts)
+		{
+			m_SortScores(chart);
+			m_scoreStreamFolders.Add(chart->folderId);
+		}
+
+		if (!allRead)
+			return;
+
+		// All scores are loaded
+		if (m_scoreThread.joinable())
+			m_scoreThread.join();
+		m_scoreStreamMaxId = 0;
+		m_chartsAwaitingScores.clear();
+		m_chartsAwaitingScoresByHash.clear();
+		Vector<FolderIndex*> updatedFolders;
+		for (int32 folderId : m_scoreStreamFolders)
+		{
+			FolderIndex** folder = m_folders.Find(folderId);
+			if (folder)
+				updatedFolders.Add(*folder);
+		}
+		m_scoreStreamFolders.clear();
+		if (!updatedFolders.empty())
+			m_outer.OnFoldersUpdated.Call(updatedFolders);
+	}
+	// Stops the score worker and drops the scores it read
+	void m_StopReadingScores()
+	{
+		m_stopReadingScores = true;
+		if (m_scoreThread.joinable())
+			m_scoreThread.join();
+		for (ScoreIndex* score : m_loadedScores)
+			delete score;
+		m_loadedScores.clear();
+		m_scoreStreamMaxId = 0;
+		m_chartsAwaitingScores.clear();
+		m_chartsAwaitingScoresByHash.clear();
+		m_scoreStreamFolders.clear();
+	}
 
 	// Main search thread
 	void m_SearchThread()
 	{
+		Profiler::SetThreadName("Chart Database");
+
+		// Start watching before scanning, changes made during the scan are applied afterwards
+		Vector<String> chartExts = { "ksh" };
+		FileWatcher watcher(chartExts);
+		watcher.pollInterval = m_watchPollInterval.load();
+		for(String rootSearchPath : m_searchPaths)
+			watcher.Watch(rootSearchPath);
+
 		Map<String, FileInfo> fileList;
 		Map<String, FileInfo> challengeFileList;
 		Map<String, FileInfo> legacyChallengeFileList;
@@ -1910,6 +2090,7 @@ private:
 					legacyChallengeFileList.Add(fi.fullPath, fi);
 				}
 			}
+			watcher.SetFiles(fileList);
 			m_outer.OnSearchStatusUpdated.Call("[END] Chart Database - Enumerate Files and Folders");
 		}
 
@@ -1973,47 +2154,8 @@ private:
 					evt.action = Event::Added;
 				}
 
-				Logf("Discovered Chart [%s]", Logger::Severity::Info, f.first);
 				m_outer.OnSearchStatusUpdated.Call(Utility::Sprintf("Discovered Chart [%s]", f.first));
-				// Try to read map metadata
-				bool mapValid = false;
-				File fileStream;
-				Beatmap map;
-				if(fileStream.OpenRead(f.first))
-				{
-					FileReader reader(fileStream);
-
-					if(map.Load(reader, true))
-					{
-						mapValid = true;
-					}
-				}
-
-				if(mapValid)
-				{
-					fileStream.Seek(0);
-					evt.mapData = new BeatmapSettings(map.GetMapSettings());
-
-					ProfilerScope $("Chart Database - Hash Chart");
-					char data_buffer[0x80];
-					uint32_t digest[5];
-					sha1::SHA1 s;
-
-					size_t amount_read = 0;
-					size_t read_size;
-					do
-					{
-						read_size = fileStream.Read(data_buffer, sizeof(data_buffer));
-						amount_read += read_size;
-						s.processBytes(data_buffer, read_size);
-					}
-					while (read_size != 0);
-						
-					s.getDigest(digest);
-
-					evt.hash = Utility::Sprintf("%08x%08x%08x%08x%08x", digest[0], digest[1], digest[2], digest[3], digest[4]);
-				}
-
+				bool mapValid = m_ReadChart(f.first, evt);
 				if (!mapValid)
 				{
 					if(!existing) // Never added
@@ -2244,6 +2386,107 @@ private:
 		m_outer.OnSearchStatusUpdated.Call("");
 
 		m_searching = false;
+		m_WatchCharts(watcher);
+	}
+
+	// Reads the metadata and hash of a chart file, returns false if it's not a valid chart
+	//	doesn't report a search status, the status is cleared when searching is done and changes found after are only logged
+	bool m_ReadChart(const String& path, Event& evt)
+	{
+		Logf("Discovered Chart [%s]", Logger::Severity::Info, path);
+		// Try to read map metadata
+		File fileStream;
+		Beatmap map;
+		if(!fileStream.OpenRead(path))
+			return false;
+		FileReader reader(fileStream);
+		if(!map.Load(reader, true))
+			return false;
+
+		fileStream.Seek(0);
+		evt.mapData = new BeatmapSettings(map.GetMapSettings());
+
+		ProfilerScope $("Chart Database - Hash Chart");
+		char data_buffer[0x80];
+		uint32_t digest[5];
+		sha1::SHA1 s;
+
+		size_t amount_read = 0;
+		size_t read_size;
+		do
+		{
+			read_size = fileStream.Read(data_buffer, sizeof(data_buffer));
+			amount_read += read_size;
+			s.processBytes(data_buffer, read_size);
+		}
+		while (read_size != 0);
+			
+		s.getDigest(digest);
+
+		evt.hash = Utility::Sprintf("%08x%08x%08x%08x%08x", digest[0], digest[1], digest[2], digest[3], digest[4]);
+		return true;
+	}
+
+	// Keeps the database up to date with changes to chart files after searching, until searching is stopped or restarted
+	void m_WatchCharts(FileWatcher& watcher)
+	{
+		while(!m_interruptSearch)
+		{
+			if (m_paused.load())
+			{
+				unique_lock<mutex> lock(m_pauseMutex);
+				m_cvPause.wait_for(lock, chrono::milliseconds(100));
+				continue;
+			}
+
+			// A burst of changes is reported at once, apply them together
+			watcher.pollInterval = m_watchPollInterval.load();
+			List<Event> changes;
+			for(FileChange& change : watcher.GetChanges(0.1f))
+			{
+				Event evt;
+				evt.type = Event::Chart;
+				evt.action = Event::Updated;
+				evt.path = change.path;
+				evt.lwt = change.lastWriteTime;
+				// Charts that were never added are skipped when this is applied
+				if(change.removed || !m_ReadChart(change.path, evt))
+					evt.action = Event::Removed;
+				changes.AddBack(evt);
+			}
+			AddChanges(changes);
+		}
+	}
+
+	// Finds the chart a change is about and whether it's added or updated, returns false if there's nothing to change
+	bool m_ResolveChart(Event& e)
+	{
+		if(e.action != Event::Added && m_charts.Contains(e.id))
+			return true;
+
+		ChartIndex* chart = nullptr;
+		FolderIndex** folder = m_foldersByPath.Find(Path::RemoveLast(e.path, nullptr));
+		if(folder)
+		{
+			for(ChartIndex* c : (*folder)->charts)
+			{
+				if(c->path == e.path)
+					chart = c;
+			}
+		}
+
+		if(!chart)
+		{
+			// Removed before it got added
+			if(e.action == Event::Removed)
+				return false;
+			e.action = Event::Added;
+			return true;
+		}
+		e.id = chart->id;
+		if(e.action == Event::Added)
+			e.action = Event::Updated;
+		return true;
 	}
 
 };
@@ -2252,6 +2495,7 @@ void MapDatabase::FinishInit()
 {
 	assert(!m_impl);
 	m_impl = new MapDatabase_Impl(*this, m_transferScores);
+	m_impl->SetWatchPollInterval(m_watchPollInterval);
 }
 MapDatabase::MapDatabase(bool postponeInit)
 {
@@ -2342,6 +2586,10 @@ void MapDatabase::AddOrRemoveToCollection(const String& name, int32 mapid)
 {
 	m_impl->AddOrRemoveToCollection(name, mapid);
 }
+uint32 MapDatabase::GetCollectionsVersion() const
+{
+	return m_impl->m_collectionsVersion;
+}
 void MapDatabase::AddSearchPath(const String& path)
 {
 	m_impl->AddSearchPath(path);
@@ -2350,9 +2598,13 @@ void MapDatabase::RemoveSearchPath(const String& path)
 {
 	m_impl->RemoveSearchPath(path);
 }
-void MapDatabase::LoadDatabaseWithoutSearching()
+void MapDatabase::LoadDatabaseWithoutSearching(bool waitForScores)
+{
+	m_impl->LoadDatabaseWithoutSearching(waitForScores);
+}
+bool MapDatabase::IsLoadingScores() const
 {
-	m_impl->LoadDatabaseWithoutSearching();
+	return m_impl->IsLoadingScores();
 }
 void MapDatabase::UpdateChartOffset(const ChartIndex* chart)
 {
@@ -2391,6 +2643,12 @@ void MapDatabase::SetChartUpdateBehavior(bool transferScores) {
 	if (m_impl != NULL)
 		m_impl->SetChartUpdateBehavior(transferScores);
 }
+void MapDatabase::SetWatchPollInterval(float seconds)
+{
+	m_watchPollInterval = seconds;
+	if (m_impl != NULL)
+		m_impl->SetWatchPollInterval(seconds);
+}
 ChartIndex* MapDatabase::FindFirstChartByPath(const String& s)
 {
 	return m_impl->FindFirstChartByPath(s);
@@ -0,0 +1,60 @@
+#pragma once
+#include "Graphics/Image.hpp"
+#include "Shared/Files.hpp"
+#include "Shared/List.hpp"
+#include <atomic>
+#include <mutex>
+
+struct lua_State;
+class WorkerPool;
+
+struct ImageAnimation
+{
+	int FrameCount;
+	std::atomic<int32_t> CurrentFrame;
+	int TimesToLoop;
+	int LoopCounter;
+	int w;
+	int h;
+	float SecondsPerFrame;
+	float Timer;
+	std::atomic<bool> Compressed;
+	std::atomic<bool> LoadComplete;
+	std::atomic<bool> Cancelled;
+	std::mutex LoadMutex;
+	Vector<Graphics::Image> Frames;
+	Vector<Buffer> FrameData; //for storing the file contents of the compressed frames
+	Graphics::Image CurrentImage; //the current uncompressed frame in use
+	// Upcoming frames of compressed animations that are already decoded, guarded by LoadMutex
+	List<std::pair<int, Graphics::Image>> DecodedFrames;
+	// Frame that is decoded next and whether a decode task is queued, guarded by LoadMutex
+	int NextDecodeFrame = 0;
+	bool Decoding = false;
+	// Number of tasks of this animation that are queued or running on the decode pool
+	std::atomic<int32_t> PendingTasks{ 0 };
+	lua_State* State;
+};
+
+/*
+	Loads animation frames on a small pool of threads that is shared by all animations
+
+	Compressed animations only keep the file contents in memory, their frames are decoded shortly before they are shown.
+	Each animation has at most one decode task queued at a time, which decodes one frame and queues itself again until
+	enough frames are buffered, so a skin with many animations doesn't starve the others.
+*/
+namespace AnimationLoader
+{
+	// Most decoded frames buffered per animation
+	const int maxBufferedFrames = 8;
+	// How far ahead frames are decoded in seconds, fast animations buffer more frames
+	const float prefetchTime = 0.1f;
+
+	WorkerPool& GetPool();
+
+	// Starts loading the frames of an animation, LoadComplete is set once they are loaded
+	void Load(Ref<ImageAnimation> ia, Vector<FileInfo> files);
+	// Returns the decoded frame of a compressed animation or null if it's not decoded yet, then decodes the next frames
+	Graphics::Image TakeFrame(const Ref<ImageAnimation>& ia, int frame);
+	// Stops loading, drops the queued tasks of the animation and waits for the ones that are already running
+	void Cancel(ImageAnimation& ia);
+}
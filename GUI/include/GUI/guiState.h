@@ -7,9 +7,7 @@
 #include "Graphics/RenderQueue.hpp"
 #include "Shared/Transform.hpp"
 #include "Shared/Files.hpp"
-#include "Shared/Thread.hpp"
-#include <atomic>
-#include <mutex>
+#include "GUI/AnimationLoader.hpp"
 
 struct Label
 {
@@ -22,28 +20,6 @@ struct Label
 };
 
 
-struct ImageAnimation
-{
-	int FrameCount;
-	std::atomic<int32_t> CurrentFrame;
-	int TimesToLoop;
-	int LoopCounter;
-	int w;
-	int h;
-	float SecondsPerFrame;
-	float Timer;
-	std::atomic<bool> Compressed;
-	std::atomic<bool> LoadComplete;
-	std::atomic<bool> Cancelled;
-	std::mutex LoadMutex;
-	Vector<Graphics::Image> Frames;
-	Vector<Buffer> FrameData; //for storing the file contents of the compressed frames
-	Image CurrentImage; //the current uncompressed frame in use
-	Image NextImage;
-	Thread* JobThread;
-	lua_State* State;
-};
-
 struct GUIState
 {
 	NVGcontext* vg;
@@ -134,67 +134,6 @@ static int lBeginPath(lua_State* L)
 }
 
 
-static void AnimationLoader(Vector<FileInfo> files, Ref<ImageAnimation> ia)
-{
-	ia->FrameCount = files.size();
-	files.Sort([](FileInfo& a, FileInfo& b) {
-		String af, bf;
-		Path::RemoveLast(a.fullPath, &af);
-		Path::RemoveLast(b.fullPath, &bf);
-		return af.compare(bf) < 0;
-	});
-	ia->Timer = 0;
-
-	if (ia->Compressed.load())
-	{
-		for (int i = 0; i < ia->FrameCount; i++)
-		{
-			if (ia->Cancelled.load())
-				break;
-			File newImage;
-			if (newImage.OpenRead(files[i].fullPath)) {
-				Buffer newData;
-				newData.resize(newImage.GetSize());
-				newImage.Read(newData.data(), newImage.GetSize());
-				ia->FrameData.push_back(std::move(newData));
-			}
-		}
-		ia->NextImage = ImageRes::Create(ia->FrameData[0]);
-	}
-	else {
-		for (int i = 0; i < ia->FrameCount; i++)
-		{
-			if (ia->Cancelled.load())
-				break;
-			ia->Frames.Add(Graphics::ImageRes::Create(files[i].fullPath));
-		}
-	}
-	ia->LoadComplete.store(true);
-
-
-	if (ia->Compressed.load())
-	{
-		std::chrono::microseconds sleepDuration((uint32)(250000.f * ia->SecondsPerFrame));
-		int currentFrame = -1;
-		while (!ia->Cancelled.load())
-		{
-			if (ia->CurrentFrame != currentFrame)
-			{
-				currentFrame = ia->CurrentFrame;
-				int nextFrame = (currentFrame + 1) % ia->FrameCount;
-				Image nextImage = ImageRes::Create(ia->FrameData[nextFrame]);
-				ia->LoadMutex.lock();
-				ia->NextImage = nextImage;
-				ia->LoadMutex.unlock();
-			}
-			else 
-			{
-				std::this_thread::sleep_for(sleepDuration);
-			}
-		}
-	}
-}
-
 static int lTickAnimation(lua_State* L)
 {
 	int key;
@@ -234,10 +173,13 @@ static int lTickAnimation(lua_State* L)
 			ia->CurrentFrame = (ia->CurrentFrame + 1) % ia->FrameCount;
 			if (ia->Compressed.load())
 			{
-				ia->LoadMutex.lock();
-				ia->CurrentImage = ia->NextImage;
-				ia->LoadMutex.unlock();
-				nvgUpdateImage(g_guiState.vg, key, (unsigned char*)ia->CurrentImage->GetBits());
+				// Keep showing the last frame if this one isn't decoded yet
+				Image frame = AnimationLoader::TakeFrame(ia, ia->CurrentFrame);
+				if (frame)
+				{
+					ia->CurrentImage = frame;
+					nvgUpdateImage(g_guiState.vg, key, (unsigned char*)ia->CurrentImage->GetBits());
+				}
 			}
 			else 
 			{
@@ -264,7 +206,7 @@ static int LoadAnimation(lua_State* L, const char* path, float frametime, int lo
 	ia->LoadComplete.store(false);
 	ia->Cancelled.store(false);
 	ia->State = L;
-	ia->JobThread = new Thread(AnimationLoader, files, ia);
+	AnimationLoader::Load(ia, files);
 	g_guiState.animations.insert(std::make_pair(key, ia));
 
 	return key;
@@ -1123,14 +1065,11 @@ static int DisposeGUI(lua_State* state)
 		if (anim.second->State != state)
 			continue;
 
-		anim.second->Cancelled.store(true);
-
-		if(anim.second->JobThread && anim.second->JobThread->joinable())
-			anim.second->JobThread->join();
+		AnimationLoader::Cancel(*anim.second);
 		anim.second->Frames.clear();
 		anim.second->FrameData.clear();
+		anim.second->DecodedFrames.clear();
 		keysToDelete.Add(anim.first);
-		delete anim.second->JobThread;
 		nvgDeleteImage(g_guiState.vg, anim.first);
 	}
 	for (int k : keysToDelete)
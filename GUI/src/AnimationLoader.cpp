@@ -0,0 +1,160 @@
+#include "stdafx.h"
+#include "AnimationLoader.hpp"
+#include <Shared/WorkerPool.hpp>
+
+namespace AnimationLoader
+{
+	WorkerPool& GetPool()
+	{
+		// Leave most cores to the game and the other job threads
+		static WorkerPool pool(Math::Clamp<size_t>(std::thread::hardware_concurrency() / 4, 1, 4));
+		return pool;
+	}
+
+	static int GetPrefetchCount(const ImageAnimation& ia)
+	{
+		if(ia.SecondsPerFrame <= 0.0f)
+			return maxBufferedFrames;
+		return Math::Clamp((int)ceilf(prefetchTime / ia.SecondsPerFrame), 1, maxBufferedFrames);
+	}
+
+	// Counts a task as pending for as long as it's queued or running, also when the pool drops it without running it
+	struct PendingTask
+	{
+		PendingTask(const Ref<ImageAnimation>& ia) : ia(ia) { ia->PendingTasks++; }
+		~PendingTask() { ia->PendingTasks--; }
+		Ref<ImageAnimation> ia;
+	};
+
+	template<typename Task>
+	static void QueueTask(const Ref<ImageAnimation>& ia, Task task)
+	{
+		Ref<PendingTask> pending = std::make_shared<PendingTask>(ia);
+		GetPool().Queue([pending, task]() { task(); }, ia.get());
+	}
+
+	static void DecodeNextFrame(Ref<ImageAnimation> ia);
+
+	// Queues a decode task if the animation needs more frames and doesn't have one queued, LoadMutex must be locked
+	static void QueueDecode(const Ref<ImageAnimation>& ia)
+	{
+		if(ia->Decoding || ia->Cancelled.load() || ia->FrameData.empty())
+			return;
+		if((int)ia->DecodedFrames.size() >= GetPrefetchCount(*ia))
+			return;
+
+		ia->Decoding = true;
+		QueueTask(ia, [ia]() { DecodeNextFrame(ia); });
+	}
+
+	static void DecodeNextFrame(Ref<ImageAnimation> ia)
+	{
+		ia->LoadMutex.lock();
+		const int frame = ia->NextDecodeFrame;
+		ia->LoadMutex.unlock();
+
+		// Frame data doesn't change after loading
+		Graphics::Image image;
+		if(!ia->Cancelled.load())
+			image = Graphics::ImageRes::Create(ia->FrameData[frame]);
+
+		ia->LoadMutex.lock();
+		// The wanted frame can change while decoding when the animation is reset
+		if(image && frame == ia->NextDecodeFrame)
+		{
+			ia->DecodedFrames.AddBack({ frame, image });
+			ia->NextDecodeFrame = (frame + 1) % ia->FrameCount;
+		}
+		ia->Decoding = false;
+		QueueDecode(ia);
+		ia->LoadMutex.unlock();
+	}
+
+	static void LoadFrames(Vector<FileInfo> files, Ref<ImageAnimation> ia)
+	{
+		ia->FrameCount = files.size();
+		files.Sort([](FileInfo& a, FileInfo& b) {
+			String af, bf;
+			Path::RemoveLast(a.fullPath, &af);
+			Path::RemoveLast(b.fullPath, &bf);
+			return af.compare(bf) < 0;
+		});
+		ia->Timer = 0;
+
+		if (ia->Compressed.load())
+		{
+			for (int i = 0; i < ia->FrameCount; i++)
+			{
+				if (ia->Cancelled.load())
+					break;
+				File newImage;
+				if (newImage.OpenRead(files[i].fullPath)) {
+					Buffer newData;
+					newData.resize(newImage.GetSize());
+					newImage.Read(newData.data(), newImage.GetSize());
+					ia->FrameData.push_back(std::move(newData));
+				}
+			}
+			// Frames that failed to load are skipped
+			ia->FrameCount = (int)ia->FrameData.size();
+		}
+		else {
+			for (int i = 0; i < ia->FrameCount; i++)
+			{
+				if (ia->Cancelled.load())
+					break;
+				ia->Frames.Add(Graphics::ImageRes::Create(files[i].fullPath));
+			}
+		}
+		ia->LoadComplete.store(true);
+
+		if (ia->Compressed.load())
+		{
+			// The first frame is shown when the animation is created
+			ia->LoadMutex.lock();
+			ia->NextDecodeFrame = ia->FrameCount > 1 ? 1 : 0;
+			QueueDecode(ia);
+			ia->LoadMutex.unlock();
+		}
+	}
+
+	void Load(Ref<ImageAnimation> ia, Vector<FileInfo> files)
+	{
+		QueueTask(ia, [ia, files]() { LoadFrames(files, ia); });
+	}
+
+	Graphics::Image TakeFrame(const Ref<ImageAnimation>& ia, int frame)
+	{
+		Graphics::Image image;
+		ia->LoadMutex.lock();
+		// Frames are decoded in order, so anything before the wanted frame was skipped
+		while(!ia->DecodedFrames.empty())
+		{
+			std::pair<int, Graphics::Image> decoded = ia->DecodedFrames.PopFront();
+			if(decoded.first == frame)
+			{
+				image = decoded.second;
+				break;
+			}
+		}
+		// Not decoded in time or the animation was reset, continue decoding from the wanted frame
+		if(!image)
+			ia->NextDecodeFrame = frame;
+		QueueDecode(ia);
+		ia->LoadMutex.unlock();
+		return image;
+	}
+
+	void Cancel(ImageAnimation& ia)
+	{
+		// Decode tasks are only queued with LoadMutex locked, so none are queued after the queued ones are dropped
+		ia.LoadMutex.lock();
+		ia.Cancelled.store(true);
+		GetPool().Cancel(&ia);
+		ia.LoadMutex.unlock();
+
+		// Only a task that was already running is left, it stops early once it sees the animation is cancelled
+		while(ia.PendingTasks.load() > 0)
+			std::this_thread::yield();
+	}
+}
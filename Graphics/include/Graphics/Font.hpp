@@ -1,5 +1,6 @@
 #pragma once
 #include <Graphics/ResourceTypes.hpp>
+#include <Graphics/VertexFormat.hpp>
 
 #ifdef None
 #undef None
@@ -7,6 +8,15 @@
 
 namespace Graphics
 {
+	// Vertex of a glyph quad, texture coordinates are in pixels on the font's glyph atlas
+	struct TextVertex : public VertexFormat<Vector2, Vector2>
+	{
+		TextVertex() = default;
+		TextVertex(Vector2 point, Vector2 uv) : pos(point), tex(uv) {}
+		Vector2 pos;
+		Vector2 tex;
+	};
+
 	/*
 		A prerendered text object, contains all the vertices and texture sheets to draw itself
 	*/
@@ -15,10 +25,13 @@ namespace Graphics
 		friend class Font_Impl;
 		struct FontSize* fontSize;
 		Ref<class MeshRes> mesh;
+		Vector<TextVertex> vertices;
 	public:
 		~TextRes();
 		Ref<class TextureRes> GetTexture();
 		Ref<class MeshRes> GetMesh() { return mesh; }
+		// Copy of the mesh data, used to batch texts into a single draw call
+		const Vector<TextVertex>& GetVertices() const { return vertices; }
 		void Draw();
 		//width, line height, base height
 		Vector3 size;
@@ -20,6 +20,8 @@ namespace Graphics
 		uint32 m_mainProgramPipeline;
 		class OpenGL_Impl* m_impl;
 		Window* m_window;
+		// Batched text of all render queues is streamed into this
+		Ref<class MeshRes> m_textBatchMesh;
 
 		friend class ShaderRes;
 		friend class TextureRes;
@@ -6,6 +6,42 @@
 
 namespace Graphics
 {
+	struct ParticleVertex : VertexFormat<Vector3, Vector4, Vector4>
+	{
+		ParticleVertex(Vector3 pos, Color color, Vector4 params) : pos(pos), color(color), params(params) {};
+		Vector3 pos;
+		Color color;
+		// X = scale
+		// Y = rotation
+		// Z = animation frame
+		Vector4 params;
+	};
+
+	/*
+		State of all particles in an emitter, stored as one array per attribute so the simulation loop can be vectorized
+		A slot is free when its life is 0 or less
+	*/
+	struct ParticlePool
+	{
+		Vector<float> life;
+		Vector<float> maxLife;
+		// Progress over the lifetime before the last simulation step, used to sample parameters over time
+		Vector<float> lifeRate;
+		Vector<float> rotation;
+		Vector<float> startSize;
+		Vector<float> drag;
+		Vector<float> posX, posY, posZ;
+		Vector<float> velX, velY, velZ;
+		Vector<Color> startColor;
+		// Time to simulate each particle for in the current step
+		Vector<float> step;
+		// Particles that were alive or spawned in the current step
+		Vector<uint8> visible;
+
+		void Resize(size_t size);
+		size_t GetSize() const { return life.size(); }
+	};
+
 	/*
 		Particle Emitter, which is a component of a particle system that handles the emission of particles together with the properties of the emitter particles
 	*/
@@ -53,11 +89,16 @@ namespace Graphics
 		// Stop spawning any particles
 		void Deactivate();
 
+		// Spawns new particles and advances the existing ones, called by the particle system every frame
+		void Simulate(float deltaTime);
+		// Adds the vertices of the particles that were simulated in the last step
+		void GetVertices(Vector<ParticleVertex>& out);
+
 	private:
 		// Constructed by particle system
 		ParticleEmitter(class ParticleSystem_Impl* sys);
-		void Render(const class RenderState& rs, float deltaTime);
 		void m_ReallocatePool(uint32 newCapacity);
+		void m_InitParticle(size_t index);
 
 		float m_spawnCounter = 0;
 		float m_emitterTime = 0;
@@ -65,12 +106,10 @@ namespace Graphics
 		bool m_deactivated = false;
 		bool m_finished = false;
 		uint32 m_emitterLoopIndex = 0;
-		Mesh m_mesh;
 		friend class ParticleSystem_Impl;
-		friend class Particle;
 		ParticleSystem_Impl* m_system;
 
-		class Particle* m_particles = nullptr;
+		ParticlePool m_particles;
 		uint32 m_poolSize = 0;
 
 		// Particle parameters private
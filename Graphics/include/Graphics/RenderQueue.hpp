@@ -33,6 +33,13 @@ namespace Graphics
 		Rect scissorRect;
 	};
 
+	// Draw command for a text, texts that are drawn after each other can be merged into one draw call
+	class TextDrawCall : public SimpleDrawCall
+	{
+	public:
+		Ref<class TextRes> text;
+	};
+
 	// Command for points/lines with size/width parameter
 	class PointDrawCall : public RenderQueueItem
 	{
@@ -70,9 +77,35 @@ namespace Graphics
 		// Draw for lines/points with point size parameter
 		void DrawPoints(Mesh m, Material mat, const MaterialParameterSet& params, float pointSize);
 
+		// Range of queued items [begin, end) that is drawn with a single draw call
+		struct Batch
+		{
+			size_t begin;
+			size_t end;
+		};
+		/*
+			Splits the items into the batches they are drawn with, in drawing order
+			Consecutive text draws using the same material, parameters (and so the same glyph atlas) and scissor rectangle
+			are merged into one batch if their transforms keep the text in the XY plane, any other item is a batch of its own
+		*/
+		static Vector<Batch> GetBatches(const Vector<RenderQueueItem*>& items);
+		// Appends the vertices of a text transformed into world space
+		static void AppendTextVertices(const Vector<TextVertex>& vertices, const Transform& worldTransform, Vector<TextVertex>& out);
+
 	private:
+		// Range of the text mesh that a merged text batch is drawn from
+		struct TextBatch
+		{
+			size_t firstVertex;
+			size_t vertexCount;
+		};
+		// Uploads the vertices of every merged text batch into the context's text mesh in one go
+		//	textBatches gets an entry for each batch, batches of a single item have no vertices
+		Mesh m_UploadTextBatches(const Vector<Batch>& batches, Vector<TextBatch>& textBatches);
+
 		RenderState m_renderState;
 		Vector<RenderQueueItem*> m_orderedCommands;
 		class OpenGL* m_ogl = nullptr;
+		Vector<TextVertex> m_textVertices;
 	};
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "OpenGL.hpp"
 #include <Shared/Timer.hpp>
 #include <Shared/Profiling.hpp>
+#include <Shared/ExpiringCache.hpp>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -16,44 +17,22 @@ namespace Graphics
 	using Shared::Margin;
 	using Shared::Recti;
 
-	struct CachedText
-	{
-		Text text;
-		float lastUsage;
-	};
-	// Prevents continuous recreation of text that doesn't change
-	class TextCache : public Map<WString, CachedText>
+	// Prevents continuous recreation of text that doesn't change, text that isn't used for a second is released
+	class TextCache
 	{
 		Timer timer;
+		ExpiringCache<WString, Text, std::hash<std::wstring>> m_cache{ 1.0f };
 	public:
-		void Update()
-		{
-			float currentTime = timer.SecondsAsFloat();
-			for(auto it = begin(); it != end();)
-			{
-				float durationSinceUsed = currentTime - it->second.lastUsage;
-				if(durationSinceUsed > 1.0f)
-				{
-					it = erase(it);
-					continue;
-				}
-				it++;
-			}
-		}
 		Text GetText(const WString& key)
 		{
-			auto it = find(key);
-			if(it != end())
-			{
-				it->second.lastUsage = timer.SecondsAsFloat();
-				return it->second.text;
-			}
-			return Text();
+			Text* text = m_cache.Get(key, timer.SecondsAsFloat());
+			return text ? *text : Text();
 		}
 		void AddText(const WString& key, Text obj)
 		{
-			Update();
-			Add(key, { obj, timer.SecondsAsFloat() });
+			const float now = timer.SecondsAsFloat();
+			m_cache.Expire(now);
+			m_cache.Add(key, obj, now);
 		}
 	};
 
@@ -254,13 +233,6 @@ namespace Graphics
 			if(cachedText)
 				return cachedText;
 
-			struct TextVertex : public VertexFormat<Vector2, Vector2>
-			{
-				TextVertex(Vector2 point, Vector2 uv) : pos(point), tex(uv) {}
-				Vector2 pos;
-				Vector2 tex;
-			};
-
 			TextRes* ret = new TextRes();
 			ret->mesh = MeshRes::Create(m_gl);
 
@@ -335,6 +307,7 @@ namespace Graphics
 			ret->fontSize = size;
 			ret->mesh->SetData(vertices);
 			ret->mesh->SetPrimitiveType(PrimitiveType::TriangleList);
+			ret->vertices = std::move(vertices);
 
 			Text textObj = Utility::MakeRef(ret);
 			// Insert into cache
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "Mesh.hpp"
 #include <Graphics/ResourceManagers.hpp>
+#include <Shared/Profiling.hpp>
 
 namespace Graphics
 {
@@ -80,6 +81,7 @@ namespace Graphics
 				index++;
 			}
 			glBufferData(GL_ARRAY_BUFFER, totalVertexSize * vertexCount, pData, m_bDynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+			Profiler::AddCounter(ProfilerCounter::BufferAllocations);
 
 			glBindVertexArray(0);
 			glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -91,12 +93,22 @@ namespace Graphics
 		{
 			glBindVertexArray(m_vao);
 			glDrawArrays(m_glType, 0, (int)m_vertexCount);
+			Profiler::AddCounter(ProfilerCounter::DrawCalls);
 			glBindVertexArray(0);
 		}
 		void Redraw() override
 		{
 			glBindVertexArray(m_vao);
 			glDrawArrays(m_glType, 0, (int)m_vertexCount);
+			Profiler::AddCounter(ProfilerCounter::DrawCalls);
+			glBindVertexArray(0);
+		}
+		void DrawRange(size_t firstVertex, size_t vertexCount) override
+		{
+			assert(firstVertex + vertexCount <= m_vertexCount);
+			glBindVertexArray(m_vao);
+			glDrawArrays(m_glType, (int)firstVertex, (int)vertexCount);
+			Profiler::AddCounter(ProfilerCounter::DrawCalls);
 			glBindVertexArray(0);
 		}
 		#else
@@ -104,10 +116,19 @@ namespace Graphics
 		{
 			glBindVertexArray(m_vao);
 			glDrawArrays(m_glType, 0, (int)m_vertexCount);
+			Profiler::AddCounter(ProfilerCounter::DrawCalls);
 		}
 		void Redraw() override
 		{
 			glDrawArrays(m_glType, 0, (int)m_vertexCount);
+			Profiler::AddCounter(ProfilerCounter::DrawCalls);
+		}
+		void DrawRange(size_t firstVertex, size_t vertexCount) override
+		{
+			assert(firstVertex + vertexCount <= m_vertexCount);
+			glBindVertexArray(m_vao);
+			glDrawArrays(m_glType, (int)firstVertex, (int)vertexCount);
+			Profiler::AddCounter(ProfilerCounter::DrawCalls);
 		}
 		#endif
 
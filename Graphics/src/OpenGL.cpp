@@ -31,6 +31,8 @@ namespace Graphics
 	{
 		if(m_impl->context)
 		{
+			m_textBatchMesh.reset();
+
 			// Cleanup resource managers
 			ResourceManagers::DestroyResourceManager<ResourceType::Mesh>();
 			ResourceManagers::DestroyResourceManager<ResourceType::Texture>();
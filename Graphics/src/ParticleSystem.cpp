@@ -7,37 +7,43 @@
 
 namespace Graphics
 {
-	struct ParticleVertex : VertexFormat<Vector3, Vector4, Vector4>
-	{
-		ParticleVertex(Vector3 pos, Color color, Vector4 params) : pos(pos), color(color), params(params) {};
-		Vector3 pos;
-		Color color;
-		// X = scale
-		// Y = rotation
-		// Z = animation frame
-		Vector4 params;
-	};
-
 	class ParticleSystem_Impl : public ParticleSystemRes
 	{
 		friend class ParticleEmitter;
 		Vector<Ref<ParticleEmitter>> m_emitters;
 
+		// Consecutive emitters that are drawn with the same material and texture
+		struct Batch
+		{
+			Material material;
+			Texture texture;
+			size_t firstVertex;
+			size_t vertexCount;
+		};
+		static const size_t numStreams = 3;
+		Mesh m_streams[numStreams];
+		size_t m_streamIndex = 0;
+		Vector<ParticleVertex> m_vertices;
+		Vector<Batch> m_batches;
+		Vector<Ref<ParticleEmitter>> m_drawnEmitters;
+
 	public:
 		OpenGL* gl;
 
 	public:
 		virtual void Render(const class RenderState& rs, float deltaTime) override
 		{
-			// Enable blending for all particles
-			glEnable(GL_BLEND);
-
 			// Tick all emitters and remove old ones
 			for(auto it = m_emitters.begin(); it != m_emitters.end();)
 			{
-				(*it)->Render(rs, deltaTime);
+				const bool referenced = it->use_count() > 1;
+				if(!(*it)->HasFinished())
+				{
+					(*it)->Simulate(deltaTime);
+					m_drawnEmitters.Add(*it);
+				}
 
-				if(it->use_count() == 1)
+				if(!referenced)
 				{
 					if((*it)->HasFinished())
 					{
@@ -54,6 +60,76 @@ namespace Graphics
 
 				it++;
 			}
+
+			// Group emitters that can be drawn together, emitters with the same state keep their order
+			std::stable_sort(m_drawnEmitters.begin(), m_drawnEmitters.end(), [](const Ref<ParticleEmitter>& l, const Ref<ParticleEmitter>& r)
+			{
+				if(l->material->blendMode != r->material->blendMode)
+					return l->material->blendMode < r->material->blendMode;
+				if(l->material != r->material)
+					return l->material < r->material;
+				return l->texture < r->texture;
+			});
+
+			// Write the vertices of all emitters into one buffer, each batch is a range of it
+			m_vertices.clear();
+			m_batches.clear();
+			for(auto& emitter : m_drawnEmitters)
+			{
+				const size_t first = m_vertices.size();
+				emitter->GetVertices(m_vertices);
+				const size_t count = m_vertices.size() - first;
+				if(count == 0)
+					continue;
+
+				if(!m_batches.empty() && m_batches.back().material == emitter->material && m_batches.back().texture == emitter->texture)
+					m_batches.back().vertexCount += count;
+				else
+					m_batches.Add({ emitter->material, emitter->texture, first, count });
+			}
+			m_drawnEmitters.clear();
+
+			if(m_vertices.empty())
+				return;
+
+			// Cycle through a few buffers, so the one that's updated isn't still being drawn from
+			Mesh& mesh = m_streams[m_streamIndex];
+			m_streamIndex = (m_streamIndex + 1) % numStreams;
+			if(!mesh)
+			{
+				mesh = MeshRes::Create(gl);
+				mesh->SetPrimitiveType(PrimitiveType::PointList);
+			}
+			mesh->SetData(m_vertices);
+
+			// Enable blending for all particles
+			glEnable(GL_BLEND);
+
+			for(auto& batch : m_batches)
+			{
+				MaterialParameterSet params;
+				if(batch.texture)
+				{
+					params.SetParameter("mainTex", batch.texture);
+				}
+				batch.material->Bind(rs, params);
+
+				// Select blending mode based on material
+				switch(batch.material->blendMode)
+				{
+				case MaterialBlendMode::Normal:
+					glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+					break;
+				case MaterialBlendMode::Additive:
+					glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+					break;
+				case MaterialBlendMode::Multiply:
+					glBlendFunc(GL_SRC_ALPHA, GL_SRC_COLOR);
+					break;
+				}
+
+				mesh->DrawRange(batch.firstVertex, batch.vertexCount);
+			}
 		}
 		Ref<ParticleEmitter> AddEmitter() override
 		{
@@ -68,6 +144,7 @@ namespace Graphics
 				em.reset();
 			}
 			m_emitters.clear();
+			m_drawnEmitters.clear();
 		}
 	};
 
@@ -79,68 +156,64 @@ namespace Graphics
 	}
 
 
-	// Particle instance class
-	class Particle
+	void ParticlePool::Resize(size_t size)
 	{
-	public:
-		float life = 0.0f;
-		float maxLife = 0.0f;
-		float rotation = 0.0f;
-		float startSize = 0.0f;
-		Color startColor;
-		Vector3 pos;
-		Vector3 velocity;
-		float scale;
-		float fade;
-		float drag;
-		
-
-		bool IsAlive() const
-		{
-			return life > 0.0f;
-		}
-		inline void Init(ParticleEmitter* emitter)
-		{
-			const float& et = emitter->m_emitterRate;
-			life = maxLife = emitter->m_param_Lifetime->Init(et);
-			pos = emitter->m_param_StartPosition->Init(et) * emitter->scale;
-
-			// Velocity of startvelocity and spawn offset scale
-			velocity = emitter->m_param_StartVelocity->Init(et) * emitter->scale;
-			float spawnVelScale = emitter->m_param_SpawnVelocityScale->Init(et);
-			if(spawnVelScale > 0)
-				velocity += pos.Normalized() * spawnVelScale  * emitter->scale;
-
-			// Add emitter offset to location
-			pos += emitter->position;
-
-			startColor = emitter->m_param_StartColor->Init(et);
-			rotation = emitter->m_param_StartRotation->Init(et);
-			startSize = emitter->m_param_StartSize->Init(et) * emitter->scale;
-			drag = emitter->m_param_StartDrag->Init(et);
-		}
-		inline void Simulate(ParticleEmitter* emitter, float deltaTime)
+		life.resize(size, 0.0f);
+		// Keeps the life rate of unused slots finite
+		maxLife.resize(size, 1.0f);
+		lifeRate.resize(size, 0.0f);
+		rotation.resize(size, 0.0f);
+		startSize.resize(size, 0.0f);
+		drag.resize(size, 0.0f);
+		posX.resize(size, 0.0f);
+		posY.resize(size, 0.0f);
+		posZ.resize(size, 0.0f);
+		velX.resize(size, 0.0f);
+		velY.resize(size, 0.0f);
+		velZ.resize(size, 0.0f);
+		startColor.resize(size);
+		step.resize(size, 0.0f);
+		visible.resize(size, 0);
+	}
+
+	// Applies gravity, velocity and drag to all particles for their time step
+	// Free slots have a step of 0 and are left unchanged, so this runs over all slots without branching and can be vectorized
+	static void IntegrateParticles(float* __restrict life, const float* __restrict maxLife, float* __restrict lifeRate,
+		const float* __restrict drag, const float* __restrict step,
+		float* __restrict posX, float* __restrict posY, float* __restrict posZ,
+		float* __restrict velX, float* __restrict velY, float* __restrict velZ,
+		size_t count, float gravityX, float gravityY, float gravityZ, float gravityScale)
+	{
+		for(size_t i = 0; i < count; i++)
 		{
-			float c = 1 - life / maxLife;
+			const float dt = step[i];
+			lifeRate[i] = 1 - life[i] / maxLife[i];
 
 			// Add gravity
-			velocity += emitter->m_param_Gravity->Sample(emitter->m_emitterTime) * deltaTime * emitter->scale;
-			pos += velocity * deltaTime;
+			velX[i] += gravityX * dt * gravityScale;
+			velY[i] += gravityY * dt * gravityScale;
+			velZ[i] += gravityZ * dt * gravityScale;
+			posX[i] += velX[i] * dt;
+			posY[i] += velY[i] * dt;
+			posZ[i] += velZ[i] * dt;
 
 			// Add drag
-			velocity += -velocity * deltaTime * drag;
+			velX[i] += -velX[i] * dt * drag[i];
+			velY[i] += -velY[i] * dt * drag[i];
+			velZ[i] += -velZ[i] * dt * drag[i];
 
-			fade = emitter->m_param_FadeOverTime->Sample(c);
-			scale = emitter->m_param_ScaleOverTime->Sample(c);
-			life -= deltaTime;
+			life[i] -= dt;
 		}
-	};
+	}
+	static void IntegrateParticles(ParticlePool& p, size_t count, const Vector3& gravity, float gravityScale)
+	{
+		IntegrateParticles(p.life.data(), p.maxLife.data(), p.lifeRate.data(), p.drag.data(), p.step.data(),
+			p.posX.data(), p.posY.data(), p.posZ.data(), p.velX.data(), p.velY.data(), p.velZ.data(),
+			count, gravity.x, gravity.y, gravity.z, gravityScale);
+	}
 
 	ParticleEmitter::ParticleEmitter(ParticleSystem_Impl* sys) : m_system(sys)
 	{
-		m_mesh = MeshRes::Create(m_system->gl);
-		m_mesh->SetPrimitiveType(PrimitiveType::PointList);
-
 		// Set parameter defaults
 #define PARTICLE_DEFAULT(__name, __value)\
 	Set##__name(__value);
@@ -153,43 +226,41 @@ namespace Graphics
 	if(m_param_##__name){\
 		delete m_param_##__name; m_param_##__name = nullptr; }
 #include "ParticleParameters.hpp"
-
-		if(m_particles)
-		{
-			delete[] m_particles;
-		}
 	}
 
 	void ParticleEmitter::m_ReallocatePool(uint32 newCapacity)
 	{
-		Particle* oldParticles = m_particles;
-		uint32 oldSize = m_poolSize;
-
-		// Create new pool
 		m_poolSize = newCapacity;
-		if(newCapacity > 0)
-		{
-			m_particles = new Particle[m_poolSize];
-			for (size_t i = 0; i < m_poolSize; i++)
-			{
-				m_particles[i] = Particle();
-			}
-			
-		}
-		else
-		{
-			m_particles = nullptr;
-		}
-
-		if(oldParticles && m_particles)
-		{
-			memcpy(m_particles, oldParticles, Math::Min(oldSize, m_poolSize) * sizeof(Particle));
-		}
-
-		if(oldParticles)
-			delete[] oldParticles;
+		m_particles.Resize(newCapacity);
 	}
-	void ParticleEmitter::Render(const class RenderState& rs, float deltaTime)
+	void ParticleEmitter::m_InitParticle(size_t i)
+	{
+		ParticlePool& p = m_particles;
+		const float& et = m_emitterRate;
+		p.life[i] = p.maxLife[i] = m_param_Lifetime->Init(et);
+		Vector3 pos = m_param_StartPosition->Init(et) * scale;
+
+		// Velocity of startvelocity and spawn offset scale
+		Vector3 velocity = m_param_StartVelocity->Init(et) * scale;
+		float spawnVelScale = m_param_SpawnVelocityScale->Init(et);
+		if(spawnVelScale > 0)
+			velocity += pos.Normalized() * spawnVelScale * scale;
+
+		// Add emitter offset to location
+		pos += position;
+
+		p.posX[i] = pos.x;
+		p.posY[i] = pos.y;
+		p.posZ[i] = pos.z;
+		p.velX[i] = velocity.x;
+		p.velY[i] = velocity.y;
+		p.velZ[i] = velocity.z;
+		p.startColor[i] = m_param_StartColor->Init(et);
+		p.rotation[i] = m_param_StartRotation->Init(et);
+		p.startSize[i] = m_param_StartSize->Init(et) * scale;
+		p.drag[i] = m_param_StartDrag->Init(et);
+	}
+	void ParticleEmitter::Simulate(float deltaTime)
 	{
 		if(m_finished)
 			return;
@@ -203,9 +274,6 @@ namespace Graphics
 		if(maxParticles > m_poolSize)
 			m_ReallocatePool(maxParticles);
 
-		// Resulting vertex bufffer
-		Vector<ParticleVertex> verts;
-
 		// Increment emitter time
 		m_emitterTime += deltaTime;
 		while(m_emitterTime > duration)
@@ -233,73 +301,63 @@ namespace Graphics
 			spawnTimeOffsetStep = deltaTime / spawnsf;
 		}
 
+		ParticlePool& p = m_particles;
+
+		// Spawn new particles in free slots and decide how long each particle is simulated for
 		bool updatedSomething = false;
 		for(uint32 i = 0; i < m_poolSize; i++)
 		{
-			Particle& p = m_particles[i];
-
-			bool render = false;
-			if(!m_particles[i].IsAlive())
+			if(p.life[i] > 0.0f)
 			{
-				// Try to spawn a new particle in this slot
-				if(numSpawns > 0)
-				{
-					p.Init(this);
-					p.Simulate(this, spawnTimeOffset);
-					spawnTimeOffset += spawnTimeOffsetStep;
-					numSpawns--;
-					render = true;
-				}
+				p.step[i] = deltaTime;
+				p.visible[i] = 1;
+				updatedSomething = true;
 			}
-			else
+			else if(numSpawns > 0)
 			{
-				p.Simulate(this, deltaTime);
-				render = true;
-				updatedSomething = true;
+				// Newly spawned particles are spread out over the time step
+				m_InitParticle(i);
+				p.step[i] = spawnTimeOffset;
+				p.visible[i] = 1;
+				spawnTimeOffset += spawnTimeOffsetStep;
+				numSpawns--;
 			}
-
-			if(render)
+			else
 			{
-				verts.Add({ p.pos, p.startColor.WithAlpha(p.fade), Vector4(p.startSize * p.scale, p.rotation, 0, 0) });
+				p.step[i] = 0.0f;
+				p.visible[i] = 0;
 			}
 		}
 
+		// Gravity only depends on the emitter time
+		const Vector3 gravity = m_param_Gravity->Sample(m_emitterTime);
+
+		IntegrateParticles(p, m_poolSize, gravity, scale);
+
 		if(m_deactivated)
 		{
 			m_finished = !updatedSomething;
 		}
-
-		MaterialParameterSet params;
-		if(texture)
+	}
+	void ParticleEmitter::GetVertices(Vector<ParticleVertex>& out)
+	{
+		const ParticlePool& p = m_particles;
+		for(uint32 i = 0; i < m_poolSize; i++)
 		{
-			params.SetParameter("mainTex", texture);
-		}
-		material->Bind(rs, params);
+			if(!p.visible[i])
+				continue;
 
-		// Select blending mode based on material
-		switch(material->blendMode)
-		{
-		case MaterialBlendMode::Normal:
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-			break;
-		case MaterialBlendMode::Additive:
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-			break;
-		case MaterialBlendMode::Multiply:
-			glBlendFunc(GL_SRC_ALPHA, GL_SRC_COLOR);
-			break;
+			const float fade = m_param_FadeOverTime->Sample(p.lifeRate[i]);
+			const float particleScale = m_param_ScaleOverTime->Sample(p.lifeRate[i]);
+			out.Add({ Vector3(p.posX[i], p.posY[i], p.posZ[i]), p.startColor[i].WithAlpha(fade),
+				Vector4(p.startSize[i] * particleScale, p.rotation[i], 0, 0) });
 		}
-
-		m_mesh->SetData(verts);	
-		m_mesh->Draw();
 	}
-
 	void ParticleEmitter::Reset()
 	{
 		m_deactivated = false;
 		m_finished = false;
-		delete[] m_particles;
-		m_particles = nullptr;
+		m_particles = ParticlePool();
 		m_emitterLoopIndex = 0;
 		m_emitterTime = 0;
 		m_spawnCounter = 0;
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "RenderQueue.hpp"
 #include "OpenGL.hpp"
+#include <Shared/Profiling.hpp>
 using Utility::Cast;
 
 namespace Graphics
@@ -16,6 +17,7 @@ namespace Graphics
 		other.m_ogl = nullptr;
 		m_orderedCommands = move(other.m_orderedCommands);
 		m_renderState = other.m_renderState;
+		m_textVertices = move(other.m_textVertices);
 	}
 	RenderQueue& RenderQueue::operator=(RenderQueue&& other)
 	{
@@ -24,6 +26,7 @@ namespace Graphics
 		other.m_ogl = nullptr;
 		m_orderedCommands = move(other.m_orderedCommands);
 		m_renderState = other.m_renderState;
+		m_textVertices = move(other.m_textVertices);
 		return *this;
 	}
 	RenderQueue::~RenderQueue()
@@ -32,6 +35,7 @@ namespace Graphics
 	}
 	void RenderQueue::Process(bool clearQueue)
 	{
+		ProfilerZone $("RenderQueue::Process");
 		assert(m_ogl);
 
 		bool scissorEnabled = false;
@@ -42,9 +46,14 @@ namespace Graphics
 		Mesh currentMesh;
 		Material currentMaterial;
 
+		const Vector<Batch> batches = GetBatches(m_orderedCommands);
+		Vector<TextBatch> textBatches;
+		Mesh textMesh = m_UploadTextBatches(batches, textBatches);
+
 		// Create a new list of items
-		for(RenderQueueItem* item : m_orderedCommands)
+		for(size_t b = 0; b < batches.size(); b++)
 		{
+			RenderQueueItem* item = m_orderedCommands[batches[b].begin];
 			auto SetupMaterial = [&](Material& mat, MaterialParameterSet& params)
 			{
 				// Only bind params if material is already bound to context
@@ -124,7 +133,11 @@ namespace Graphics
 			if(Cast<SimpleDrawCall>(item))
 			{
 				SimpleDrawCall* sdc = (SimpleDrawCall*)item;
-				m_renderState.worldTransform = sdc->worldTransform;
+				const bool merged = batches[b].end - batches[b].begin > 1;
+				// Vertices of merged texts are already in world space
+				m_renderState.worldTransform = merged ? Transform() : sdc->worldTransform;
+				if(Cast<TextDrawCall>(item))
+					Profiler::AddCounter(ProfilerCounter::TextDrawCalls);
 				SetupMaterial(sdc->mat, sdc->params);
 
 				// Check if scissor is enabled
@@ -150,7 +163,15 @@ namespace Graphics
 					}
 				}
 
-				DrawOrRedrawMesh(sdc->mesh);
+				if(merged)
+				{
+					textMesh->DrawRange(textBatches[b].firstVertex, textBatches[b].vertexCount);
+					currentMesh = textMesh;
+				}
+				else
+				{
+					DrawOrRedrawMesh(sdc->mesh);
+				}
 				#ifdef EMBEDDED
 				glUseProgram(0);
 				#endif
@@ -218,7 +239,8 @@ namespace Graphics
 	}
 	void RenderQueue::Draw(Transform worldTransform, Ref<class TextRes> text, Material mat, const MaterialParameterSet& params)
 	{
-		SimpleDrawCall* sdc = new SimpleDrawCall();
+		TextDrawCall* sdc = new TextDrawCall();
+		sdc->text = text;
 		sdc->mat = mat;
 		sdc->mesh = text->GetMesh();
 		sdc->params = params;
@@ -240,7 +262,8 @@ namespace Graphics
 	}
 	void RenderQueue::DrawScissored(Rect scissor, Transform worldTransform, Ref<class TextRes> text, Material mat, const MaterialParameterSet& params /*= MaterialParameterSet()*/)
 	{
-		SimpleDrawCall* sdc = new SimpleDrawCall();
+		TextDrawCall* sdc = new TextDrawCall();
+		sdc->text = text;
 		sdc->mat = mat;
 		sdc->mesh = text->GetMesh();
 		sdc->params = params;
@@ -262,6 +285,94 @@ namespace Graphics
 		m_orderedCommands.push_back(pdc);
 	}
 
+	// Checks if the transform keeps vertices on the XY plane without a projection, so the text shader gives the same
+	// result for vertices that are transformed on the CPU
+	static bool IsPlanarTransform(const Transform& t)
+	{
+		return t[2] == 0.0f && t[6] == 0.0f && t[14] == 0.0f &&
+			t[3] == 0.0f && t[7] == 0.0f && t[15] == 1.0f;
+	}
+	static bool CanBatchText(const TextDrawCall& a, const TextDrawCall& b)
+	{
+		return a.mat == b.mat &&
+			a.scissorRect.pos.x == b.scissorRect.pos.x && a.scissorRect.pos.y == b.scissorRect.pos.y &&
+			a.scissorRect.size.x == b.scissorRect.size.x && a.scissorRect.size.y == b.scissorRect.size.y &&
+			a.params == b.params &&
+			IsPlanarTransform(b.worldTransform);
+	}
+
+	// Returns the end of the batch of items that starts at begin
+	static size_t GetBatchEnd(const Vector<RenderQueueItem*>& items, size_t begin)
+	{
+		const TextDrawCall* first = Cast<TextDrawCall>(items[begin]);
+		if(!first || !IsPlanarTransform(first->worldTransform))
+			return begin + 1;
+
+		size_t end = begin + 1;
+		for(; end < items.size(); end++)
+		{
+			const TextDrawCall* next = Cast<TextDrawCall>(items[end]);
+			if(!next || !CanBatchText(*first, *next))
+				break;
+		}
+		return end;
+	}
+
+	Vector<RenderQueue::Batch> RenderQueue::GetBatches(const Vector<RenderQueueItem*>& items)
+	{
+		Vector<Batch> batches;
+		for(size_t begin = 0; begin < items.size();)
+		{
+			const size_t end = GetBatchEnd(items, begin);
+			batches.Add({ begin, end });
+			begin = end;
+		}
+		return batches;
+	}
+
+	void RenderQueue::AppendTextVertices(const Vector<TextVertex>& vertices, const Transform& worldTransform, Vector<TextVertex>& out)
+	{
+		const Transform& t = worldTransform;
+		for(const TextVertex& v : vertices)
+		{
+			out.emplace_back(Vector2(t[0] * v.pos.x + t[4] * v.pos.y + t[12], t[1] * v.pos.x + t[5] * v.pos.y + t[13]), v.tex);
+		}
+	}
+
+	Mesh RenderQueue::m_UploadTextBatches(const Vector<Batch>& batches, Vector<TextBatch>& textBatches)
+	{
+		m_textVertices.clear();
+		textBatches.reserve(batches.size());
+		bool anyMerged = false;
+		for(const Batch& batch : batches)
+		{
+			TextBatch textBatch = { m_textVertices.size(), 0 };
+			if(batch.end - batch.begin > 1)
+			{
+				anyMerged = true;
+				for(size_t i = batch.begin; i < batch.end; i++)
+				{
+					TextDrawCall* tdc = (TextDrawCall*)m_orderedCommands[i];
+					AppendTextVertices(tdc->text->GetVertices(), tdc->worldTransform, m_textVertices);
+				}
+				textBatch.vertexCount = m_textVertices.size() - textBatch.firstVertex;
+			}
+			textBatches.Add(textBatch);
+		}
+		if(!anyMerged)
+			return Mesh();
+
+		// Kept by the context, render queues only live for a frame
+		Mesh& mesh = m_ogl->m_textBatchMesh;
+		if(!mesh)
+		{
+			mesh = MeshRes::Create(m_ogl);
+			mesh->SetPrimitiveType(PrimitiveType::TriangleList);
+		}
+		mesh->SetData(m_textVertices);
+		return mesh;
+	}
+
 	// Initializes the simple draw call structure
 	SimpleDrawCall::SimpleDrawCall()
 		: scissorRect(Vector2(), Vector2(-1))
@@ -3,6 +3,7 @@
 #include "Texture.hpp"
 #include "Image.hpp"
 #include <Graphics/ResourceManagers.hpp>
+#include <Shared/Profiling.hpp>
 
 
 
@@ -90,6 +91,7 @@ namespace Graphics
 			m_data = pData;
 			glBindTexture(GL_TEXTURE_2D, m_texture);
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_data);
+			Profiler::AddCounter(ProfilerCounter::TextureUploads);
 			glBindTexture(GL_TEXTURE_2D, 0);
 
 			UpdateFilterState();
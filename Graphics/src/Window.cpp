@@ -3,6 +3,8 @@
 #include "Image.hpp"
 #include "Gamepad_Impl.hpp"
 #include <Shared/Profiling.hpp>
+#include <Shared/InputClock.hpp>
+#include <Shared/SPSCQueue.hpp>
 
 static void GetDisplayBounds(Vector<Shared::Recti>& bounds)
 {
@@ -100,10 +102,14 @@ namespace Graphics
 					SDL_JoystickClose(joystick);
 				}
 			}
+
+			SDL_AddEventWatch(&Window_Impl::InputEventWatch, this);
 		}
 
 		~Window_Impl()
 		{
+			SDL_DelEventWatch(&Window_Impl::InputEventWatch, this);
+
 			// Release gamepads
 			for (auto it : m_gamepads)
 			{
@@ -195,6 +201,59 @@ namespace Graphics
 		}
 
 		/* input handling */
+		static bool GetTimedInputCode(const SDL_Event &evt, uint32 &code)
+		{
+			switch (evt.type)
+			{
+			case SDL_KEYDOWN:
+			case SDL_KEYUP:
+				code = evt.key.keysym.scancode;
+				return true;
+			case SDL_JOYBUTTONDOWN:
+			case SDL_JOYBUTTONUP:
+				code = ((uint32)evt.jbutton.which << 8) | evt.jbutton.button;
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		// Called by SDL on the thread that pumps events, right when they are queued
+		// SDL only timestamps events in whole milliseconds so button events are stamped again with the input clock here
+		//	stamps that don't fit in the queue are dropped, their events fall back to the SDL timestamp
+		static int InputEventWatch(void *userData, SDL_Event *evt)
+		{
+			uint32 code;
+			if (!GetTimedInputCode(*evt, code))
+				return 0;
+
+			Window_Impl *impl = static_cast<Window_Impl *>(userData);
+			InputStamp stamp = { evt->type, evt->common.timestamp, code, InputClock::Now() };
+			impl->m_inputStamps.TryPush(stamp);
+			return 0;
+		}
+
+		// Time since the event happened in ms, rounded from the high resolution stamp when available
+		int32 GetInputDelta(const SDL_Event &evt, int64 now, Uint32 tick)
+		{
+			uint32 code;
+			if (GetTimedInputCode(evt, code))
+			{
+				InputStamp stamp;
+				while (m_inputStamps.TryPeek(stamp))
+				{
+					// Newer than this event, leave it for the next one
+					if ((int32)(stamp.sdlTimestamp - evt.common.timestamp) > 0)
+						break;
+					// Stamps of events that never made it to the queue are discarded along the way
+					m_inputStamps.TryPop(stamp);
+					if (stamp.type == evt.type && stamp.code == code && stamp.sdlTimestamp == evt.common.timestamp)
+						return InputClock::ToMilliseconds(now - stamp.time);
+				}
+			}
+			return tick - evt.common.timestamp;
+		}
+
 		void HandleKeyEvent(const SDL_Keysym &keySym, uint8 newState, int32 repeat, int32 delta)
 		{
 			const SDL_Scancode code = keySym.scancode;
@@ -278,6 +337,7 @@ namespace Graphics
 
 			SDL_PumpEvents();
 			Uint32 tick = SDL_GetTicks();
+			int64 now = InputClock::Now();
 			do
 			{
 				eventCount = SDL_PeepEvents(&events[0], SIZE_EVENTS, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
@@ -285,7 +345,7 @@ namespace Graphics
 				for (int i = 0; i < eventCount; ++i)
 				{
 					auto evt = events[i];
-					int32 delta = tick - evt.common.timestamp;
+					int32 delta = GetInputDelta(evt, now, tick);
 					if (evt.type == SDL_EventType::SDL_KEYDOWN)
 					{
 						HandleKeyEvent(evt.key.keysym, 1, evt.key.repeat, delta);
@@ -612,6 +672,17 @@ namespace Graphics
 		Map<int32, Ref<Gamepad_Impl>> m_gamepads;
 		Map<SDL_JoystickID, Gamepad_Impl *> m_joystickMap;
 
+		// High resolution stamps of button events that are still in the SDL queue
+		struct InputStamp
+		{
+			uint32 type;
+			uint32 sdlTimestamp;
+			uint32 code;
+			int64 time;
+		};
+		// Filled by the event watch and drained by Update, both on the thread that pumps events
+		SPSCQueue<InputStamp> m_inputStamps{ 512 };
+
 		// Text input / IME stuff
 		TextComposition m_textComposition;
 
@@ -114,6 +114,8 @@ public:
 	void ForceRender();
 	void SetLuaBindings(struct lua_State* state);
 	Vector<String> GetLightPluginList();
+	// Opens the decoded audio cache with the configured size
+	void OpenAudioCache();
 	void RenderTickables();
 	struct NVGcontext* GetVGContext();
 	void SetRgbLights(int left, int pos, Colori color);
@@ -134,6 +136,7 @@ private:
 	void m_SaveConfig();
 	void m_InitDiscord();
 	bool m_Init();
+	int32 m_RunReplayVerification();
 	void m_MainLoop();
 	void m_Tick();
 	void m_Cleanup();
@@ -36,7 +36,8 @@ public:
 	~AudioPlayback();
 	// Loads audio for beatmap
 	//	specify the root path for the map in order to let this class find the audio files
-	bool Init(class BeatmapPlayback &playback, const String &mapRootPath, bool preRender, bool nrmAudio = false, float nrmAudioVol = 1.f);
+	//	pre-rendered effects are cached by the chart hash, nothing is cached without one
+	bool Init(class BeatmapPlayback &playback, const String &mapRootPath, bool preRender, bool nrmAudio = false, float nrmAudioVol = 1.f, const String &chartHash = String());
 
 	// Updates effects
 	void Tick(float deltaTime);
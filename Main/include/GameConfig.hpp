@@ -56,6 +56,7 @@ DefineEnum(GameConfigKeys,
 		GaugeDrainNormal,
 		GaugeDrainHalf,
 		ResponsiveInputs,
+		GameplayTickRate,
 		
 		EnableHiddenSudden,
 		HiddenCutoff,
@@ -164,8 +165,13 @@ DefineEnum(GameConfigKeys,
 		
 		
 		WASAPI_Exclusive,
+		AudioBufferSize,
 		MuteUnfocused,
 		PrerenderEffects,
+		ResampleQuality,
+		AudioCacheSize,
+		SpectrumWindowSize,
+		SpectrumBuckets,
 		UseLightPlugins,
 		LightPlugin,
 		
@@ -214,6 +220,7 @@ DefineEnum(GameConfigKeys,
 		GameplaySettingsDialogLastTab,
 		SettingsLastTab,
 		TransferScoresOnChartUpdate,
+		ChartFolderPollInterval,
 		
 		KeepFontTexture,
 		
@@ -8,6 +8,8 @@ DefineEnum(InputDevice,
 
 typedef Ref<int32> MouseLockHandle;
 
+class InputSampler;
+
 /*
 	Class that handles game keyboard (and soon controller input)
 */
@@ -45,6 +47,10 @@ public:
 	// Primarily used for debugging
 	String GetControllerStateString() const;
 
+	// Attach a sampler whose queued events are dispatched on Update, nullptr to detach
+	//	event devices are InputDevice values, codes are scancodes for keyboard events and button indices for controller events
+	void SetSampler(InputSampler* sampler);
+
 	// Returns a handle to a mouse lock, release it to unlock the mouse
 	MouseLockHandle LockMouse();
 
@@ -70,6 +76,7 @@ private:
 	void m_InitKeyboardMapping();
 	void m_InitControllerMapping();
 	void m_OnButtonInput(Button b, bool pressed, int32 delta);
+	void m_ProcessSampledEvents();
 
 	void m_OnGamepadButtonPressed(uint8 button, int32 delta);
 	void m_OnGamepadButtonReleased(uint8 button, int32 delta);
@@ -115,4 +122,5 @@ private:
 	Ref<Gamepad> m_gamepad;
 
 	Graphics::Window* m_window = nullptr;
+	InputSampler* m_sampler = nullptr;
 };
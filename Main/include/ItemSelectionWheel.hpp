@@ -3,6 +3,8 @@
 #include "SongFilter.hpp"
 #include "Search.hpp"
 #include <Beatmap/MapDatabase.hpp>
+#include <algorithm>
+#include <iterator>
 
 // ItemIndex represents the current item selected
 // DBIndex represents the datastructure the db has for that item
@@ -18,6 +20,18 @@ protected:
 	bool m_filterSet = false;
 	IApplicationTickable *m_owner;
 
+	// Result of a single filter, only recomputed when the filter, its version or the items change
+	struct FilterStage
+	{
+		Filter<ItemSelectIndex>* filter = nullptr;
+		uint32 filterVersion = 0;
+		uint32 itemsVersion = 0;
+		Vector<int32> ids;
+	};
+	FilterStage m_filterStages[2];
+	// Incremented whenever m_items changes
+	uint32 m_itemsVersion = 1;
+
 	// Currently selected sort index
 	uint32 m_selectedSortIndex = 0;
 
@@ -69,6 +83,7 @@ public:
 	virtual void OnItemsAdded(Vector<DBIndex*> items)
 	{
 		bool hadItems = m_items.size() != 0;
+		m_itemsVersion++;
 		for (auto i : items)
 		{
 			ItemSelectIndex index(i);
@@ -99,6 +114,7 @@ public:
 
 	virtual void OnItemsRemoved(Vector<DBIndex*> items)
 	{
+		m_itemsVersion++;
 		for (auto i : items)
 		{
 			ItemSelectIndex index(i);
@@ -127,6 +143,7 @@ public:
 	virtual void OnItemsUpdated(Vector<DBIndex *> items)
 	{
 		// TODO what does this actually do?
+		m_itemsVersion++;
 		for (auto i : items)
 		{
 			ItemSelectIndex index(i);
@@ -144,6 +161,7 @@ public:
 	virtual void OnItemsCleared(Map<int32, DBIndex *> newList)
 	{
 
+		m_itemsVersion++;
 		m_itemFilter.clear();
 		m_items.clear();
 		m_sortVec.clear();
@@ -358,21 +376,51 @@ public:
 
 	void SetFilter(Filter<ItemSelectIndex> *filter[2])
 	{
-		bool isFiltered = false;
-		m_itemFilter = m_items;
+		// Intersect the ids of all filters, only filters that changed since the last call are evaluated again
+		Filter<ItemSelectIndex>* lastFilter = nullptr;
+		Vector<int32> ids;
+		Vector<int32> intersection;
 		for (size_t i = 0; i < 2; i++)
 		{
-			if (!filter[i])
+			if (!filter[i] || filter[i]->IsAll())
 				continue;
-			m_itemFilter = filter[i]->GetFiltered(m_itemFilter);
-			if (!filter[i]->IsAll())
-				isFiltered = true;
+
+			FilterStage& stage = m_filterStages[i];
+			const uint32 filterVersion = filter[i]->GetVersion();
+			if (stage.filter != filter[i] || stage.filterVersion != filterVersion || stage.itemsVersion != m_itemsVersion)
+			{
+				stage.filter = filter[i];
+				stage.filterVersion = filterVersion;
+				stage.itemsVersion = m_itemsVersion;
+				filter[i]->GetFilteredIds(m_items, stage.ids);
+			}
+
+			if (!lastFilter)
+			{
+				ids = stage.ids;
+			}
+			else
+			{
+				intersection.clear();
+				std::set_intersection(ids.begin(), ids.end(), stage.ids.begin(), stage.ids.end(), std::back_inserter(intersection));
+				ids.swap(intersection);
+			}
+			lastFilter = filter[i];
 		}
+		const bool isFiltered = lastFilter != nullptr;
 		m_filterSet = isFiltered;
 
+		m_itemFilter.clear();
+		for (int32 id : ids)
+		{
+			auto it = m_items.find(id);
+			if (it != m_items.end())
+				lastFilter->AddFilteredItems(it->second, m_itemFilter);
+		}
+
 		// Add the filtered maps into the sort vec then sort
 		m_sortVec.clear();
-		for (auto &it : m_itemFilter)
+		for (auto &it : m_SourceCollection())
 		{
 			m_sortVec.push_back(it.first);
 		}
@@ -0,0 +1,106 @@
+#pragma once
+#include "lua.hpp"
+#include <Shared/Enum.hpp>
+#include <Shared/Unique.hpp>
+
+/*
+	Field names for tables that are updated every frame, interned once per lua_State
+
+	The names of an enum declared with DefineEnum are stored as an array in the registry of each state they are used with,
+	so pushing a key is a single array lookup instead of hashing the same C string every frame.
+	Fields are written with raw sets, the tables these are used for don't have metatables.
+
+	Usage:
+		DefineEnum(MyKey, a, b);
+		LuaKeyCache<Enum_MyKey> keys(L);
+		lua_getglobal(L, "t");
+		keys.SetNumber(-1, MyKey::a, 1.0);
+
+	Constructing this pushes a value, so relative indices of values pushed before it must be made absolute first.
+*/
+template<typename EnumInfo>
+class LuaKeyCache : Unique
+{
+public:
+	using Key = typename EnumInfo::EnumType;
+
+	// Pushes the key array of this state, creating it on first use. It is removed from the stack again when this goes out of scope
+	LuaKeyCache(lua_State* L) : L(L)
+	{
+		if (lua_rawgetp(L, LUA_REGISTRYINDEX, &EnumInfo::GetMap()) != LUA_TTABLE)
+		{
+			lua_pop(L, 1);
+			lua_createtable(L, (int)Key::_Length, 0);
+			for (auto& name : EnumInfo::GetMap())
+			{
+				lua_pushlstring(L, name.second.data(), name.second.size());
+				lua_rawseti(L, -2, (lua_Integer)name.first + 1);
+			}
+			lua_pushvalue(L, -1);
+			lua_rawsetp(L, LUA_REGISTRYINDEX, &EnumInfo::GetMap());
+		}
+		m_keys = lua_gettop(L);
+	}
+	~LuaKeyCache()
+	{
+		lua_remove(L, m_keys);
+	}
+
+	void PushKey(Key key) const
+	{
+		lua_rawgeti(L, m_keys, (lua_Integer)key + 1);
+	}
+
+	// Pushes t[key], returns the type of the value
+	int Get(int table, Key key) const
+	{
+		table = lua_absindex(L, table);
+		PushKey(key);
+		return lua_rawget(L, table);
+	}
+	// Pushes the table stored at t[key], a new table is stored first if the field is not a table
+	void GetTable(int table, Key key) const
+	{
+		table = lua_absindex(L, table);
+		if (Get(table, key) == LUA_TTABLE)
+			return;
+		lua_pop(L, 1);
+		lua_newtable(L);
+		PushKey(key);
+		lua_pushvalue(L, -2);
+		lua_rawset(L, table);
+	}
+
+	void SetNumber(int table, Key key, lua_Number value) const
+	{
+		table = lua_absindex(L, table);
+		PushKey(key);
+		lua_pushnumber(L, value);
+		lua_rawset(L, table);
+	}
+	void SetInteger(int table, Key key, lua_Integer value) const
+	{
+		table = lua_absindex(L, table);
+		PushKey(key);
+		lua_pushinteger(L, value);
+		lua_rawset(L, table);
+	}
+	void SetBoolean(int table, Key key, bool value) const
+	{
+		table = lua_absindex(L, table);
+		PushKey(key);
+		lua_pushboolean(L, value);
+		lua_rawset(L, table);
+	}
+	void SetString(int table, Key key, const char* value) const
+	{
+		table = lua_absindex(L, table);
+		PushKey(key);
+		lua_pushstring(L, value);
+		lua_rawset(L, table);
+	}
+
+private:
+	lua_State* L;
+	int m_keys;
+};
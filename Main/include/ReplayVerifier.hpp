@@ -0,0 +1,56 @@
+#pragma once
+#include "BasicDefinitions.hpp"
+#include <Beatmap/PlaybackOptions.hpp>
+
+class MapDatabase;
+
+// Outcome of simulating a single replay
+struct ReplayVerifyResult
+{
+	String replayPath;
+	bool success = false;
+	// Reason why the replay could not be simulated
+	String error;
+
+	uint32 score = 0;
+	uint32 crit = 0;
+	uint32 almost = 0;
+	uint32 miss = 0;
+	uint32 maxCombo = 0;
+	float gauge = 0.0f;
+	GaugeType gaugeType = GaugeType::Normal;
+	ClearMark clearMark = ClearMark::NotPlayed;
+
+	// Set when the replay contains score info and it matches the simulated score
+	bool hasRecordedScore = false;
+	bool matchesRecordedScore = false;
+};
+
+/*
+	Headless gameplay simulation used to verify replays in bulk
+	Drives BeatmapPlayback and Scoring with a synthetic clock, without a window, audio device or Lua
+	this is used when -verifyreplays is provided at application startup
+*/
+class ReplayVerifier
+{
+public:
+	// Needs a loaded database to find the charts replays were recorded on
+	ReplayVerifier(MapDatabase& database) : m_database(database) {}
+
+	// Simulates a single replay file
+	ReplayVerifyResult Verify(const String& replayPath) const;
+
+	// Simulates all given replays spread over `numThreads` worker threads (0 = number of cores)
+	// results are in the same order as the input paths
+	Vector<ReplayVerifyResult> VerifyAll(const Vector<String>& replayPaths, uint32 numThreads = 0) const;
+
+	// Runs the verifier from command line arguments, prints results to stdout and returns the process exit code
+	//	-verifyreplays [-threads=N] [-step=ms] <replay.urf|folder>...
+	static int32 RunFromCommandLine(const Vector<String>& commandLine);
+
+	// Step size of the synthetic clock in ms
+	MapTime stepSize = 4;
+
+private:
+	MapDatabase& m_database;
+};
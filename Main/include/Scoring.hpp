@@ -85,7 +85,8 @@ struct MapTotals
 class Scoring : public Unique
 {
 public:
-	Scoring();
+	// Headless users (replay verification) don't register their autoplay info with the application
+	Scoring(bool registerAutoplayInfo = true);
 	~Scoring();
 
 	static ClearMark CalculateBadge(const ScoreIndex& score);
@@ -102,6 +103,9 @@ public:
 
 	inline void SetHitWindow(const HitWindow& window) { hitWindow = window; }
 
+	// Fraction of the frame's laser input applied per Tick, used when a frame is simulated in multiple steps
+	inline void SetLaserInputScale(float scale) { m_laserInputScale = scale; }
+
 	// Resets/Initializes the scoring system
 	// Called after SetPlayback
 	void Reset(const MapTimeRange& range = {});
@@ -311,6 +315,9 @@ private:
 	HitStat* m_AddOrUpdateHitStat(ObjectState* object);
 	void m_CleanupHitStats();
 
+	// Whether this instance is exposed through Application::autoplayInfo
+	bool m_registerAutoplayInfo = true;
+
 	// Updates laser output with or without interpolation
 	bool m_interpolateLaserOutput = false;
 
@@ -324,6 +331,7 @@ private:
 
 	// Input values for laser [-1,1]
 	float m_laserInput[2] = { 0.0f };
+	float m_laserInputScale = 1.0f;
 	// Decides if the coming tick should be auto completed
 	float m_autoLaserTime[2] = { 0,0 };
 	
@@ -20,7 +20,22 @@ public:
 	virtual String GetName() const { return m_name; }
 	virtual bool IsAll() const { return true; }
 	virtual FilterType GetType() const { return FilterType::All; }
-	virtual Map<int32, ItemIndex> GetFiltered(const Map<int32, ItemIndex>& source) { return source; }
+	// Changes when the filtered ids change without the items changing
+	virtual uint32 GetVersion() const { return 0; }
+
+	// Writes the sorted ids of the items that pass this filter, filters are combined by intersecting these
+	virtual void GetFilteredIds(const Map<int32, ItemIndex>& source, Vector<int32>& out)
+	{
+		out.clear();
+		out.reserve(source.size());
+		for (auto& it : source)
+			out.Add(it.first);
+	}
+	// Adds the items that are shown for an item that passed all filters, called on the last filter that was applied
+	virtual void AddFilteredItems(const ItemIndex& item, Map<int32, ItemIndex>& out) const
+	{
+		out.Add(item.id, item);
+	}
 private:
 	String m_name = "All";
 };
@@ -32,7 +47,9 @@ class LevelFilter : public SongFilter
 public:
 	~LevelFilter() = default;
 	LevelFilter(uint16 level) : m_level(level) {}
-	Map<int32, SongSelectIndex> GetFiltered(const Map<int32, SongSelectIndex>& source) override;
+	void GetFilteredIds(const Map<int32, SongSelectIndex>& source, Vector<int32>& out) override;
+	// Adds a separate item for every chart with this level
+	void AddFilteredItems(const SongSelectIndex& item, Map<int32, SongSelectIndex>& out) const override;
 	String GetName() const override;
 	bool IsAll() const override;
 	FilterType GetType() const override { return FilterType::Level; }
@@ -47,7 +64,7 @@ class FolderFilter : public SongFilter
 public:
 	FolderFilter(String folder, MapDatabase* database) : m_folder(folder), m_mapDatabase(database) {}
 	~FolderFilter() = default;
-	Map<int32, SongSelectIndex> GetFiltered(const Map<int32, SongSelectIndex>& source) override;
+	void GetFilteredIds(const Map<int32, SongSelectIndex>& source, Vector<int32>& out) override;
 	String GetName() const override;
 	bool IsAll() const override;
 	FilterType GetType() const override { return FilterType::Folder; }
@@ -65,10 +82,11 @@ public:
 	CollectionFilter(String collection, MapDatabase* database) : m_collection(collection), m_mapDatabase(database) {}
 	~CollectionFilter() = default;
 
-	Map<int32, SongSelectIndex> GetFiltered(const Map<int32, SongSelectIndex>& source) override;
+	void GetFilteredIds(const Map<int32, SongSelectIndex>& source, Vector<int32>& out) override;
 	String GetName() const override;
 	bool IsAll() const override;
 	FilterType GetType() const override { return FilterType::Collection; }
+	uint32 GetVersion() const override;
 
 
 private:
@@ -84,7 +102,7 @@ class ChallengeLevelFilter : public ChallengeFilter
 public:
 	~ChallengeLevelFilter() = default;
 	ChallengeLevelFilter(uint16 level) : m_level(level) {}
-	Map<int32, ChallengeSelectIndex> GetFiltered(const Map<int32, ChallengeSelectIndex>& source) override;
+	void GetFilteredIds(const Map<int32, ChallengeSelectIndex>& source, Vector<int32>& out) override;
 	String GetName() const override;
 	bool IsAll() const override;
 	FilterType GetType() const override { return FilterType::Level; }
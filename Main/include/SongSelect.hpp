@@ -45,7 +45,7 @@ public:
 	// use accessor functions just in case these need to be virtual for some reason later
 	// keep the api easy to play with
 	FolderIndex* GetFolder() const { return m_folder; }
-	Vector<ChartIndex*> GetCharts() const { return m_charts; }
+	const Vector<ChartIndex*>& GetCharts() const { return m_charts; }
 
 };
 
@@ -61,8 +61,6 @@ class ScoreSort : public TitleSort
 		{ 
 			return m_dir? SortType::SCORE_DESC : SortType::SCORE_ASC;
 		};
-	private:
-		Map<uint32, uint32> m_scoreMap;
 };
 
 class DateSort : public TitleSort
@@ -75,8 +73,6 @@ class DateSort : public TitleSort
 		{ 
 			return m_dir? SortType::DATE_DESC : SortType::DATE_ASC;
 		};
-	private:
-		Map<uint32, uint64> m_dateMap;
 };
 
 class ArtistSort : public TitleSort
@@ -89,8 +85,6 @@ class ArtistSort : public TitleSort
 		{ 
 			return m_dir? SortType::ARTIST_DESC : SortType::ARTIST_ASC;
 		};
-	private:
-		Map<uint32, uint64> m_dateMap;
 };
 
 class EffectorSort : public TitleSort
@@ -115,8 +109,6 @@ class ClearMarkSort : public TitleSort
 		{ 
 			return m_dir? SortType::EFFECTOR_DESC : SortType::EFFECTOR_ASC;
 		};
-	private:
-		Map<uint32, uint64> m_clearMap;
 };
 
 using ChallengeSort = ItemSort<ChallengeSelectIndex>;
@@ -15,6 +15,7 @@
 #include "SkinConfig.hpp"
 #include "ShadedMesh.hpp"
 #include "IR.hpp"
+#include "ReplayVerifier.hpp"
 
 #ifdef EMBEDDED
 #define NANOVG_GLES2_IMPLEMENTATION
@@ -141,6 +142,10 @@ void Application::ApplySettings()
 }
 int32 Application::Run()
 {
+	// Headless replay verification, doesn't need a window, audio or lua
+	if (m_commandLine.Contains("-verifyreplays"))
+		return m_RunReplayVerification();
+
 	if (!m_Init())
 		return 1;
 
@@ -565,6 +570,28 @@ bool Application::m_LoadConfig(String profileName /* must be by value */)
 	return successful;
 }
 
+int32 Application::m_RunReplayVerification()
+{
+	ProfilerScope $("Replay Verification");
+
+	for (auto &cl : m_commandLine)
+	{
+		String k, v;
+		if (cl.Split("=", &k, &v) && k == "-gamedir")
+			Path::gameDir = v;
+	}
+
+	setlocale(LC_CTYPE, ".UTF-8");
+
+	if (!m_LoadConfig())
+		Log("Failed to load config file", Logger::Severity::Warning);
+
+	// Per-judgement replay logging would dominate the simulation time
+	Logger::Get().SetLogLevel(Logger::Severity::Warning);
+
+	return ReplayVerifier::RunFromCommandLine(m_commandLine);
+}
+
 void Application::m_UpdateConfigVersion()
 {
 	g_gameConfig.UpdateVersion();
@@ -917,6 +944,7 @@ void Application::m_InitLightPlugins()
 SDL_semaphore* renderSema = nullptr; //TODO: move to somewhere better
 std::atomic<bool> rendering;
 void threadedRenderer() {
+	Profiler::SetThreadName("Render");
 	while (true)
 	{
 		SDL_SemWait(renderSema);
@@ -939,6 +967,11 @@ bool Application::m_Init()
 {
 	ProfilerScope $("Application Setup");
 
+	// Frame and subsystem instrumentation, F12 ingame exports a trace
+	if (m_commandLine.Contains("-profile"))
+		Profiler::SetEnabled(true);
+	Profiler::SetThreadName("Main");
+
 	String version = Utility::Sprintf("%d.%d.%d", VERSION_MAJOR, VERSION_MINOR, VERSION_PATCH);
 	Logf("Version: %s", Logger::Severity::Info, version.c_str());
 
@@ -1108,13 +1141,14 @@ bool Application::m_Init()
 		// Init audio
 		new Audio();
 		bool exclusive = g_gameConfig.GetBool(GameConfigKeys::WASAPI_Exclusive);
-		if (!g_audio->Init(exclusive))
+		const uint32 bufferSize = (uint32)Math::Max(g_gameConfig.GetInt(GameConfigKeys::AudioBufferSize), 0);
+		if (!g_audio->Init(exclusive, bufferSize))
 		{
 			if (exclusive)
 			{
 				Log("Failed to open in WASAPI Exclusive mode, attempting shared mode.", Logger::Severity::Warning);
 				g_gameWindow->ShowMessageBox("WASAPI Exclusive mode error.", "Failed to open in WASAPI Exclusive mode, attempting shared mode.", 1);
-				if (!g_audio->Init(false))
+				if (!g_audio->Init(false, bufferSize))
 				{
 					Log("Audio initialization failed", Logger::Severity::Error);
 					delete g_audio;
@@ -1129,6 +1163,9 @@ bool Application::m_Init()
 			}
 		}
 
+		g_audio->SetResampleQuality(g_gameConfig.GetEnum<Enum_ResampleQuality>(GameConfigKeys::ResampleQuality));
+		OpenAudioCache();
+
 		// Debug Mute?
 		// Test tracks may get annoying when continously debugging ;)
 		if (debugMute)
@@ -1217,6 +1254,7 @@ void Application::m_MainLoop()
 	m_deltaTime = 0.5f;
 	while (true)
 	{
+		Profiler::BeginFrame();
 		m_appTime = appTimer.SecondsAsFloat();
 		//TODO(skade) nvg scale
 		//g_scale = 1.0f;//1.0f + sinf(m_appTime)*0.5f;
@@ -1309,24 +1347,33 @@ void Application::m_MainLoop()
 		m_renderStateBase.time = currentTime;
 
 		// Also update window in render loop
-		if (!g_gameWindow->Update())
-			return;
+		{
+			ProfilerZone $("Window::Update");
+			if (!g_gameWindow->Update())
+				return;
+		}
 
 		m_Tick();
 
-		// Garbage collect resources
-		ResourceManagers::TickAll();
+		{
+			ProfilerZone $("Resources and jobs");
+			// Garbage collect resources
+			ResourceManagers::TickAll();
 
-		// Tick job sheduler
-		// processed callbacks for finished tasks
-		g_jobSheduler->Update();
+			// Tick job sheduler
+			// processed callbacks for finished tasks
+			g_jobSheduler->Update();
+		}
 
 		m_deltaTime = m_frameTimer.SecondsAsFloat();
+		Profiler::EndFrame();
 	}
 }
 
 void Application::m_Tick()
 {
+	ProfilerZone $("Application::Tick");
+
 	// Handle input first
 	g_input.Update(m_deltaTime);
 
@@ -1337,9 +1384,12 @@ void Application::m_Tick()
 	m_skinIR.ProcessCallbacks();
 
 	// Tick all items
-	for (auto &tickable : g_tickables)
 	{
-		tickable->Tick(m_deltaTime);
+		ProfilerZone $("Tickables::Tick");
+		for (auto &tickable : g_tickables)
+		{
+			tickable->Tick(m_deltaTime);
+		}
 	}
 	// Not minimized / Valid resolution
 	if (g_resolution.x > 0 && g_resolution.y > 0)
@@ -1395,6 +1445,8 @@ static void CheckGLErrors(const std::string_view label)
 
 void Application::RenderTickables()
 {
+	ProfilerZone $("Application::Render");
+
 	//Clear out opengl errors
 	CheckGLErrors("on entering Application::RenderTickables");
 
@@ -1483,7 +1535,10 @@ void Application::RenderTickables()
 	CheckGLErrors("just before buffer swapping");
 
 	// Swap buffers
-	g_gl->SwapBuffers();
+	{
+		ProfilerZone $("SwapBuffers");
+		g_gl->SwapBuffers();
+	}
 
 	GLenum glErr;
 	while ((glErr = glGetError()) != GL_NO_ERROR)
@@ -1505,9 +1560,12 @@ void Application::m_Cleanup()
 	}
 	g_tickables.clear();
 
-	SDL_SemPost(renderSema);
-	m_renderThread.join();
-	SDL_DestroySemaphore(renderSema);
+	if (m_renderThread.joinable())
+	{
+		SDL_SemPost(renderSema);
+		m_renderThread.join();
+		SDL_DestroySemaphore(renderSema);
+	}
 
 
 	if (g_audio)
@@ -1580,11 +1638,14 @@ void Application::m_Cleanup()
 
 	Discord_Shutdown();
 
+	if (g_guiState.vg)
+	{
 #ifdef EMBEDDED
-	nvgDeleteGLES2(g_guiState.vg);
+		nvgDeleteGLES2(g_guiState.vg);
 #else
-	nvgDeleteGL3(g_guiState.vg);
+		nvgDeleteGL3(g_guiState.vg);
 #endif
+	}
 
 	Graphics::FontRes::FreeLibrary();
 	if (m_updateThread.joinable())
@@ -2612,6 +2673,12 @@ Vector<String> Application::GetLightPluginList()
 	return names;
 }
 
+void Application::OpenAudioCache()
+{
+	const uint64 size = (uint64)Math::Max(0, g_gameConfig.GetInt(GameConfigKeys::AudioCacheSize));
+	g_audio->GetPcmCache().Open(Path::Absolute("cache/audio"), size << 20);
+}
+
 
 bool JacketLoadingJob::Run()
 {
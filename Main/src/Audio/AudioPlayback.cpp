@@ -17,7 +17,7 @@ AudioPlayback::~AudioPlayback()
 	m_CleanupDSP(m_missVocalDSP);
 	m_CleanupDSPfx(m_missVocalDSPfx);
 }
-bool AudioPlayback::Init(class BeatmapPlayback &playback, const String &mapRootPath, bool preRender, bool nrmAudio, float nrmAudioVol)
+bool AudioPlayback::Init(class BeatmapPlayback &playback, const String &mapRootPath, bool preRender, bool nrmAudio, float nrmAudioVol, const String &chartHash)
 {
 	// Cleanup exising DSP's
 	m_currentHoldEffects[0] = nullptr;
@@ -105,9 +105,26 @@ bool AudioPlayback::Init(class BeatmapPlayback &playback, const String &mapRootP
 	}
 	if (preRender)
 	{
-		m_fxtrack = AudioStream::Clone(g_audio, m_music);
-		assert(m_fxtrack);
-		m_PreRenderDSPTrack();
+		// The effects only depend on the chart, so the rendered track can be cached along with the decoded music
+		String fxKey;
+		if (!chartHash.empty() && !m_music->GetCacheKey().empty())
+		{
+			const String params = "fx " + chartHash + (nrmAudio ? Utility::Sprintf(" %f", nrmAudioVol) : String());
+			fxKey = PcmCache::MakeKey(m_music->GetCacheKey().data(), m_music->GetCacheKey().size(), params);
+		}
+		Ref<CachedPcm> cached = fxKey.empty() ? nullptr : g_audio->GetPcmCache().Load(fxKey);
+		if (cached)
+		{
+			m_fxtrack = AudioStream::Create(g_audio, cached);
+		}
+		else
+		{
+			m_fxtrack = AudioStream::Clone(g_audio, m_music);
+			assert(m_fxtrack);
+			m_PreRenderDSPTrack();
+			if (!fxKey.empty())
+				g_audio->GetPcmCache().Store(fxKey, m_fxtrack->GetPCM(), m_fxtrack->GetPCMCount(), m_fxtrack->GetSampleRate());
+		}
 		return true;
 	}
 
@@ -22,9 +22,12 @@ OffsetComputer::OffsetComputer(AudioPlayback& audioPlayback)
 }
 
 OffsetComputer::OffsetComputer(Ref<AudioStream> music, const Beatmap& beatmap)
-	: m_pcm(music->GetPCM()), m_pcmCount(music->GetPCMCount()), m_sampleRate(music->GetSampleRate()),
-	m_beatmap(beatmap)
+	: m_sampleRate(music->GetSampleRate()), m_beatmap(beatmap)
 {
+	// The whole song is used, the samples and their count are only complete once it's decoded
+	music->WaitForDecode();
+	m_pcm = music->GetPCM();
+	m_pcmCount = music->GetPCMCount();
 }
 
 bool OffsetComputer::Compute(const ChartIndex* chart, int& outOffset)
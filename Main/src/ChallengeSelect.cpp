@@ -493,7 +493,9 @@ public:
 			if (m_folders.find(p) == m_folders.end())
 			{
 				FolderFilter *filter = new FolderFilter(p, m_mapDB);
-				if (filter->GetFiltered(Map<int32, SongSelectIndex>()).size() > 0)
+				Vector<int32> folderIds;
+				filter->GetFilteredIds(Map<int32, SongSelectIndex>(), folderIds);
+				if (folderIds.size() > 0)
 				{
 					AddFilter(filter, FilterType::Folder);
 					m_folders.insert(p);
@@ -767,6 +769,7 @@ public:
 		m_mapDatabase->OnDatabaseUpdateDone.Add(this, &ChallengeSelect_Impl::m_onDatabaseUpdateDone);
 		m_mapDatabase->OnDatabaseUpdateProgress.Add(this, &ChallengeSelect_Impl::m_onDatabaseUpdateProgress);
 		m_mapDatabase->SetChartUpdateBehavior(g_gameConfig.GetBool(GameConfigKeys::TransferScoresOnChartUpdate));
+		m_mapDatabase->SetWatchPollInterval(g_gameConfig.GetFloat(GameConfigKeys::ChartFolderPollInterval));
 		m_mapDatabase->FinishInit();
 
 		// Setup the map database
@@ -33,9 +33,20 @@
 
 //#include "Lua/luaMods.hpp"
 #include "GUI/guiState.h"
+#include "Lua/luaKeyCache.hpp"
 
 extern struct GUIState g_guiState;
 
+// Fields of the gameplay and mdv tables that are updated every frame
+DefineEnum(GameplayLuaKey,
+	spectrum, spectrumN, noteHeld, laserActive, autoplay, practice_setup,
+	scoreReplays, maxScore, currentScore, progress, hispeed, hispeedAdjust, playbackSpeed, bpm,
+	gauge, type, options, value, name, comboState,
+	hiddenFade, hiddenCutoff, suddenFade, suddenCutoff,
+	critLine, x, y, z, rotation, xOffset, line, x1, y1, x2, y2, cursors, pos, alpha, skew,
+	gScale, TRACK_H);
+typedef LuaKeyCache<Enum_GameplayLuaKey> GameplayLuaKeys;
+
 // Try load map helper
 Ref<Beatmap> TryLoadMap(const String& path)
 {
@@ -135,6 +146,8 @@ private:
 	int32 m_tempOffset = 0;
 
 	int32 m_fpsTarget = 0;
+	// Maximum map time simulated by a single playback and scoring step, 0 to step once per frame
+	MapTime m_simulationStep = 1;
 	// The play field
 	Track* m_track = nullptr;
 
@@ -159,9 +172,9 @@ private:
 	lua_State* m_lua = nullptr;
 
 	// spektrum vector
-	float m_spectrum[16];
+	Vector<float> m_spectrum;
 	// spektrum vector without modifications
-	float m_spectrumN[16];
+	Vector<float> m_spectrumN;
 	
 	// Currently active timing point
 	const TimingPoint* m_currentTiming;
@@ -464,7 +477,8 @@ public:
 
 		// Load beatmap audio
 		if(!m_audioPlayback.Init(m_playback, m_chartRootPath, g_gameConfig.GetBool(GameConfigKeys::PrerenderEffects),
-								g_gameConfig.GetBool(GameConfigKeys::NormalizeAudio),g_gameConfig.GetFloat(GameConfigKeys::NormalizeAudioVolume)))
+								g_gameConfig.GetBool(GameConfigKeys::NormalizeAudio),g_gameConfig.GetFloat(GameConfigKeys::NormalizeAudioVolume),
+								m_chartIndex ? m_chartIndex->hash : String()))
 			return false;
 
 		m_songOffset = 0;
@@ -486,6 +500,10 @@ public:
 		// Get fps limit
 		m_fpsTarget = g_gameConfig.GetInt(GameConfigKeys::FPSTarget);
 
+		// Get gameplay simulation rate
+		const int32 tickRate = g_gameConfig.GetInt(GameConfigKeys::GameplayTickRate);
+		m_simulationStep = tickRate > 0 ? Math::Max(1, 1000 / tickRate) : 0;
+
 		m_lastMapTime = GetPlayStartTime();
 
 		// Load audio offset
@@ -603,6 +621,12 @@ public:
 		g_application->DiscordPresenceSong(mapSettings, startTime, endTime);
 
 		String jacketPath = m_chartRootPath + "/" + mapSettings.jacketPath;
+
+		SpectrumAnalyzer& spectrum = g_audio->GetSpectrumAnalyzer();
+		spectrum.SetSize(g_gameConfig.GetInt(GameConfigKeys::SpectrumWindowSize), g_gameConfig.GetInt(GameConfigKeys::SpectrumBuckets));
+		m_spectrum.assign(spectrum.GetNumBuckets(), 0.0f);
+		m_spectrumN.assign(spectrum.GetNumBuckets(), 0.0f);
+
 		// Set gameplay table
 		SetInitialGameplayLua(m_lua);
 		SetInitialModsLua(m_lua);
@@ -963,6 +987,7 @@ public:
 	void Render(float deltaTime) override
 	{
 		if (m_ended && IsSuspended()) return;
+		ProfilerZone $("Game::Render");
 
 		// Adjust factor for the hi-speed, based on the playback speed
 		float hiSpeedAdjustFactor = 1.0;
@@ -1083,16 +1108,19 @@ public:
 		//draw LaneLight
 		m_track->DrawLaneLight(renderQueue);
 
-		for(auto& object : m_currentObjectSet)
 		{
-			// TODO(itszn) use something better than m_permanentlyHiddenObjects
-			if(m_hiddenObjects.find(object) == m_hiddenObjects.end() && m_permanentlyHiddenObjects.find(object) == m_permanentlyHiddenObjects.end())
+			ProfilerZone $("Track::DrawObjects");
+			for(auto& object : m_currentObjectSet)
 			{
-				MultiObjectState* mobj = (MultiObjectState*)object;
-				if (object->type == ObjectType::Hold && (mobj->button.index == 4 || mobj->button.index == 5))
-					m_track->DrawObjectState(fxHoldObjectsRq, m_playback, object, m_scoring.IsObjectHeld(object), chipFXTimes);
-				else
-					m_track->DrawObjectState(hitObjectsTrackCoverRq, m_playback, object, m_scoring.IsObjectHeld(object), chipFXTimes);
+				// TODO(itszn) use something better than m_permanentlyHiddenObjects
+				if(m_hiddenObjects.find(object) == m_hiddenObjects.end() && m_permanentlyHiddenObjects.find(object) == m_permanentlyHiddenObjects.end())
+				{
+					MultiObjectState* mobj = (MultiObjectState*)object;
+					if (object->type == ObjectType::Hold && (mobj->button.index == 4 || mobj->button.index == 5))
+						m_track->DrawObjectState(fxHoldObjectsRq, m_playback, object, m_scoring.IsObjectHeld(object), chipFXTimes);
+					else
+						m_track->DrawObjectState(hitObjectsTrackCoverRq, m_playback, object, m_scoring.IsObjectHeld(object), chipFXTimes);
+				}
 			}
 		}
 
@@ -1197,6 +1225,7 @@ public:
 			}
 
 			RenderDebugHUD(deltaTime);
+			RenderProfilerHUD();
 
 			// Render particle effects last
 			if (particleMaterial && basicParticleTexture)
@@ -1246,14 +1275,17 @@ public:
 			//TODO(skade) render pre crit base foreground layer
 
 			// Render Critical Line Base
-			lua_getglobal(m_lua, "render_crit_base");
-			lua_pushnumber(m_lua, deltaTime);
-			if (lua_pcall(m_lua, 1, 0, 0) != 0)
 			{
-				if (!g_application->ScriptError("gameplay", m_lua))
+				ProfilerZone $("Lua render_crit_base", ProfilerCounter::LuaTime);
+				lua_getglobal(m_lua, "render_crit_base");
+				lua_pushnumber(m_lua, deltaTime);
+				if (lua_pcall(m_lua, 1, 0, 0) != 0)
 				{
-					m_renderFastGui = true;
-					return;
+					if (!g_application->ScriptError("gameplay", m_lua))
+					{
+						m_renderFastGui = true;
+						return;
+					}
 				}
 			}
 			// flush NVG
@@ -1289,14 +1321,17 @@ public:
 			}
 
 			// Render Lua HUD
-			lua_getglobal(m_lua, "render");
-			lua_pushnumber(m_lua, deltaTime);
-			if (lua_pcall(m_lua, 1, 0, 0) != 0)
 			{
-				if (!g_application->ScriptError("gameplay", m_lua))
+				ProfilerZone $("Lua render", ProfilerCounter::LuaTime);
+				lua_getglobal(m_lua, "render");
+				lua_pushnumber(m_lua, deltaTime);
+				if (lua_pcall(m_lua, 1, 0, 0) != 0)
 				{
-					m_renderFastGui = true;
-					return;
+					if (!g_application->ScriptError("gameplay", m_lua))
+					{
+						m_renderFastGui = true;
+						return;
+					}
 				}
 			}
 			if (!m_introCompleted)
@@ -1438,12 +1473,13 @@ public:
 	{
 		if (!m_lua) return;
 
+		GameplayLuaKeys keys(m_lua);
 		lua_getglobal(m_lua, "gameplay");
-		m_LuaUpdateProgress(m_lua);
-		lua_setglobal(m_lua, "gameplay");
+		m_LuaUpdateProgress(keys, -1);
+		lua_pop(m_lua, 1);
 	}
 
-	void m_LuaUpdateProgress(lua_State* L)
+	void m_LuaUpdateProgress(const GameplayLuaKeys& keys, int table)
 	{
 		MapTime progress = m_lastMapTime - m_playOptions.range.begin;
 		MapTime duration = m_playOptions.range.Length(m_endTime);
@@ -1455,9 +1491,7 @@ public:
 			duration = m_endTime;
 		}
 
-		lua_pushstring(L, "progress");
-		lua_pushnumber(L, Math::Clamp((float)progress / duration, 0.f, 1.f));
-		lua_settable(L, -3);
+		keys.SetNumber(table, GameplayLuaKey::progress, Math::Clamp((float)progress / duration, 0.f, 1.f));
 	}
 
 	// Loads sound effects
@@ -1580,9 +1614,69 @@ public:
 		m_audioPlayback.SetPlaybackSpeed(playbackSpeed);
 	}
 
+	// Advances playback and scoring up to `targetTime`
+	// a frame is split into steps of at most m_simulationStep so hold and laser judgement doesn't depend on the frame rate,
+	// the frame's input and delta time are spread evenly over the steps, stops early when the run is failed
+	void SimulateGameplay(MapTime targetTime, float deltaTime)
+	{
+		// Don't spend more than this many steps on a single frame (e.g. after a long hitch)
+		static constexpr int32 maxSimulationSteps = 500;
+
+		const MapTime startTime = m_playback.GetLastTime();
+		const MapTime remaining = targetTime - startTime;
+		int32 numSteps = 1;
+		if (m_simulationStep > 0 && remaining > m_simulationStep)
+			numSteps = Math::Min((remaining + m_simulationStep - 1) / m_simulationStep, maxSimulationSteps);
+
+		m_scoring.SetLaserInputScale(1.0f / numSteps);
+		for (int32 i = 1; i <= numSteps; i++)
+		{
+			const MapTime stepTime = numSteps == 1 ? targetTime : startTime + (MapTime)((int64)remaining * i / numSteps);
+			m_playback.Update(stepTime, GetAudioOffset());
+
+			// Every step keeps the order of a whole frame, the music filters and the fail check see the scoring of the previous step
+			m_audioPlayback.SetLaserFilterInput(m_scoring.GetLaserOutput(), m_scoring.IsLaserHeld(0, false) || m_scoring.IsLaserHeld(1, false));
+			m_audioPlayback.SetFXTrackEnabled(m_scoring.GetLaserActive() || m_scoring.GetFXActive());
+
+			// Stop playing if last gauge has reached its failstate
+			bool failedRun = false;
+			if (m_scoring.IsFailOut())
+			{
+				// In multiplayer we don't stop, but we send the final score
+				if (m_multiplayer == nullptr) {
+					FailCurrentRun();
+					failedRun = true;
+				} else if (!m_multiplayer->HasFailed()) {
+					m_multiplayer->Fail();
+
+					//TODO(gauge refactor): ?
+					//m_playOptions.flags = m_playOptions.flags & ~GameFlags::Hard;
+					//m_scoring.SetFlags(m_playOptions.flags);
+				}
+			}
+
+			MapTime lastTimeForScoring = m_playback.GetLastTime();
+			for (auto& replay : m_scoreReplays)
+			{
+				replay->UpdateToTime(lastTimeForScoring);
+			}
+
+			if (!m_ended)
+			{
+				m_scoring.Tick(deltaTime / numSteps);
+			}
+
+			// The run ended or restarted, the rest of the frame is not simulated
+			if (failedRun)
+				break;
+		}
+		m_scoring.SetLaserInputScale(1.0f);
+	}
+
 	// Processes input and Updates scoring, also handles audio timing management
 	void TickGameplay(float deltaTime)
 	{
+		ProfilerZone $("Game::TickGameplay");
 		if(!m_started && m_introCompleted && (m_multiplayer == nullptr || !m_multiplayer->IsSyncing()))
 		{
 			if (m_multiplayer != nullptr && !m_multiplayer->IsSynced()) {
@@ -1612,9 +1706,9 @@ public:
 
 		const BeatmapSettings& beatmapSettings = m_beatmap->GetMapSettings();
 
-		// Update beatmap playback
+		// Update beatmap playback and scoring
 		const MapTime playbackPositionMs = m_audioPlayback.GetPosition() - GetAudioOffset();
-		m_playback.Update(playbackPositionMs,GetAudioOffset());
+		SimulateGameplay(playbackPositionMs, deltaTime);
 
 		const MapTime delta = playbackPositionMs - m_lastMapTime;
 		
@@ -1636,44 +1730,12 @@ public:
 		//}
 
 		/// #Scoring
-		// Update music filter states
-		m_audioPlayback.SetLaserFilterInput(m_scoring.GetLaserOutput(), m_scoring.IsLaserHeld(0, false) || m_scoring.IsLaserHeld(1, false));
+		// Music filter states and the fail state are updated with every simulation step
 		m_audioPlayback.Tick(deltaTime);
 
-		m_audioPlayback.SetFXTrackEnabled(m_scoring.GetLaserActive() || m_scoring.GetFXActive());
-
 		//TODO(skade) move into extra thread.
 		// assign spektrum buckets
-		g_audio->ProcessFFT(m_spectrum, m_spectrumN, 16);
-
-		// Stop playing if last gauge has reached its failstate
-		if (m_scoring.IsFailOut())
-		{
-			// In multiplayer we don't stop, but we send the final score
-			if (m_multiplayer == nullptr) {
-				FailCurrentRun();
-			} else if (!m_multiplayer->HasFailed()) {
-				m_multiplayer->Fail();
-
-				//TODO(gauge refactor): ?
-				//m_playOptions.flags = m_playOptions.flags & ~GameFlags::Hard;
-				//m_scoring.SetFlags(m_playOptions.flags);
-			}
-		}
-
-
-		MapTime lastTimeForScoring = m_playback.GetLastTime();
-		for (auto& replay : m_scoreReplays)
-		{
-			replay->UpdateToTime(lastTimeForScoring);
-		}
-
-		// Update scoring
-		if (!m_ended)
-		{
-			m_scoring.Tick(deltaTime);
-
-		}
+		g_audio->GetSpectrumAnalyzer().Process(m_spectrum.data(), m_spectrumN.data());
 
 		// Get the current timing point
 		m_currentTiming = &m_playback.GetCurrentTimingPoint();
@@ -2292,6 +2354,58 @@ public:
 		//g_guiRenderer->End();
 	}
 
+	// Frame times, counters and the most expensive zones of the last frame, only when started with -profile
+	void RenderProfilerHUD()
+	{
+		if (!Profiler::IsEnabled())
+			return;
+
+		Vector<ProfilerFrame> frames = Profiler::GetFrames();
+		if (frames.empty())
+			return;
+
+		int size = g_gameWindow->GetWindowSize().y / (65.0f);
+		size = std::max(size, 12);
+		auto RenderText = [&](const String& text, const Vector2& pos, const Color& color = {0.5f, 1.0f, 0.5f, 1.0f})
+		{
+			g_application->FastText(text, pos.x + 1, pos.y + 1, size, 0, Color::Black);
+			g_application->FastText(text, pos.x, pos.y, size, 0, color);
+			return Vector2(0, size);
+		};
+
+		int64 totalTime = 0;
+		int64 maxTime = 0;
+		for (const ProfilerFrame& frame : frames)
+		{
+			totalTime += frame.duration;
+			maxTime = std::max(maxTime, frame.duration);
+		}
+		const ProfilerFrame& last = frames.back();
+
+		Vector2 textPos = Vector2(g_resolution.x * 0.5f, 5.0f);
+		textPos.y += RenderText(Utility::Sprintf("Frame: %.2fms avg %.2fms max %.2fms (%d frames)",
+			last.duration / 1000.0, totalTime / 1000.0 / frames.size(), maxTime / 1000.0, (int32)frames.size()), textPos).y;
+
+		for (size_t i = 0; i < (size_t)ProfilerCounter::Count; i++)
+		{
+			const ProfilerCounter counter = (ProfilerCounter)i;
+			const bool isTime = counter == ProfilerCounter::LuaTime || counter == ProfilerCounter::MixTime;
+			textPos.y += RenderText(isTime ?
+				Utility::Sprintf("%s: %.2fms", Profiler::GetCounterName(counter), last.counters[i] / 1000.0) :
+				Utility::Sprintf("%s: %lld", Profiler::GetCounterName(counter), (long long)last.counters[i]), textPos).y;
+		}
+
+		uint32 zonesShown = 0;
+		for (const ProfilerZoneSummary& zone : Profiler::GetZoneSummary(last.start, last.start + last.duration))
+		{
+			if (zonesShown++ >= 12)
+				break;
+			textPos.y += RenderText(Utility::Sprintf("[%d] %s: %.3fms (%dx)",
+				zone.threadId, zone.name, zone.totalTime / 1000.0, zone.calls), textPos, Color::White).y;
+		}
+		RenderText("F12: Export trace", textPos, Color::Cyan);
+	}
+
 	void OnLaserSlam(LaserObjectState* object)
 	{
 		// Note: this merely simulates the slam roll effect. The way SDVX does laser slams is probably just putting
@@ -2314,6 +2428,7 @@ public:
 
 	void OnLaserSlamHit(LaserObjectState* object)
 	{
+		ProfilerZone $("Game::OnLaserSlamHit");
 		float slamSize = object->points[1] - object->points[0];
 		float direction = Math::Sign(slamSize);
 		if (g_gameConfig.GetBool(GameConfigKeys::OldSlamShake)) {
@@ -2339,27 +2454,31 @@ public:
 		ex->position = m_track->TransformPoint(ex->position);
 
 		//call lua button_hit if it exists
-		lua_getglobal(m_lua, "laser_slam_hit");
-		if (lua_isfunction(m_lua, -1))
 		{
-			// Slam size and direction
-			lua_pushnumber(m_lua, slamSize * width);
-			// Start position
-			lua_pushnumber(m_lua, startPos);
-			// End position
-			lua_pushnumber(m_lua, endPos);
-			// Laser index
-			lua_pushnumber(m_lua, object->index);
-			if (lua_pcall(m_lua, 4, 0, 0) != 0)
+			ProfilerZone $("Lua laser_slam_hit", ProfilerCounter::LuaTime);
+			lua_getglobal(m_lua, "laser_slam_hit");
+			if (lua_isfunction(m_lua, -1))
 			{
-				Logf("Lua error on calling laser_slam_hit: %s", Logger::Severity::Error, lua_tostring(m_lua, -1));
+				// Slam size and direction
+				lua_pushnumber(m_lua, slamSize * width);
+				// Start position
+				lua_pushnumber(m_lua, startPos);
+				// End position
+				lua_pushnumber(m_lua, endPos);
+				// Laser index
+				lua_pushnumber(m_lua, object->index);
+				if (lua_pcall(m_lua, 4, 0, 0) != 0)
+				{
+					Logf("Lua error on calling laser_slam_hit: %s", Logger::Severity::Error, lua_tostring(m_lua, -1));
+				}
 			}
+			lua_settop(m_lua, 0);
 		}
-		lua_settop(m_lua, 0);
 	}
 
 	void OnLaserDirChange(int index)
 	{
+		ProfilerZone $("Lua laser_dir_change", ProfilerCounter::LuaTime);
 		lua_getglobal(m_lua, "laser_dir_change");
 		if (lua_isfunction(m_lua, -1))
 		{
@@ -2374,6 +2493,7 @@ public:
 
 	void OnButtonHit(Input::Button button, ScoreHitRating rating, ObjectState* hitObject, MapTime delta)
 	{
+		ProfilerZone $("Game::OnButtonHit");
 		ButtonObjectState* st = (ButtonObjectState*)hitObject;
 		uint32 buttonIdx = (uint32)button;
 		Color c = m_track->hitColors[(size_t)rating];
@@ -2415,6 +2535,7 @@ public:
 			{
 				//m_track->timedHitEffect->late = late;
 				//m_track->timedHitEffect->Reset(0.75f);
+				ProfilerZone $("Lua near_hit", ProfilerCounter::LuaTime);
 				lua_getglobal(m_lua, "near_hit");
 				lua_pushboolean(m_lua, delta > 0);
 				if (lua_pcall(m_lua, 1, 0, 0) != 0)
@@ -2447,22 +2568,26 @@ public:
 		}
 
 		//call lua button_hit if it exists
-		lua_getglobal(m_lua, "button_hit");
-		if (lua_isfunction(m_lua, -1))
 		{
-			lua_pushnumber(m_lua, buttonIdx);
-			lua_pushnumber(m_lua, (int)rating);
-			lua_pushnumber(m_lua, delta);
-			if (lua_pcall(m_lua, 3, 0, 0) != 0)
+			ProfilerZone $("Lua button_hit", ProfilerCounter::LuaTime);
+			lua_getglobal(m_lua, "button_hit");
+			if (lua_isfunction(m_lua, -1))
 			{
-				Logf("Lua error on calling button_hit: %s", Logger::Severity::Error, lua_tostring(m_lua, -1));
+				lua_pushnumber(m_lua, buttonIdx);
+				lua_pushnumber(m_lua, (int)rating);
+				lua_pushnumber(m_lua, delta);
+				if (lua_pcall(m_lua, 3, 0, 0) != 0)
+				{
+					Logf("Lua error on calling button_hit: %s", Logger::Severity::Error, lua_tostring(m_lua, -1));
+				}
 			}
+			lua_settop(m_lua, 0);
 		}
-		lua_settop(m_lua, 0);
 	}
 
 	void OnButtonMiss(Input::Button button, bool hitEffect, ObjectState* object)
 	{
+		ProfilerZone $("Game::OnButtonMiss");
 		if (g_gameConfig.GetBool(GameConfigKeys::MissVocalFX))
 			m_audioPlayback.SetMissVocalEffect(true);
 		uint32 buttonIdx = (uint32)button;
@@ -2476,23 +2601,28 @@ public:
 		m_track->AddEffect(new ButtonHitRatingEffect(buttonIdx, ScoreHitRating::Miss));
 
 
-		lua_getglobal(m_lua, "button_hit");
-		if (lua_isfunction(m_lua, -1))
 		{
-			lua_pushnumber(m_lua, buttonIdx);
-			lua_pushnumber(m_lua, (int)ScoreHitRating::Miss);
-			lua_pushnumber(m_lua, 0);
-			if (lua_pcall(m_lua, 3, 0, 0) != 0)
+			ProfilerZone $("Lua button_hit", ProfilerCounter::LuaTime);
+			lua_getglobal(m_lua, "button_hit");
+			if (lua_isfunction(m_lua, -1))
 			{
-				Logf("Lua error on calling button_hit: %s", Logger::Severity::Error, lua_tostring(m_lua, -1));
+				lua_pushnumber(m_lua, buttonIdx);
+				lua_pushnumber(m_lua, (int)ScoreHitRating::Miss);
+				lua_pushnumber(m_lua, 0);
+				if (lua_pcall(m_lua, 3, 0, 0) != 0)
+				{
+					Logf("Lua error on calling button_hit: %s", Logger::Severity::Error, lua_tostring(m_lua, -1));
+				}
 			}
+			lua_settop(m_lua, 0);
 		}
-		lua_settop(m_lua, 0);
 	}
 
 	void OnComboChanged(uint32 newCombo)
 	{
+		ProfilerZone $("Game::OnComboChanged");
 		m_comboAnimation.Restart();
+		ProfilerZone $lua("Lua update_combo", ProfilerCounter::LuaTime);
 		lua_getglobal(m_lua, "update_combo");
 		lua_pushinteger(m_lua, newCombo);
 		if (lua_pcall(m_lua, 1, 0, 0) != 0)
@@ -2503,11 +2633,13 @@ public:
 
 	void OnScoreChanged()
 	{
+		ProfilerZone $("Game::OnScoreChanged");
 		uint32 score = m_scoring.CalculateCurrentDisplayScore();
 		if (m_renderFastGui)
 		{
 			m_fastGui.UpdateScore(score);
 		}
+		ProfilerZone $lua("Lua update_score", ProfilerCounter::LuaTime);
 		lua_getglobal(m_lua, "update_score");
 		lua_pushinteger(m_lua, score);
 		if (lua_pcall(m_lua, 1, 0, 0) != 0)
@@ -2619,6 +2751,7 @@ public:
 	}
 	void OnLaserAlertEntered(LaserObjectState* object)
 	{
+		ProfilerZone $("Game::OnLaserAlertEntered");
 		if (m_scoring.timeSinceLaserUsed[object->index] > 3.0f)
 		{
 			if (m_renderFastGui)
@@ -2626,6 +2759,7 @@ public:
 				m_fastGui.OnLaserAlert(object->index);
 			}
 			m_track->SendLaserAlert(object->index);
+			ProfilerZone $lua("Lua laser_alert", ProfilerCounter::LuaTime);
 			lua_getglobal(m_lua, "laser_alert");
 			lua_pushboolean(m_lua, object->index == 1);
 			if (lua_pcall(m_lua, 1, 0, 0) != 0)
@@ -2737,6 +2871,14 @@ public:
 		}
 		else if (code == SDL_SCANCODE_F12) {
 			//ReloadBackground();
+			if (Profiler::IsEnabled())
+			{
+				String tracePath = Path::Absolute(Utility::Sprintf("profile_%s.json", Shared::Time::Now().ToString("%Y%m%d-%H%M%S")));
+				if (Profiler::ExportChromeTrace(tracePath))
+					Logf("Exported profiler trace to \"%s\"", Logger::Severity::Info, tracePath);
+				else
+					Logf("Failed to export profiler trace to \"%s\"", Logger::Severity::Warning, tracePath);
+			}
 		}
 	}
 
@@ -2887,29 +3029,26 @@ public:
 		return Scoring::CalculateBadge(scoreData);
 	}
 
-	void m_setLuaHolds(lua_State* L)
+	// The tables are kept between frames and only their values are updated
+	void m_setLuaHolds(lua_State* L, const GameplayLuaKeys& keys, int table)
 	{
 		//button
-		lua_pushstring(L, "noteHeld");
-		lua_newtable(L);
+		keys.GetTable(table, GameplayLuaKey::noteHeld);
 		for (size_t i = 0; i < 6; i++)
 		{
-			lua_pushnumber(L, i + 1);
 			lua_pushboolean(L, m_scoring.IsObjectHeld(i));
-			lua_settable(L, -3);
+			lua_rawseti(L, -2, i + 1);
 		}
-		lua_settable(L, -3);
+		lua_pop(L, 1);
 
 		//laser
-		lua_pushstring(L, "laserActive");
-		lua_newtable(L);
+		keys.GetTable(table, GameplayLuaKey::laserActive);
 		for (size_t i = 0; i < 2; i++)
 		{
-			lua_pushnumber(L, i + 1);
 			lua_pushboolean(L, m_scoring.IsObjectHeld(6 + i));
-			lua_settable(L, -3);
+			lua_rawseti(L, -2, i + 1);
 		}
-		lua_settable(L, -3);
+		lua_pop(L, 1);
 	}
 
 	// Skips ahead to the right before the first object in the map
@@ -3936,51 +4075,50 @@ public:
 	}
 	void SetGameplayLua(lua_State* L) override
 	{
+		ProfilerZone $("Game::SetGameplayLua", ProfilerCounter::LuaTime);
 		Gauge* gauge = m_scoring.GetTopGauge();
 
 		if (gauge == nullptr) //if gauge is null, assume something is wrong
 			return;
 
+		// Called every frame, keys are interned and the tables created in SetInitialGameplayLua are reused
+		GameplayLuaKeys keys(L);
+
 		//set lua
 		lua_getglobal(L, "gameplay");
+		const int gameplay = lua_gettop(L);
 
 		//TODO(skade) move into mods table?
-		// audio vis spektrum, pushes 16 buckets
-		lua_getfield(L,-1,"spectrum");
-		for (size_t i = 0; i < 16; i++)
+		// audio vis spektrum, pushes one value per bucket
+		keys.GetTable(gameplay, GameplayLuaKey::spectrum);
+		for (size_t i = 0; i < m_spectrum.size(); i++)
 		{
-			lua_pushnumber(L, i + 1);
 			lua_pushnumber(L, m_spectrum[i]);
-			lua_settable(L, -3);
+			lua_rawseti(L, -2, i + 1);
 		}
-		lua_setfield(L, -1, "scoreReplays");
+		lua_pop(L, 1);
 
-		lua_getfield(L,-1,"spectrumN");
-		for (size_t i = 0; i < 16; i++)
+		keys.GetTable(gameplay, GameplayLuaKey::spectrumN);
+		for (size_t i = 0; i < m_spectrumN.size(); i++)
 		{
-			lua_pushnumber(L, i + 1);
 			lua_pushnumber(L, m_spectrumN[i]);
-			lua_settable(L, -3);
+			lua_rawseti(L, -2, i + 1);
 		}
-		lua_setfield(L, -1, "scoreReplays");
+		lua_pop(L, 1);
 
-		m_setLuaHolds(L);
+		m_setLuaHolds(L, keys, gameplay);
 
 		//set autoplay here as it's not set during the creation of the gameplay
-		lua_pushstring(L, "autoplay");
-		lua_pushboolean(L, m_scoring.autoplayInfo.autoplay);
-		lua_settable(L, -3);
+		keys.SetBoolean(gameplay, GameplayLuaKey::autoplay, m_scoring.autoplayInfo.autoplay);
 
 		if (m_isPracticeMode)
 		{
 			// Existence of this field implies that the game's in the practice mode.
-			lua_pushstring(L, "practice_setup");
-			lua_pushboolean(L, m_isPracticeSetup);
-			lua_settable(L, -3);
+			keys.SetBoolean(gameplay, GameplayLuaKey::practice_setup, m_isPracticeSetup);
 		}
 
 		// Update score replays
-		lua_getfield(L, -1, "scoreReplays");
+		keys.GetTable(gameplay, GameplayLuaKey::scoreReplays);
 		int replayCounter = 1;
 		int replayIndex = 0;
 		for (auto& replay: m_scoreReplays)
@@ -3990,149 +4128,99 @@ public:
 				replayIndex++;
 				continue;
 			}
-			lua_pushnumber(L, replayCounter);
-			lua_newtable(L);
+			if (lua_rawgeti(L, -1, replayCounter) != LUA_TTABLE)
+			{
+				lua_pop(L, 1);
+				lua_newtable(L);
+				lua_pushvalue(L, -1);
+				lua_rawseti(L, -3, replayCounter);
+			}
 
-			lua_pushstring(L, "maxScore");
 			if (ScoreIndex* s = replay->GetScoreIndex())
 			{
-				lua_pushnumber(L, replay->GetScoreIndex()->score);
+				keys.SetNumber(-1, GameplayLuaKey::maxScore, s->score);
 			}
 			else
 			{
-				lua_pushnumber(L, 10000000);
+				keys.SetNumber(-1, GameplayLuaKey::maxScore, 10000000);
 			}
-			lua_settable(L, -3);
-
-			lua_pushstring(L, "currentScore");
-			lua_pushnumber(L, m_scoring.CalculateCurrentDisplayScore(replay));
-			lua_settable(L, -3);
+			keys.SetNumber(-1, GameplayLuaKey::currentScore, m_scoring.CalculateCurrentDisplayScore(replay));
 
-			lua_settable(L, -3);
+			lua_pop(L, 1);
 			replayCounter++;
 			replayIndex++;
 		}
-		lua_setfield(L, -1, "scoreReplays");
+		// Remove entries of replays that are no longer shown
+		while (lua_rawgeti(L, -1, replayCounter) != LUA_TNIL)
+		{
+			lua_pop(L, 1);
+			lua_pushnil(L);
+			lua_rawseti(L, -2, replayCounter++);
+		}
+		lua_pop(L, 2);
 
 		// progress
-		m_LuaUpdateProgress(L);
+		m_LuaUpdateProgress(keys, gameplay);
 
 		// hispeed
-		lua_pushstring(L, "hispeed");
-		lua_pushnumber(L, m_hispeed);
-		lua_settable(L, -3);
+		keys.SetNumber(gameplay, GameplayLuaKey::hispeed, m_hispeed);
 		// hispeed adjustment
-		lua_pushstring(L, "hispeedAdjust");
-		lua_pushnumber(L, m_hispeedAdjustMode);
-		lua_settable(L, -3);
+		keys.SetNumber(gameplay, GameplayLuaKey::hispeedAdjust, m_hispeedAdjustMode);
 
 		// playback speed
-		lua_pushstring(L, "playbackSpeed");
-		lua_pushnumber(L, m_playOptions.playbackSpeed);
-		lua_settable(L, -3);
+		keys.SetNumber(gameplay, GameplayLuaKey::playbackSpeed, m_playOptions.playbackSpeed);
 		// bpm
-		lua_pushstring(L, "bpm");
-		lua_pushnumber(L, m_currentTiming->GetBPM());
-		lua_settable(L, -3);
+		keys.SetNumber(gameplay, GameplayLuaKey::bpm, m_currentTiming->GetBPM());
 		// gauge
 		{
-			Gauge* gauge = m_scoring.GetTopGauge();
-			lua_getfield(L, -1, "gauge");
-
-
-			lua_pushstring(L, "type");
-			lua_pushinteger(L, (uint32)gauge->GetType());
-			lua_settable(L, -3);
-
-			lua_pushstring(L, "options");
-			lua_pushinteger(L, gauge->GetOpts());
-			lua_settable(L, -3);
+			keys.GetTable(gameplay, GameplayLuaKey::gauge);
 
-			lua_pushstring(L, "value");
-			lua_pushnumber(L, gauge->GetValue());
-			lua_settable(L, -3);
-
-			lua_pushstring(L, "name");
-			lua_pushstring(L, gauge->GetName());
-			lua_settable(L, -3);
+			keys.SetInteger(-1, GameplayLuaKey::type, (uint32)gauge->GetType());
+			keys.SetInteger(-1, GameplayLuaKey::options, gauge->GetOpts());
+			keys.SetNumber(-1, GameplayLuaKey::value, gauge->GetValue());
+			keys.SetString(-1, GameplayLuaKey::name, gauge->GetName());
 
 			lua_pop(L, 1);
 		}
 		// combo state
-		lua_pushstring(L, "comboState");
-		lua_pushnumber(L, m_scoring.comboState);
-		lua_settable(L, -3);
+		keys.SetNumber(gameplay, GameplayLuaKey::comboState, m_scoring.comboState);
 
 		// hidden/sudden
-		lua_pushstring(L, "hiddenFade");
-		lua_pushnumber(L, m_track->hiddenFadewindow);
-		lua_settable(L, -3);
-
-		lua_pushstring(L, "hiddenCutoff");
-		lua_pushnumber(L, m_track->hiddenCutoff);
-		lua_settable(L, -3);
-
-		lua_pushstring(L, "suddenFade");
-		lua_pushnumber(L, m_track->suddenFadewindow);
-		lua_settable(L, -3);
-
-		lua_pushstring(L, "suddenCutoff");
-		lua_pushnumber(L, m_track->suddenCutoff);
-		lua_settable(L, -3);
+		keys.SetNumber(gameplay, GameplayLuaKey::hiddenFade, m_track->hiddenFadewindow);
+		keys.SetNumber(gameplay, GameplayLuaKey::hiddenCutoff, m_track->hiddenCutoff);
+		keys.SetNumber(gameplay, GameplayLuaKey::suddenFade, m_track->suddenFadewindow);
+		keys.SetNumber(gameplay, GameplayLuaKey::suddenCutoff, m_track->suddenCutoff);
 
 		// critLine
 		// When the game's paused, the critline's coordinates are messed up.
 		if(!m_paused)
 		{
-			lua_getfield(L, -1, "critLine");
+			keys.GetTable(gameplay, GameplayLuaKey::critLine);
 
 			Vector3 critPos = m_camera.Project3D(m_camera.critOrigin.TransformPoint(Vector3(0, 0, 0)));
 			Vector2 leftPos = m_camera.Project(m_camera.critOrigin.TransformPoint(Vector3(-m_track->trackWidth / 2.0, 0, 0)));
 			Vector2 rightPos = m_camera.Project(m_camera.critOrigin.TransformPoint(Vector3(m_track->trackWidth / 2.0, 0, 0)));
 			Vector2 line = rightPos - leftPos;
 
-			lua_pushstring(L, "x"); // x screen position
-			lua_pushnumber(L, critPos.x);
-			lua_settable(L, -3);
-
-			lua_pushstring(L, "y"); // y screen position
-			lua_pushnumber(L, critPos.y);
-			lua_settable(L, -3);
-
-			lua_pushstring(L, "z"); // y screen position
-			lua_pushnumber(L, critPos.z);
-			lua_settable(L, -3);
-
-			lua_pushstring(L, "rotation"); // rotation based on laser roll
-			lua_pushnumber(L, -atan2f(line.y, line.x));
-			lua_settable(L, -3);
-
-			lua_pushstring(L, "xOffset");
-			lua_pushnumber(L, -m_camera.GetCritLineRoll() * 360);
-			lua_settable(L, -3);
+			keys.SetNumber(-1, GameplayLuaKey::x, critPos.x); // x screen position
+			keys.SetNumber(-1, GameplayLuaKey::y, critPos.y); // y screen position
+			keys.SetNumber(-1, GameplayLuaKey::z, critPos.z);
+			keys.SetNumber(-1, GameplayLuaKey::rotation, -atan2f(line.y, line.x)); // rotation based on laser roll
+			keys.SetNumber(-1, GameplayLuaKey::xOffset, -m_camera.GetCritLineRoll() * 360);
 
 			//track x critline corners
-			lua_getfield(L, -1, "line");
+			keys.GetTable(-1, GameplayLuaKey::line);
 			{
-				lua_pushstring(L, "x1");
-				lua_pushnumber(L, leftPos.x);
-				lua_settable(L, -3);
-				lua_pushstring(L, "y1");
-				lua_pushnumber(L, leftPos.y);
-				lua_settable(L, -3);
-
-				lua_pushstring(L, "x2");
-				lua_pushnumber(L, rightPos.x);
-				lua_settable(L, -3);
-				lua_pushstring(L, "y2");
-				lua_pushnumber(L, rightPos.y);
-				lua_settable(L, -3);
+				keys.SetNumber(-1, GameplayLuaKey::x1, leftPos.x);
+				keys.SetNumber(-1, GameplayLuaKey::y1, leftPos.y);
+				keys.SetNumber(-1, GameplayLuaKey::x2, rightPos.x);
+				keys.SetNumber(-1, GameplayLuaKey::y2, rightPos.y);
 			}
 			lua_pop(L, 1);
 
 			auto setCursorData = [&](int ci)
 			{
-				lua_geti(L, -1, ci);
+				lua_rawgeti(L, -1, ci);
 
 #define TPOINT(name, y) Vector2 name = m_camera.Project(m_camera.critOrigin.TransformPoint(Vector3((m_scoring.laserPositions[ci] - Track::trackWidth * 0.5f) * (5.0f / 6), y, 0)))
 				TPOINT(cPos, 0);
@@ -4146,42 +4234,30 @@ public:
 				float skewAngle = -atan2f(cursorAngleVector.y, cursorAngleVector.x) + 3.1415 / 2;
 				float alpha = (1.0f - Math::Clamp<float>(m_scoring.timeSinceLaserUsed[ci] / 0.5f - 1.0f, 0, 1));
 
-				lua_pushstring(L, "pos");
-				lua_pushnumber(L, distFromCritCenter * (m_scoring.lasersAreExtend[ci] ? 2 : 1));
-				lua_settable(L, -3);
-
-				lua_pushstring(L, "alpha");
-				lua_pushnumber(L, alpha);
-				lua_settable(L, -3);
-
-				lua_pushstring(L, "skew");
-				lua_pushnumber(L, skewAngle);
-				lua_settable(L, -3);
+				keys.SetNumber(-1, GameplayLuaKey::pos, distFromCritCenter * (m_scoring.lasersAreExtend[ci] ? 2 : 1));
+				keys.SetNumber(-1, GameplayLuaKey::alpha, alpha);
+				keys.SetNumber(-1, GameplayLuaKey::skew, skewAngle);
 
 				lua_pop(L, 1);
 			};
 
-			lua_getfield(L, -1, "cursors");
+			keys.GetTable(-1, GameplayLuaKey::cursors);
 			setCursorData(0);
 			setCursorData(1);
 
 			lua_pop(L, 2); // cursors, critLine
 		}
 
-		lua_setglobal(L, "gameplay");
+		lua_pop(L, 1); // gameplay
 	}
 	void SetModsLua(lua_State* L) override {
+		ProfilerZone $("Game::SetModsLua", ProfilerCounter::LuaTime);
+		GameplayLuaKeys keys(L);
 		lua_getglobal(L,"mdv");
 		//TODO(skade) set variables for read
-		auto pushFloatToTable = [&](const char* name, float data)
-		{
-			lua_pushstring(L, name);
-			lua_pushnumber(L, data);
-			lua_settable(L, -3);
-		};
-		pushFloatToTable("gScale",g_scale);
-		pushFloatToTable("TRACK_H", m_track->trackLength);
-		lua_setglobal(L, "mdv");
+		keys.SetNumber(-1, GameplayLuaKey::gScale, g_scale);
+		keys.SetNumber(-1, GameplayLuaKey::TRACK_H, m_track->trackLength);
+		lua_pop(L, 1);
 	}
 	void SetInitialModsLua(lua_State* L) override {
 		lua_newtable(L);
@@ -4415,13 +4491,18 @@ public:
 		pushFloatToTable("hiddenCutoff", m_track->hiddenCutoff);
 		pushFloatToTable("suddenFade", m_track->suddenFadewindow);
 		pushFloatToTable("suddenCutoff", m_track->suddenCutoff);
-		m_setLuaHolds(L);
+		{
+			GameplayLuaKeys keys(L);
+			m_setLuaHolds(L, keys, -2);
+		}
 		
 		//TODO(skade) move into mods table?
-		// audio vis spektrum, pushes 16 buckets
+		// audio vis spektrum, pushes one value per bucket
+		pushIntToTable("spectrumWindowSize", g_audio->GetSpectrumAnalyzer().GetWindowSize());
+		pushIntToTable("spectrumBuckets", (int)m_spectrum.size());
 		lua_pushstring(L, "spectrum");
 		lua_newtable(L);
-		for (size_t i = 0; i < 16; i++) {
+		for (size_t i = 0; i < m_spectrum.size(); i++) {
 			lua_pushnumber(L, i + 1);
 			lua_pushnumber(L, 0.0f);
 			lua_settable(L, -3);
@@ -4430,7 +4511,7 @@ public:
 
 		lua_pushstring(L, "spectrumN");
 		lua_newtable(L);
-		for (size_t i = 0; i < 16; i++) {
+		for (size_t i = 0; i < m_spectrumN.size(); i++) {
 			lua_pushnumber(L, i + 1);
 			lua_pushnumber(L, 0.0f);
 			lua_settable(L, -3);
@@ -3,6 +3,7 @@
 
 #include "Shared/Log.hpp"
 #include "HitStat.hpp"
+#include <Audio/Resampler.hpp>
 
 // When this should change, the UpdateVersion MUST be updated to update the old config files.
 // If there's no need to update the UpdateVersion, there's no need to touch this too.
@@ -109,6 +110,7 @@ void GameConfig::InitDefaults()
 	Set(GameConfigKeys::PracticeLeadInTime, 1500);
 	Set(GameConfigKeys::AutoComputeSongOffset, false);
 	SetEnum<Enum_QualityLevel>(GameConfigKeys::ResponsiveInputs, QualityLevel::Off);
+	Set(GameConfigKeys::GameplayTickRate, 1000);
 	SetEnum<Enum_SongOffsetUpdateMethod>(GameConfigKeys::UpdateSongOffsetAfterFirstPlay, SongOffsetUpdateMethod::None);
 	SetEnum<Enum_SongOffsetUpdateMethod>(GameConfigKeys::UpdateSongOffsetAfterEveryPlay, SongOffsetUpdateMethod::None);
 
@@ -236,8 +238,13 @@ void GameConfig::InitDefaults()
 	Set(GameConfigKeys::EditorPath, "PathToEditor");
 	Set(GameConfigKeys::EditorParamsFormat, "%s");
 	Set(GameConfigKeys::WASAPI_Exclusive, false);
+	Set(GameConfigKeys::AudioBufferSize, 512); // Samples, 0 for the driver default
 	Set(GameConfigKeys::MuteUnfocused, false);
 	Set(GameConfigKeys::PrerenderEffects, false);
+	SetEnum<Enum_ResampleQuality>(GameConfigKeys::ResampleQuality, ResampleQuality::Medium);
+	Set(GameConfigKeys::AudioCacheSize, 0); // MB, 0 disables the cache
+	Set(GameConfigKeys::SpectrumWindowSize, 1024);
+	Set(GameConfigKeys::SpectrumBuckets, 16);
 
 	Set(GameConfigKeys::CheckForUpdates, true);
 	Set(GameConfigKeys::OnlyRelease, true); // deprecated
@@ -267,6 +274,7 @@ void GameConfig::InitDefaults()
 	Set(GameConfigKeys::GameplaySettingsDialogLastTab, 0);
 	Set(GameConfigKeys::SettingsLastTab, 0);
 	Set(GameConfigKeys::TransferScoresOnChartUpdate, true);
+	Set(GameConfigKeys::ChartFolderPollInterval, 60.0f);
 	Set(GameConfigKeys::FastGUI, false);
 	Set(GameConfigKeys::SkinDevMode, false);
 
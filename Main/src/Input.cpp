@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "Input.hpp"
 #include "GameConfig.hpp"
+#include <Shared/InputSampler.hpp>
 
 Input::~Input()
 {
@@ -126,6 +127,8 @@ void Input::Cleanup()
 
 void Input::Update(float deltaTime)
 {
+	m_ProcessSampledEvents();
+
 	for(auto it = m_mouseLocks.begin(); it != m_mouseLocks.end();)
 	{
 		if(it->use_count() == 1)
@@ -295,6 +298,11 @@ String Input::GetControllerStateString() const
 	return String();
 }
 
+void Input::SetSampler(InputSampler* sampler)
+{
+	m_sampler = sampler;
+}
+
 Ref<int32> Input::LockMouse()
 {
 	return m_mouseLocks.Add(MouseLockHandle(new int32(m_mouseLockIndex++)));
@@ -437,6 +445,33 @@ void Input::m_OnButtonInput(Button b, bool pressed, int32 delta)
 	}
 }
 
+void Input::m_ProcessSampledEvents()
+{
+	if (!m_sampler)
+		return;
+
+	const int64 now = InputClock::Now();
+	TimedInputEvent evt;
+	while (m_sampler->Pop(evt))
+	{
+		const int32 delta = InputClock::ToMilliseconds(now - evt.timestamp);
+		if (evt.device == (uint8)InputDevice::Keyboard)
+		{
+			if (evt.pressed)
+				OnKeyPressed(static_cast<SDL_Scancode>(evt.code), delta);
+			else
+				OnKeyReleased(static_cast<SDL_Scancode>(evt.code), delta);
+		}
+		else if (evt.device == (uint8)InputDevice::Controller)
+		{
+			if (evt.pressed)
+				m_OnGamepadButtonPressed((uint8)evt.code, delta);
+			else
+				m_OnGamepadButtonReleased((uint8)evt.code, delta);
+		}
+	}
+}
+
 void Input::m_OnGamepadButtonPressed(uint8 button, int32 delta)
 {
 	// Handle button mappings
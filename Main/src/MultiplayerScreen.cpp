@@ -1306,6 +1306,7 @@ bool MultiplayerScreen::AsyncLoad()
 	m_mapDatabase->OnDatabaseUpdateDone.Add(this, &MultiplayerScreen::m_onDatabaseUpdateDone);
 	m_mapDatabase->OnDatabaseUpdateProgress.Add(this, &MultiplayerScreen::m_onDatabaseUpdateProgress);
 	m_mapDatabase->SetChartUpdateBehavior(g_gameConfig.GetBool(GameConfigKeys::TransferScoresOnChartUpdate));
+	m_mapDatabase->SetWatchPollInterval(g_gameConfig.GetFloat(GameConfigKeys::ChartFolderPollInterval));
 	m_mapDatabase->FinishInit();
 
 	m_mapDatabase->AddSearchPath(g_gameConfig.GetString(GameConfigKeys::SongFolder));
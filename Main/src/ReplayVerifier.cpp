@@ -0,0 +1,259 @@
+#include "stdafx.h"
+#include "ReplayVerifier.hpp"
+#include "Replay.hpp"
+#include "Scoring.hpp"
+#include "Gauge.hpp"
+#include "GameConfig.hpp"
+#include <Beatmap/Beatmap.hpp>
+#include <Beatmap/BeatmapPlayback.hpp>
+#include <Beatmap/MapDatabase.hpp>
+#include <atomic>
+#include <iostream>
+
+// Time simulated after the last object so that all trailing ticks are judged
+static constexpr MapTime SIMULATION_TAIL = 2000;
+
+static Ref<Beatmap> LoadBeatmapForVerification(const String& path)
+{
+	Beatmap* beatmap = new Beatmap();
+	File mapFile;
+	if (!mapFile.OpenRead(path))
+	{
+		delete beatmap;
+		return Ref<Beatmap>();
+	}
+	FileReader reader(mapFile);
+	if (!beatmap->Load(reader))
+	{
+		delete beatmap;
+		return Ref<Beatmap>();
+	}
+	return Ref<Beatmap>(beatmap);
+}
+
+ReplayVerifyResult ReplayVerifier::Verify(const String& replayPath) const
+{
+	ReplayVerifyResult result;
+	result.replayPath = replayPath;
+
+	std::unique_ptr<Replay> replay(Replay::Load(replayPath));
+	if (!replay)
+	{
+		result.error = "Failed to load replay";
+		return result;
+	}
+
+	MapDatabase* database = &m_database;
+	ChartIndex* chart = replay->FindChart(&database);
+	if (!chart)
+	{
+		result.error = "Could not find a matching chart";
+		return result;
+	}
+
+	Ref<Beatmap> beatmap = LoadBeatmapForVerification(Path::Normalize(chart->path));
+	if (!beatmap)
+	{
+		result.error = "Failed to load chart";
+		return result;
+	}
+
+	PlaybackOptions options;
+	const ReplayScoreInfo& scoreInfo = replay->GetScoreInfo();
+	if (scoreInfo.IsInitialized())
+	{
+		options.gaugeType = scoreInfo.gaugeType;
+		options.gaugeOption = scoreInfo.gaugeOption;
+		options.mirror = scoreInfo.mirror;
+	}
+
+	// Random is not stored in replays, mirror is deterministic
+	if (options.mirror)
+		beatmap->Shuffle(0, false, true);
+
+	replay->InitializePlayback();
+
+	// Same initialization order as Game_Impl::InitGameplay and Game_Impl::AsyncFinalize
+	BeatmapPlayback playback(*beatmap);
+	if (!playback.Reset())
+	{
+		result.error = "Chart contains no objects";
+		return result;
+	}
+
+	Scoring scoring(false);
+	playback.hittableObjectEnter = scoring.hitWindow.miss + g_gameConfig.GetInt(GameConfigKeys::InputOffset);
+	playback.hittableObjectLeave = scoring.hitWindow.good;
+
+	const MapTime endTime = beatmap->GetLastObjectTime();
+	scoring.SetReplayForPlayback(replay.get());
+	scoring.SetOptions(options);
+	scoring.SetPlayback(playback);
+	scoring.SetEndTime(endTime);
+	scoring.Reset();
+	scoring.SetHitWindow(replay->GetHitWindow());
+
+	const MapTime startTime = std::min<MapTime>(0,
+		beatmap->GetFirstObjectTime(0) - g_gameConfig.GetInt(GameConfigKeys::LeadInTime));
+	playback.Reset(startTime);
+
+	// Synthetic clock, advances as fast as the simulation allows
+	const MapTime step = std::max<MapTime>(1, stepSize);
+	const float stepSeconds = step / 1000.0f;
+	for (MapTime time = startTime; time <= endTime + SIMULATION_TAIL; time += step)
+	{
+		playback.Update(time, 0);
+		scoring.Tick(stepSeconds);
+
+		if (scoring.IsFailOut())
+			break;
+	}
+	scoring.FinishGame();
+
+	Gauge* gauge = scoring.GetTopGauge();
+	ScoreIndex scoreData;
+	scoreData.miss = scoring.categorizedHits[0];
+	scoreData.almost = scoring.categorizedHits[1];
+	scoreData.crit = scoring.categorizedHits[2];
+	scoreData.combo = scoring.maxComboCounter;
+	scoreData.score = scoring.CalculateCurrentScore();
+	scoreData.gaugeType = gauge ? gauge->GetType() : options.gaugeType;
+	scoreData.gaugeOption = gauge ? gauge->GetOpts() : options.gaugeOption;
+	scoreData.gauge = gauge ? gauge->GetValue() : 0.0f;
+	scoreData.mirror = options.mirror;
+
+	result.score = scoreData.score;
+	result.crit = scoreData.crit;
+	result.almost = scoreData.almost;
+	result.miss = scoreData.miss;
+	result.maxCombo = scoreData.combo;
+	result.gauge = scoreData.gauge;
+	result.gaugeType = scoreData.gaugeType;
+	result.clearMark = Scoring::CalculateBadge(scoreData);
+
+	if (scoreInfo.IsInitialized())
+	{
+		result.hasRecordedScore = true;
+		result.matchesRecordedScore = scoreInfo.score == static_cast<int32>(result.score);
+	}
+
+	result.success = true;
+	return result;
+}
+
+Vector<ReplayVerifyResult> ReplayVerifier::VerifyAll(const Vector<String>& replayPaths, uint32 numThreads) const
+{
+	Vector<ReplayVerifyResult> results;
+	results.resize(replayPaths.size());
+
+	if (numThreads == 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	numThreads = std::min<uint32>(numThreads, static_cast<uint32>(replayPaths.size()));
+
+	// Every worker pulls the next unprocessed replay, so slow charts don't stall the other threads
+	std::atomic<size_t> nextIndex(0);
+	auto worker = [&]()
+	{
+		for (size_t i = nextIndex++; i < replayPaths.size(); i = nextIndex++)
+			results[i] = Verify(replayPaths[i]);
+	};
+
+	Vector<Thread> threads;
+	for (uint32 i = 1; i < numThreads; i++)
+		threads.emplace_back(worker);
+	worker();
+	for (Thread& t : threads)
+		t.join();
+
+	return results;
+}
+
+static const char* ClearMarkToString(ClearMark mark)
+{
+	switch (mark)
+	{
+	case ClearMark::Played: return "Played";
+	case ClearMark::NormalClear: return "NormalClear";
+	case ClearMark::HardClear: return "HardClear";
+	case ClearMark::FullCombo: return "FullCombo";
+	case ClearMark::Perfect: return "Perfect";
+	default: return "NotPlayed";
+	}
+}
+
+int32 ReplayVerifier::RunFromCommandLine(const Vector<String>& commandLine)
+{
+	uint32 numThreads = 0;
+	MapTime stepSize = 4;
+	Vector<String> replayPaths;
+
+	// Skip the executable path
+	for (size_t i = 1; i < commandLine.size(); i++)
+	{
+		const String& cl = commandLine[i];
+		String k, v;
+		if (cl.Split("=", &k, &v))
+		{
+			if (k == "-threads")
+				numThreads = atol(*v);
+			else if (k == "-step")
+				stepSize = atol(*v);
+			continue;
+		}
+		if (cl.front() == '-')
+			continue;
+
+		if (Path::IsDirectory(cl))
+		{
+			for (const FileInfo& fi : Files::ScanFilesRecursive(cl, "urf"))
+				replayPaths.Add(fi.fullPath);
+		}
+		else
+		{
+			replayPaths.Add(cl);
+		}
+	}
+
+	if (replayPaths.empty())
+	{
+		std::cerr << "Usage: -verifyreplays [-threads=N] [-step=ms] <replay.urf|folder>..." << std::endl;
+		return 1;
+	}
+
+	MapDatabase database(true);
+	database.SetChartUpdateBehavior(g_gameConfig.GetBool(GameConfigKeys::TransferScoresOnChartUpdate));
+	database.FinishInit();
+	database.LoadDatabaseWithoutSearching();
+
+	ReplayVerifier verifier(database);
+	verifier.stepSize = stepSize;
+
+	Timer timer;
+	Vector<ReplayVerifyResult> results = verifier.VerifyAll(replayPaths, numThreads);
+	const double seconds = timer.SecondsAsDouble();
+
+	uint32 numFailed = 0;
+	uint32 numMismatched = 0;
+	for (const ReplayVerifyResult& r : results)
+	{
+		if (!r.success)
+		{
+			numFailed++;
+			std::cout << r.replayPath << "\tERROR\t" << r.error << std::endl;
+			continue;
+		}
+		if (r.hasRecordedScore && !r.matchesRecordedScore)
+			numMismatched++;
+
+		const char* status = !r.hasRecordedScore ? "UNKNOWN" : (r.matchesRecordedScore ? "OK" : "MISMATCH");
+		std::cout << Utility::Sprintf("%s\t%s\t%u\t%.3f\t%s\t%u\t%u\t%u\t%u",
+			r.replayPath, status, r.score, r.gauge, ClearMarkToString(r.clearMark),
+			r.crit, r.almost, r.miss, r.maxCombo) << std::endl;
+	}
+
+	std::cout << Utility::Sprintf("Verified %u replays in %.3fs (%.1f replays/sec), %u failed, %u mismatched",
+		(uint32)results.size(), seconds, seconds > 0.0 ? results.size() / seconds : 0.0,
+		numFailed, numMismatched) << std::endl;
+
+	return (numFailed > 0 || numMismatched > 0) ? 1 : 0;
+}
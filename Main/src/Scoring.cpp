@@ -5,14 +5,16 @@
 #include "GameConfig.hpp"
 #include "Gauge.hpp"
 
-Scoring::Scoring()
+Scoring::Scoring(bool registerAutoplayInfo) : m_registerAutoplayInfo(registerAutoplayInfo)
 {
-	g_application->autoplayInfo = &autoplayInfo;
+	if (m_registerAutoplayInfo)
+		g_application->autoplayInfo = &autoplayInfo;
 }
 
 Scoring::~Scoring()
 {
-	g_application->autoplayInfo = nullptr;
+	if (m_registerAutoplayInfo)
+		g_application->autoplayInfo = nullptr;
 	m_CleanupInput();
 	m_CleanupHitStats();
 	m_CleanupTicks();
@@ -329,11 +331,11 @@ void Scoring::Tick(float deltaTime)
 					if (autoplayHold)
 						m_SetHoldObject(tick->object, i);
 					// This check is only relevant if delay fade hit effects are on
-					if (autoplayHold || (HoldObjectAvailable(i, true) && m_input->GetButton((Input::Button)i)))
+					if (autoplayHold || (m_input && HoldObjectAvailable(i, true) && m_input->GetButton((Input::Button)i)))
 						OnHoldEnter.Call(static_cast<Input::Button>(i));
 
 				}
-				else if (HoldObjectAvailable(i, true) && m_input->GetButton((Input::Button)i))
+				else if (m_input && HoldObjectAvailable(i, true) && m_input->GetButton((Input::Button)i))
 				{
 						OnHoldEnter.Call(static_cast<Input::Button>(i));
 				}
@@ -1052,7 +1054,7 @@ void Scoring::m_UpdateTicks()
 					{
 						// Check if slam hit
 						float dirSign = Math::Sign(laserObject->GetDirection());
-						float inputSign = Math::Sign(m_input->GetInputLaserDir(buttonCode - 6));
+						float inputSign = m_input ? Math::Sign(m_input->GetInputLaserDir(buttonCode - 6)) : 0.0f;
 
 						if (autoplayInfo.autoplay || (dirSign == inputSign && delta <= hitWindow.slam / 2)
 							|| tick->HasFlag(TickFlags::Processed))
@@ -1104,7 +1106,7 @@ void Scoring::m_UpdateTicks()
 			{
 				auto* laserObject = (LaserObjectState*)tick->object;
 				float dirSign = Math::Sign(laserObject->GetDirection());
-				float inputSign = Math::Sign(m_input->GetInputLaserDir(buttonCode - 6));
+				float inputSign = m_input ? Math::Sign(m_input->GetInputLaserDir(buttonCode - 6)) : 0.0f;
 				if (dirSign == inputSign && std::abs(delta) <= hitWindow.slam / 2)
 					tick->SetFlag(TickFlags::Processed);
 			}
@@ -1603,7 +1605,7 @@ void Scoring::m_UpdateLasers(float deltaTime)
 			}
 		}
 
-		m_laserInput[i] = (autoplayInfo.autoplay || m_replay != nullptr) ? 0.0f : m_input->GetInputLaserDir(i);
+		m_laserInput[i] = (autoplayInfo.autoplay || m_replay != nullptr || !m_input) ? 0.0f : m_input->GetInputLaserDir(i) * m_laserInputScale;
 		float inputDir = Math::Sign(m_laserInput[i]);
 
 		if (currentSegment)
@@ -7,6 +7,7 @@
 #include "SettingsPage.hpp"
 #include "SkinConfig.hpp"
 #include "TransitionScreen.hpp"
+#include <Audio/Audio.hpp>
 
 static inline const char* GetKeyNameFromScancodeConfig(int scancode)
 {
@@ -729,7 +730,12 @@ protected:
 #ifdef _WIN32
 		ToggleSetting(GameConfigKeys::WASAPI_Exclusive, "WASAPI exclusive mode (requires restart)");
 #endif // _WIN32
+		IntSetting(GameConfigKeys::AudioBufferSize, "Audio buffer size in samples (requires restart):", 0, 4096, 64);
 		ToggleSetting(GameConfigKeys::PrerenderEffects, "Pre-render song effects (experimental)");
+		if (EnumSetting<Enum_ResampleQuality>(GameConfigKeys::ResampleQuality, "Resampling quality:"))
+			g_audio->SetResampleQuality(g_gameConfig.GetEnum<Enum_ResampleQuality>(GameConfigKeys::ResampleQuality));
+		if (IntSetting(GameConfigKeys::AudioCacheSize, "Decoded audio cache size (MB):", 0, 16384, 256))
+			g_application->OpenAudioCache();
 
 		SectionHeader("Lights");
 		const bool currentUseLight = g_gameConfig.GetBool(GameConfigKeys::UseLightPlugins);
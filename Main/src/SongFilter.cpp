@@ -1,21 +1,33 @@
 #include "stdafx.h"
 #include "SongFilter.hpp"
+#include <algorithm>
 
-Map<int32, SongSelectIndex> LevelFilter::GetFiltered(const Map<int32, SongSelectIndex>& source)
+void LevelFilter::GetFilteredIds(const Map<int32, SongSelectIndex>& source, Vector<int32>& out)
 {
-	Map<int32, SongSelectIndex> filtered;
-	for (auto kvp : source)
+	out.clear();
+	for (auto& kvp : source)
 	{
-		for (auto chart: kvp.second.GetCharts())
+		for (auto chart : kvp.second.GetCharts())
 		{
 			if (chart->level == m_level)
 			{
-				SongSelectIndex index(kvp.second.GetFolder(), chart);
-				filtered.Add(index.id, index);
+				out.Add(kvp.first);
+				break;
 			}
 		}
 	}
-	return filtered;
+}
+
+void LevelFilter::AddFilteredItems(const SongSelectIndex& item, Map<int32, SongSelectIndex>& out) const
+{
+	for (auto chart : item.GetCharts())
+	{
+		if (chart->level == m_level)
+		{
+			SongSelectIndex index(item.GetFolder(), chart);
+			out.Add(index.id, index);
+		}
+	}
 }
 
 String LevelFilter::GetName() const
@@ -28,17 +40,15 @@ bool LevelFilter::IsAll() const
 	return false;
 }
 
-Map<int32, SongSelectIndex> FolderFilter::GetFiltered(const Map<int32, SongSelectIndex>& source)
+void FolderFilter::GetFilteredIds(const Map<int32, SongSelectIndex>& source, Vector<int32>& out)
 {
 	Map<int32, FolderIndex*> folders = m_mapDatabase->FindFoldersByFolder(m_folder);
 
-	Map<int32, SongSelectIndex> filtered;
-	for (auto m : folders)
-	{
-		SongSelectIndex index(m.second);
-		filtered.Add(index.id, index);
-	}
-	return filtered;
+	out.clear();
+	out.reserve(folders.size());
+	for (auto& m : folders)
+		out.Add(SongSelectIndex(m.second).id);
+	std::sort(out.begin(), out.end());
 }
 
 String FolderFilter::GetName() const
@@ -51,17 +61,15 @@ bool FolderFilter::IsAll() const
 	return false;
 }
 
-Map<int32, SongSelectIndex> CollectionFilter::GetFiltered(const Map<int32, SongSelectIndex>& source)
+void CollectionFilter::GetFilteredIds(const Map<int32, SongSelectIndex>& source, Vector<int32>& out)
 {
 	Map<int32, FolderIndex*> folders = m_mapDatabase->FindFoldersByCollection(m_collection);
 
-	Map<int32, SongSelectIndex> filtered;
-	for (auto m : folders)
-	{
-		SongSelectIndex index(m.second);
-		filtered.Add(index.id, index);
-	}
-	return filtered;
+	out.clear();
+	out.reserve(folders.size());
+	for (auto& m : folders)
+		out.Add(SongSelectIndex(m.second).id);
+	std::sort(out.begin(), out.end());
 }
 
 String CollectionFilter::GetName() const
@@ -74,19 +82,19 @@ bool CollectionFilter::IsAll() const
 	return false;
 }
 
-Map<int32, ChallengeSelectIndex> ChallengeLevelFilter::GetFiltered(const Map<int32, ChallengeSelectIndex>& source)
+uint32 CollectionFilter::GetVersion() const
+{
+	return m_mapDatabase->GetCollectionsVersion();
+}
+
+void ChallengeLevelFilter::GetFilteredIds(const Map<int32, ChallengeSelectIndex>& source, Vector<int32>& out)
 {
-	Map<int32, ChallengeSelectIndex> filtered;
-	for (auto kvp : source)
+	out.clear();
+	for (auto& kvp : source)
 	{
-		const auto& chal = kvp.second.GetChallenge();
-		if (chal->level == m_level)
-		{
-			ChallengeSelectIndex index(chal);
-			filtered.Add(index.id, index);
-		}
+		if (kvp.second.GetChallenge()->level == m_level)
+			out.Add(kvp.first);
 	}
-	return filtered;
 }
 
 String ChallengeLevelFilter::GetName() const
@@ -3,6 +3,7 @@
 #include "TitleScreen.hpp"
 #include "Application.hpp"
 #include <Shared/Profiling.hpp>
+#include <Shared/LuaLazyList.hpp>
 #include "Scoring.hpp"
 #include "Input.hpp"
 #include "Game.hpp"
@@ -137,6 +138,12 @@ class SelectionWheel : public SongItemSelectionWheel
 	// Current difficulty index
 	int32 m_currentlySelectedDiff = 0;
 
+	// songwheel.songs and songwheel.allSongs
+	std::unique_ptr<LuaLazyList> m_luaSongs;
+	std::unique_ptr<LuaLazyList> m_luaAllSongs;
+	// Order of songwheel.allSongs
+	Vector<int32> m_allSongIds;
+
 public:
 	SelectionWheel(IApplicationTickable* owner) : SongItemSelectionWheel(owner)
 	{
@@ -146,6 +153,8 @@ public:
 	{
 		SongItemSelectionWheel::Init();
 		CheckedLoad(m_lua = g_application->LoadScript("songselect/songwheel"));
+		m_luaSongs = std::make_unique<LuaLazyList>(m_lua);
+		m_luaAllSongs = std::make_unique<LuaLazyList>(m_lua);
 		lua_newtable(m_lua);
 		{
 			//text
@@ -187,6 +196,9 @@ public:
 	virtual ~SelectionWheel()
 	{
 		g_gameConfig.Set(GameConfigKeys::LastSelected, m_currentlySelectedItemId);
+		// The lists keep their cache in the lua state
+		m_luaSongs.reset();
+		m_luaAllSongs.reset();
 		if (m_lua)
 			g_application->DisposeLua(m_lua);
 	}
@@ -382,92 +394,114 @@ private:
 		}
 	}
 
+	// Song tables are created when the script indexes them, so changing the filter or sort of a large collection is O(1)
 	void m_SetLuaMaps(const char *key, const Map<int32, SongSelectIndex> &collection, bool sorted)
 	{
-		lua_getglobal(m_lua, "songwheel");
-		lua_pushstring(m_lua, key);
-		lua_newtable(m_lua);
-		int songIndex = 0;
-
-
+		LuaLazyList& list = sorted ? *m_luaSongs : *m_luaAllSongs;
 		if (sorted)
 		{
 			// sortVec should only have the current maps in the collection
-			for (auto& mapIndex : m_sortVec)
+			list.Set(m_sortVec.size(), [this, &collection](lua_State* L, size_t index)
 			{
-				// Grab the song for this sort index
-				SongSelectIndex song = collection.find(mapIndex)->second;
-				m_PushSongToLua(song, ++songIndex);
-			}
+				auto it = index < m_sortVec.size() ? collection.find(m_sortVec[index]) : collection.end();
+				if (it == collection.end())
+					lua_pushnil(L);
+				else
+					m_PushSongToLua(L, it->second);
+			});
 		}
-		else {
-
+		else
+		{
+			m_allSongIds.clear();
+			m_allSongIds.reserve(collection.size());
 			for (auto& song : collection)
+				m_allSongIds.Add(song.first);
+
+			list.Set(m_allSongIds.size(), [this, &collection](lua_State* L, size_t index)
 			{
-				m_PushSongToLua(song.second, ++songIndex);
-			}
+				auto it = collection.find(m_allSongIds[index]);
+				if (it == collection.end())
+					lua_pushnil(L);
+				else
+					m_PushSongToLua(L, it->second);
+			});
 		}
+
+		lua_getglobal(m_lua, "songwheel");
+		lua_pushstring(m_lua, key);
+		list.Push();
 		lua_settable(m_lua, -3);
 		lua_setglobal(m_lua, "songwheel");
 	}
 
-	void m_PushSongToLua(SongSelectIndex song, int index)
+	// Pushes a new song table onto the stack of L, which may be a coroutine of m_lua
+	void m_PushSongToLua(lua_State* L, const SongSelectIndex& song)
 	{
-		lua_pushinteger(m_lua, index);
-		lua_newtable(m_lua);
-		m_PushStringToTable("title", song.GetCharts()[0]->title.c_str());
-		m_PushStringToTable("artist", song.GetCharts()[0]->artist.c_str());
-		m_PushStringToTable("bpm", song.GetCharts()[0]->bpm.c_str());
-		m_PushIntToTable("id", song.GetFolder()->id);
-		m_PushStringToTable("path", song.GetFolder()->path.c_str());
+		auto pushStringToTable = [L](const char* name, const char* data)
+		{
+			lua_pushstring(L, data);
+			lua_setfield(L, -2, name);
+		};
+		auto pushIntToTable = [L](const char* name, int data)
+		{
+			lua_pushinteger(L, data);
+			lua_setfield(L, -2, name);
+		};
+		auto pushFloatToTable = [L](const char* name, float data)
+		{
+			lua_pushnumber(L, data);
+			lua_setfield(L, -2, name);
+		};
+
+		lua_newtable(L);
+		pushStringToTable("title", song.GetCharts()[0]->title.c_str());
+		pushStringToTable("artist", song.GetCharts()[0]->artist.c_str());
+		pushStringToTable("bpm", song.GetCharts()[0]->bpm.c_str());
+		pushIntToTable("id", song.GetFolder()->id);
+		pushStringToTable("path", song.GetFolder()->path.c_str());
 		int diffIndex = 0;
-		lua_pushstring(m_lua, "difficulties");
-		lua_newtable(m_lua);
+		lua_createtable(L, (int)song.GetCharts().size(), 0);
 		for (auto diff : song.GetCharts())
 		{
-			lua_pushinteger(m_lua, ++diffIndex);
-			lua_newtable(m_lua);
-			m_PushStringToTable("jacketPath", Path::Normalize(song.GetFolder()->path + "/" + diff->jacket_path).c_str());
-			m_PushIntToTable("level", diff->level);
-			m_PushIntToTable("difficulty", diff->diff_index);
-			m_PushIntToTable("id", diff->id);
-			m_PushStringToTable("hash", diff->hash.c_str());
-			m_PushStringToTable("effector", diff->effector.c_str());
-			m_PushStringToTable("illustrator", diff->illustrator.c_str());
-			m_PushIntToTable("topBadge", static_cast<int>(Scoring::CalculateBestBadge(diff->scores)));
-			lua_pushstring(m_lua, "scores");
-			lua_newtable(m_lua);
+			lua_newtable(L);
+			pushStringToTable("jacketPath", Path::Normalize(song.GetFolder()->path + "/" + diff->jacket_path).c_str());
+			pushIntToTable("level", diff->level);
+			pushIntToTable("difficulty", diff->diff_index);
+			pushIntToTable("id", diff->id);
+			pushStringToTable("hash", diff->hash.c_str());
+			pushStringToTable("effector", diff->effector.c_str());
+			pushStringToTable("illustrator", diff->illustrator.c_str());
+			pushIntToTable("topBadge", static_cast<int>(Scoring::CalculateBestBadge(diff->scores)));
 			int scoreIndex = 0;
+			lua_createtable(L, (int)diff->scores.size(), 0);
 			for (auto& score : diff->scores)
 			{
-				lua_pushinteger(m_lua, ++scoreIndex);
-				lua_newtable(m_lua);
-				m_PushFloatToTable("gauge", score->gauge);
-
-				m_PushIntToTable("gauge_type", (uint32)score->gaugeType);
-				m_PushIntToTable("gauge_option", score->gaugeOption);
-				m_PushIntToTable("random", score->random);
-				m_PushIntToTable("mirror", score->mirror);
-				m_PushIntToTable("auto_flags", (uint32)score->autoFlags);
-
-				m_PushIntToTable("score", score->score);
-				m_PushIntToTable("perfects", score->crit);
-				m_PushIntToTable("goods", score->almost);
-				m_PushIntToTable("earlies", score->early);
-				m_PushIntToTable("lates", score->late);
-				m_PushIntToTable("combo", score->combo);
-				m_PushIntToTable("misses", score->miss);
-				m_PushIntToTable("timestamp", score->timestamp);
-				m_PushStringToTable("playerName", *score->userName);
-				m_PushIntToTable("isLocal", score->localScore);
-				m_PushIntToTable("badge", static_cast<int>(Scoring::CalculateBadge(*score)));
-				lua_settable(m_lua, -3);
+				lua_newtable(L);
+				pushFloatToTable("gauge", score->gauge);
+
+				pushIntToTable("gauge_type", (uint32)score->gaugeType);
+				pushIntToTable("gauge_option", score->gaugeOption);
+				pushIntToTable("random", score->random);
+				pushIntToTable("mirror", score->mirror);
+				pushIntToTable("auto_flags", (uint32)score->autoFlags);
+
+				pushIntToTable("score", score->score);
+				pushIntToTable("perfects", score->crit);
+				pushIntToTable("goods", score->almost);
+				pushIntToTable("earlies", score->early);
+				pushIntToTable("lates", score->late);
+				pushIntToTable("combo", score->combo);
+				pushIntToTable("misses", score->miss);
+				pushIntToTable("timestamp", score->timestamp);
+				pushStringToTable("playerName", *score->userName);
+				pushIntToTable("isLocal", score->localScore);
+				pushIntToTable("badge", static_cast<int>(Scoring::CalculateBadge(*score)));
+				lua_rawseti(L, -2, ++scoreIndex);
 			}
-			lua_settable(m_lua, -3);
-			lua_settable(m_lua, -3);
+			lua_setfield(L, -2, "scores");
+			lua_rawseti(L, -2, ++diffIndex);
 		}
-		lua_settable(m_lua, -3);
-		lua_settable(m_lua, -3);
+		lua_setfield(L, -2, "difficulties");
 	}
 
 	void m_OnItemSelected(SongSelectIndex index) override
@@ -677,7 +711,9 @@ public:
 			if (m_folders.find(p) == m_folders.end())
 			{
 				FolderFilter *filter = new FolderFilter(p, m_mapDB);
-				if (filter->GetFiltered(Map<int32, SongSelectIndex>()).size() > 0)
+				Vector<int32> folderIds;
+				filter->GetFilteredIds(Map<int32, SongSelectIndex>(), folderIds);
+				if (folderIds.size() > 0)
 				{
 					AddFilter(filter, FilterType::Folder);
 					m_folders.insert(p);
@@ -990,6 +1026,7 @@ public:
 		m_mapDatabase->OnDatabaseUpdateDone.Add(this, &SongSelect_Impl::m_onDatabaseUpdateDone);
 		m_mapDatabase->OnDatabaseUpdateProgress.Add(this, &SongSelect_Impl::m_onDatabaseUpdateProgress);
 		m_mapDatabase->SetChartUpdateBehavior(g_gameConfig.GetBool(GameConfigKeys::TransferScoresOnChartUpdate));
+		m_mapDatabase->SetWatchPollInterval(g_gameConfig.GetFloat(GameConfigKeys::ChartFolderPollInterval));
 		m_mapDatabase->FinishInit();
 
 		// Setup the map database
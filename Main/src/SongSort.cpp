@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "SongSort.hpp"
 #include "Shared/Profiling.hpp"
+#include "Shared/SortKey.hpp"
 
 const SongSelectIndex& getSongFromCollection(uint32 index, const Map<int32,
 	SongSelectIndex>& collection)
@@ -13,28 +14,48 @@ const SongSelectIndex& getSongFromCollection(uint32 index, const Map<int32,
 	return it->second;
 }
 
+namespace
+{
+	// Sorts by value, then by key, the direction only applies to these unless reverseTies is set. Ties are ordered by title and id
+	template<typename GetEntry>
+	void SortSongs(Vector<uint32>& vec, const Map<int32, SongSelectIndex>& collection, bool descending, GetEntry&& getEntry, bool reverseTies = false)
+	{
+		Vector<SortKey::Entry> entries;
+		entries.reserve(vec.size());
+		for (uint32 id : vec)
+		{
+			SortKey::Entry entry = getEntry(getSongFromCollection(id, collection));
+			entry.id = id;
+			entries.Add(entry);
+		}
+
+		SortKey::Sort(entries, descending, reverseTies);
+
+		for (size_t i = 0; i < entries.size(); i++)
+			vec[i] = entries[i].id;
+	}
+
+	SortKey::Entry MakeEntry(const SongSelectIndex& song, uint64 value, const String* key = nullptr)
+	{
+		return { value, key, &song.GetCharts()[0]->title_sortkey, 0 };
+	}
+}
+
 void TitleSort::SortInplace(Vector<uint32>& vec, const Map<int32, 
 		SongSelectIndex>& collection)
 {
 	ProfilerScope $(Utility::Sprintf("Sort by: %s", m_name));
-	std::sort (vec.begin(), vec.end(),
-		[&](uint32 a, uint32 b) -> bool
+	// Descending is the exact reverse of ascending, songs with the same title included
+	SortSongs(vec, collection, m_dir, [](const SongSelectIndex& song)
 	{
-		const SongSelectIndex& song_a = getSongFromCollection(a, collection);
-		const SongSelectIndex& song_b = getSongFromCollection(b, collection);
-		bool res = CompareSongs(song_a, song_b);
-		return m_dir ? !res : res;
-	});
+		return MakeEntry(song, 0, &song.GetCharts()[0]->title_sortkey);
+	}, true);
 }
 
 bool TitleSort::CompareSongs(const SongSelectIndex& song_a,
 		const SongSelectIndex& song_b)
 {
-	String a = song_a.GetCharts()[0]->title;
-	String b = song_b.GetCharts()[0]->title;
-	a.ToUpper();
-	b.ToUpper();
-	int strres = a.compare(b);
+	int strres = song_a.GetCharts()[0]->title_sortkey.compare(song_b.GetCharts()[0]->title_sortkey);
 	if (strres == 0)
 		return song_a.id < song_b.id;
 	return strres < 0;
@@ -44,10 +65,9 @@ void ScoreSort::SortInplace(Vector<uint32>& vec, const Map<int32,
 		SongSelectIndex>& collection)
 {
 	ProfilerScope $(Utility::Sprintf("Sort by: %s", m_name));
-	m_scoreMap.clear();
-	for (uint32 mapIndex : vec)
+	// For same scores sort by title
+	SortSongs(vec, collection, m_dir, [](const SongSelectIndex& song)
 	{
-		const SongSelectIndex& song = getSongFromCollection(mapIndex, collection);
 		uint32 maxScore = 0;
 		for (auto& diff : song.GetCharts())
 		{
@@ -58,37 +78,17 @@ void ScoreSort::SortInplace(Vector<uint32>& vec, const Map<int32,
 				maxScore = score->score;
 			}
 		}
-		m_scoreMap[mapIndex] = maxScore;
-	}
-
-	std::sort (vec.begin(), vec.end(),
-		[&](uint32 a, uint32 b) -> bool
-	{
-		const uint32 score_a = m_scoreMap.find(a)->second;
-		const uint32 score_b = m_scoreMap.find(b)->second;
-
-		// For same scores sort by title
-		if (score_a == score_b) {
-			const SongSelectIndex& song_a = getSongFromCollection(a, collection);
-			const SongSelectIndex& song_b = getSongFromCollection(b, collection);
-			bool res = CompareSongs(song_a, song_b);
-			return res;
-		}
-		bool res = score_a < score_b;
-		return m_dir ? !res : res;
+		return MakeEntry(song, maxScore);
 	});
-
-	m_scoreMap.clear();
 }
 
 void DateSort::SortInplace(Vector<uint32>& vec, const Map<int32, 
 		SongSelectIndex>& collection)
 {
 	ProfilerScope $(Utility::Sprintf("Sort by: %s", m_name));
-	m_dateMap.clear();
-	for (uint32 mapIndex : vec)
+	// For same dates sort by title
+	SortSongs(vec, collection, m_dir, [](const SongSelectIndex& song)
 	{
-		const SongSelectIndex& song = getSongFromCollection(mapIndex, collection);
 		uint64 maxDate = 0;
 		for (auto& diff : song.GetCharts())
 		{
@@ -96,70 +96,27 @@ void DateSort::SortInplace(Vector<uint32>& vec, const Map<int32,
 				continue;
 			maxDate = diff->lwt;
 		}
-		m_dateMap[mapIndex] = maxDate;
-	}
-
-	std::sort (vec.begin(), vec.end(),
-		[&](uint32 a, uint32 b) -> bool
-	{
-		const uint64 date_a = m_dateMap.find(a)->second;
-		const uint64 date_b = m_dateMap.find(b)->second;
-
-		// For same scores sort by title
-		if (date_a == date_b) {
-			const SongSelectIndex& song_a = getSongFromCollection(a, collection);
-			const SongSelectIndex& song_b = getSongFromCollection(b, collection);
-			bool res = CompareSongs(song_a, song_b);
-			return res;
-		}
-		bool res = date_a < date_b;
-		return m_dir ? !res : res;
+		return MakeEntry(song, maxDate);
 	});
-
-	m_dateMap.clear();
 }
 
 void ArtistSort::SortInplace(Vector<uint32>& vec, const Map<int32,
 	SongSelectIndex>& collection)
 {
-	std::sort (vec.begin(), vec.end(),
-		[&](uint32 ia, uint32 ib) -> bool
+	ProfilerScope $(Utility::Sprintf("Sort by: %s", m_name));
+	SortSongs(vec, collection, m_dir, [](const SongSelectIndex& song)
 	{
-		const SongSelectIndex& song_a = getSongFromCollection(ia, collection);
-		const SongSelectIndex& song_b = getSongFromCollection(ib, collection);
-
-		String a = song_a.GetCharts()[0]->artist;
-		String b = song_b.GetCharts()[0]->artist;
-		a.ToUpper();
-		b.ToUpper();
-		int strres = a.compare(b);
-		if (strres == 0)
-			return CompareSongs(song_a, song_b);
-
-		bool res = strres < 0;
-		return m_dir ? !res : res;
+		return MakeEntry(song, 0, &song.GetCharts()[0]->artist_sortkey);
 	});
 }
 
 void EffectorSort::SortInplace(Vector<uint32>& vec, const Map<int32,
 	SongSelectIndex>& collection)
 {
-	std::sort (vec.begin(), vec.end(),
-		[&](uint32 ia, uint32 ib) -> bool
+	ProfilerScope $(Utility::Sprintf("Sort by: %s", m_name));
+	SortSongs(vec, collection, m_dir, [](const SongSelectIndex& song)
 	{
-		const SongSelectIndex& song_a = getSongFromCollection(ia, collection);
-		const SongSelectIndex& song_b = getSongFromCollection(ib, collection);
-
-		String a = song_a.GetCharts()[0]->effector;
-		String b = song_b.GetCharts()[0]->effector;
-		a.ToUpper();
-		b.ToUpper();
-		int strres = a.compare(b);
-		if (strres == 0)
-			return CompareSongs(song_a, song_b);
-
-		bool res = strres < 0;
-		return m_dir ? !res : res;
+		return MakeEntry(song, 0, &song.GetCharts()[0]->effector_sortkey);
 	});
 }
 
@@ -167,10 +124,9 @@ void ClearMarkSort::SortInplace(Vector<uint32>& vec, const Map<int32,
 		SongSelectIndex>& collection)
 {
 	ProfilerScope $(Utility::Sprintf("Sort by: %s", m_name));
-	m_clearMap.clear();
-	for (uint32 mapIndex : vec)
+	// For same clear marks sort by title
+	SortSongs(vec, collection, m_dir, [](const SongSelectIndex& song)
 	{
-		const SongSelectIndex& song = getSongFromCollection(mapIndex, collection);
 		ClearMark maxClear = ClearMark::NotPlayed;
 		for (auto& diff : song.GetCharts())
 		{
@@ -181,27 +137,8 @@ void ClearMarkSort::SortInplace(Vector<uint32>& vec, const Map<int32,
 					maxClear = smark;
 			}
 		}
-		m_clearMap[mapIndex] = static_cast<uint32>(maxClear);
-	}
-
-	std::sort (vec.begin(), vec.end(),
-		[&](uint32 a, uint32 b) -> bool
-	{
-		const uint32 score_a = m_clearMap.find(a)->second;
-		const uint32 score_b = m_clearMap.find(b)->second;
-
-		// For same scores sort by title
-		if (score_a == score_b) {
-			const SongSelectIndex& song_a = getSongFromCollection(a, collection);
-			const SongSelectIndex& song_b = getSongFromCollection(b, collection);
-			bool res = CompareSongs(song_a, song_b);
-			return res;
-		}
-		bool res = score_a < score_b;
-		return m_dir ? !res : res;
+		return MakeEntry(song, static_cast<uint32>(maxClear));
 	});
-
-	m_clearMap.clear();
 }
 
 
@@ -236,11 +173,7 @@ void ChallengeTitleSort::SortInplace(Vector<uint32>& vec, const Map<int32,
 bool ChallengeTitleSort::CompareChallenges(const ChallengeSelectIndex& chal_a,
 		const ChallengeSelectIndex& chal_b)
 {
-	String a = chal_a.GetChallenge()->title;
-	String b = chal_b.GetChallenge()->title;
-	a.ToUpper();
-	b.ToUpper();
-	int strres = a.compare(b);
+	int strres = chal_a.GetChallenge()->title_sortkey.compare(chal_b.GetChallenge()->title_sortkey);
 	if (strres == 0)
 		return chal_a.id < chal_b.id;
 	return strres < 0;
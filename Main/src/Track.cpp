@@ -6,6 +6,7 @@
 #include "LaserTrackBuilder.hpp"
 #include "AsyncAssetLoader.hpp"
 #include <unordered_set>
+#include <Shared/Profiling.hpp>
 
 #include <functional>
 
@@ -396,6 +397,8 @@ void Track::DrawLaserBase(RenderQueue& rq, class BeatmapPlayback& playback, cons
 
 void Track::DrawBase(class RenderQueue& rq)
 {
+	ProfilerZone $("Track::DrawBase");
+
 	// Base
 	MaterialParameterSet params;
 	Transform transform = trackOrigin;
@@ -803,6 +806,7 @@ void Track::DrawObjectState(RenderQueue& rq, class BeatmapPlayback& playback, Ob
 
 void Track::DrawOverlays(class RenderQueue& rq)
 {
+	ProfilerZone $("Track::DrawOverlays");
 	// Draw button hit effect sprites
 	for (auto& hfx : m_hitEffects)
 		hfx->Draw(rq);
@@ -813,6 +817,7 @@ void Track::DrawOverlays(class RenderQueue& rq)
 
 void Track::DrawHitEffects(RenderQueue& rq)
 {
+	ProfilerZone $("Track::DrawHitEffects");
 	for (auto& bfx : m_buttonHitEffects)
 		bfx.Draw(rq);
 }
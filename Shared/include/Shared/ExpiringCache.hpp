@@ -0,0 +1,78 @@
+#pragma once
+#include <list>
+#include <unordered_map>
+#include <functional>
+
+/*
+	Cache that releases entries which haven't been used for a given amount of time
+
+	Entries are kept in a list ordered by their last use, so expiring only looks at the entries that actually expired
+	instead of sweeping the whole cache. Times are passed in by the caller in seconds.
+*/
+template<typename K, typename V, typename Hash = std::hash<K>>
+class ExpiringCache
+{
+public:
+	ExpiringCache(float lifetime) : m_lifetime(lifetime)
+	{
+	}
+
+	// Returns the cached value and marks it as used, or null if it's not in the cache
+	V* Get(const K& key, float now)
+	{
+		auto it = m_lookup.find(key);
+		if (it == m_lookup.end())
+			return nullptr;
+		it->second->lastUsage = now;
+		m_entries.splice(m_entries.end(), m_entries, it->second);
+		return &it->second->value;
+	}
+
+	// Adds or replaces a value
+	void Add(const K& key, V value, float now)
+	{
+		auto it = m_lookup.find(key);
+		if (it != m_lookup.end())
+		{
+			it->second->value = std::move(value);
+			it->second->lastUsage = now;
+			m_entries.splice(m_entries.end(), m_entries, it->second);
+			return;
+		}
+		m_entries.push_back({ key, std::move(value), now });
+		m_lookup.emplace(key, std::prev(m_entries.end()));
+	}
+
+	// Removes values that weren't used within the lifetime
+	void Expire(float now)
+	{
+		while (!m_entries.empty() && now - m_entries.front().lastUsage > m_lifetime)
+		{
+			m_lookup.erase(m_entries.front().key);
+			m_entries.pop_front();
+		}
+	}
+
+	void Clear()
+	{
+		m_lookup.clear();
+		m_entries.clear();
+	}
+	size_t GetSize() const
+	{
+		return m_entries.size();
+	}
+
+private:
+	struct Entry
+	{
+		K key;
+		V value;
+		float lastUsage;
+	};
+
+	float m_lifetime;
+	// Least recently used first
+	std::list<Entry> m_entries;
+	std::unordered_map<K, typename std::list<Entry>::iterator, Hash> m_lookup;
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include "Shared/Unique.hpp"
+#include "Shared/Files.hpp"
+#include "Shared/Timer.hpp"
+
+/*
+	A file that was added, changed or removed in a watched folder
+*/
+struct FileChange
+{
+	String path;
+	bool removed;
+	uint64 lastWriteTime;
+};
+
+/*
+	Watches folders and their subfolders for added, changed and removed files with the given extensions
+
+	Uses the platform's change notifications where available (inotify on Linux, ReadDirectoryChangesW on Windows), otherwise the folders are rescanned periodically.
+	Changes are debounced, a burst of changes like extracting an archive is reported at once after it settled.
+	Not thread safe, all functions should be called from the thread that handles the changes.
+*/
+class FileWatcher : public Unique
+{
+public:
+	// Native notifications can be disabled to always use the polling fallback
+	FileWatcher(const Vector<String>& extensions, bool allowNative = true);
+	~FileWatcher();
+
+	// Starts watching a folder, call this before scanning it to not miss changes made during the scan
+	void Watch(const String& folder);
+	// Sets the files that were found by scanning the watched folders
+	//	the fallback compares against these to find changes and removed folders report the files that were in them
+	void SetFiles(const Map<String, FileInfo>& files);
+
+	// Waits at most timeout seconds for changes to settle and returns them
+	Vector<FileChange> GetChanges(float timeout);
+
+	// True when changes come from native notifications instead of rescanning
+	bool IsNative() const { return m_native; }
+
+	// Time without new changes before a burst of changes is reported
+	float debounceTime = 0.5f;
+	// Longest time changes are held back while they keep coming in
+	float maxDelay = 5.0f;
+	// Time between rescans when native notifications aren't available, every rescan reads all watched folders
+	float pollInterval = 60.0f;
+
+private:
+	bool m_MatchesExtension(const String& path) const;
+	// Write time is only known when rescanning, 0 otherwise
+	void m_MarkChanged(const String& path, uint64 lastWriteTime = 0);
+	// Marks all known files inside a folder, when the folder itself got removed or moved
+	void m_MarkFolderChanged(const String& folder);
+	// Compares the known files against a new scan of the watched folders
+	void m_Rescan();
+	Vector<FileChange> m_Flush();
+
+	// Platform specific notifications, these return false when they're not supported
+	bool m_OpenNative();
+	void m_CloseNative();
+	bool m_WatchNative(const String& folder);
+	// Waits at most timeout seconds for notifications and marks the files they are about
+	bool m_ReadNative(float timeout);
+
+	Vector<String> m_extensions;
+	Vector<String> m_folders;
+	// Last write times of existing files
+	Map<String, uint64> m_files;
+	// Files that changed but weren't reported yet, with the write time they changed to
+	Map<String, uint64> m_changed;
+	Timer m_firstChange;
+	Timer m_lastChange;
+	Timer m_lastScan;
+	bool m_native = false;
+
+	// Native notification handle and the watched folder for every watch
+	intptr_t m_nativeHandle = -1;
+	Map<int, String> m_nativeFolders;
+	// Platform specific state of every watch, for platforms that need more than the handle
+	struct NativeWatch;
+	Map<int, NativeWatch*> m_nativeWatches;
+};
@@ -0,0 +1,19 @@
+/*
+	High resolution input timestamps
+*/
+#pragma once
+#include "Shared/Types.hpp"
+
+/*
+	Monotonic clock used to timestamp input events, in microseconds
+*/
+namespace InputClock
+{
+	int64 Now();
+
+	// Converts a duration in microseconds to milliseconds, rounded to nearest
+	inline int32 ToMilliseconds(int64 us)
+	{
+		return (int32)((us >= 0 ? us + 500 : us - 500) / 1000);
+	}
+}
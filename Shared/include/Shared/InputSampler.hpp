@@ -0,0 +1,89 @@
+/*
+	Fixed rate input sampling thread
+*/
+#pragma once
+#include "Shared/Unique.hpp"
+#include "Shared/Ref.hpp"
+#include "Shared/Vector.hpp"
+#include "Shared/Thread.hpp"
+#include "Shared/SPSCQueue.hpp"
+#include "Shared/InputClock.hpp"
+#include <atomic>
+
+// A single button state change
+struct TimedInputEvent
+{
+	// Meaning of device and code is up to the consumer (e.g. keyboard scancode or gamepad button index)
+	uint8 device = 0;
+	uint32 code = 0;
+	bool pressed = false;
+	// When the input happened, InputClock time
+	int64 timestamp = 0;
+};
+
+/*
+	Something the input sampler can poll from its thread
+	Poll is only ever called from the sampling thread
+*/
+class InputSource
+{
+public:
+	virtual ~InputSource() = default;
+	// Appends all events that happened up to `now`
+	virtual void Poll(int64 now, Vector<TimedInputEvent>& events) = 0;
+};
+
+/*
+	Input source that replays scheduled events at their given times
+	used to measure input latency and jitter without hardware
+*/
+class SyntheticInputSource : public InputSource
+{
+public:
+	// Schedule an event at InputClock time `time`, can be called from any thread
+	void Schedule(int64 time, uint8 device, uint32 code, bool pressed);
+	// Number of scheduled events that have not been emitted yet
+	size_t GetPendingCount();
+
+	void Poll(int64 now, Vector<TimedInputEvent>& events) override;
+
+private:
+	Mutex m_lock;
+	// Sorted by timestamp
+	Vector<TimedInputEvent> m_pending;
+};
+
+/*
+	Polls input sources on a dedicated thread at a fixed rate
+	events are pushed into a lock-free queue that a single consumer thread drains with Pop
+*/
+class InputSampler : public Unique
+{
+public:
+	InputSampler(size_t queueSize = 1024);
+	~InputSampler();
+
+	// Sources can only be added while the sampler is stopped
+	void AddSource(Ref<InputSource> source);
+
+	bool Start(uint32 rateHz = 1000);
+	void Stop();
+	bool IsRunning() const;
+	uint32 GetRate() const;
+
+	// Consumer side, returns false when no more events are queued
+	bool Pop(TimedInputEvent& out);
+
+	// Events lost because the consumer did not drain the queue fast enough
+	uint64 GetDroppedCount() const;
+
+private:
+	void m_Run();
+
+	Vector<Ref<InputSource>> m_sources;
+	SPSCQueue<TimedInputEvent> m_queue;
+	Thread m_thread;
+	std::atomic<bool> m_running = { false };
+	std::atomic<uint64> m_dropped = { 0 };
+	uint32 m_rate = 1000;
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include "lua.hpp"
+#include "Shared/Types.hpp"
+#include "Shared/Vector.hpp"
+#include "Shared/Unique.hpp"
+#include <functional>
+
+/*
+	A Lua array whose elements are only created when they are indexed
+
+	Pushed as an empty table with a metatable, __index creates elements through a callback, __len returns the element count
+	and __pairs iterates over all elements. The most recently indexed elements are kept in a small LRU cache, so redrawing
+	the visible part of a large list every frame doesn't rebuild them.
+
+	Pushed tables keep a pointer to this object, it must outlive them or the lua_State they were pushed to.
+	The cache is kept in the registry until this is destroyed, so it must be destroyed before the lua_State is closed.
+*/
+class LuaLazyList : Unique
+{
+public:
+	// Pushes the element at the given (0 based) index
+	using PushElementFunction = std::function<void(lua_State* L, size_t index)>;
+
+	LuaLazyList(lua_State* L, size_t cacheSize = 64);
+	~LuaLazyList();
+
+	// Replaces the contents of the list, this is O(1) and clears the cache
+	void Set(size_t count, PushElementFunction pushElement);
+	// Pushes a table that refers to this list, it always reflects the last call to Set
+	void Push();
+
+	size_t GetCount() const { return m_count; }
+	// Number of elements that were created since the last call to Set
+	size_t GetNumCreated() const { return m_numCreated; }
+
+private:
+	static int m_Index(lua_State* L);
+	static int m_Length(lua_State* L);
+	static int m_Pairs(lua_State* L);
+	static int m_Next(lua_State* L);
+
+	// Pushes the element at the given (1 based) index or nil
+	void m_PushElement(lua_State* L, lua_Integer index);
+
+	lua_State* m_lua;
+	size_t m_cacheSize;
+	size_t m_count = 0;
+	size_t m_numCreated = 0;
+	PushElementFunction m_pushElement;
+	// Registry reference to the table holding cached elements
+	int m_cache = LUA_NOREF;
+	// Cached indices, least recently used first
+	Vector<lua_Integer> m_recent;
+};
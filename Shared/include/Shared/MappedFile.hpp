@@ -0,0 +1,27 @@
+#pragma once
+#include "Shared/Unique.hpp"
+#include "Shared/String.hpp"
+
+/*
+	A whole file mapped into memory
+	Pages are read from disk by the OS when they are first accessed
+	The mapping is copy on write, changes only go to this process' copy and never reach the file
+*/
+class MappedFile : Unique
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	bool Open(const String& path);
+	void Close();
+
+	bool IsOpen() const { return m_data != nullptr; }
+	uint8* GetData() { return m_data; }
+	const uint8* GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+
+private:
+	uint8* m_data = nullptr;
+	size_t m_size = 0;
+};
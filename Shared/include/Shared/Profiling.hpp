@@ -1,4 +1,9 @@
 #pragma once
+#include "Shared/Types.hpp"
+#include "Shared/String.hpp"
+#include "Shared/Vector.hpp"
+#include "Shared/Timer.hpp"
+#include "Shared/Log.hpp"
 
 class ProfilerScope
 {
@@ -14,4 +19,122 @@ public:
 private:
 	Timer t;
 	String name;
-};
\ No newline at end of file
+};
+
+// Per frame counters
+enum class ProfilerCounter : uint8
+{
+	DrawCalls,
+	// Text draws after batching
+	TextDrawCalls,
+	TextureUploads,
+	BufferAllocations,
+	// Times in microseconds
+	LuaTime,
+	MixTime,
+	Count
+};
+
+// A single finished zone, times are in microseconds since the profiler was started
+struct ProfilerZoneRecord
+{
+	const char* name;
+	int64 start;
+	int64 duration;
+	uint32 threadId;
+	uint32 depth;
+};
+
+struct ProfilerFrame
+{
+	uint64 index = 0;
+	int64 start = 0;
+	int64 duration = 0;
+	int64 counters[(size_t)ProfilerCounter::Count] = { 0 };
+};
+
+// Total time spent in zones with the same name on the same thread
+struct ProfilerZoneSummary
+{
+	const char* name;
+	uint32 threadId;
+	uint32 calls;
+	int64 totalTime;
+};
+
+/*
+	Low overhead instrumentation
+	zones are recorded into per-thread ring buffers and frame stats into a ring buffer of recent frames
+	nothing is recorded unless the profiler is enabled
+*/
+class Profiler
+{
+public:
+	static void SetEnabled(bool enabled);
+	static bool IsEnabled();
+
+	// Microseconds since the profiler was first used
+	static int64 Now();
+
+	// Name used for the calling thread in exported traces
+	static void SetThreadName(const char* name);
+	static uint32 GetThreadId();
+
+	// Marks frame boundaries, should be called from the main loop
+	static void BeginFrame();
+	static void EndFrame();
+
+	static void AddCounter(ProfilerCounter counter, int64 amount = 1);
+	static const char* GetCounterName(ProfilerCounter counter);
+
+	// Recently completed frames, oldest first
+	static Vector<ProfilerFrame> GetFrames();
+	// Zones that started in the given time range, sorted by total time
+	static Vector<ProfilerZoneSummary> GetZoneSummary(int64 begin, int64 end);
+
+	// Writes all recorded zones and frame counters in the Chrome trace event format (chrome://tracing, Perfetto)
+	static bool ExportChromeTrace(const String& path);
+
+	// Number of zones kept per thread and number of frames kept
+	static constexpr size_t zoneBufferSize = 1 << 16;
+	static constexpr size_t frameBufferSize = 240;
+
+private:
+	friend class ProfilerZone;
+	static void m_RecordZone(const char* name, int64 start, int64 end, uint32 depth);
+	static uint32& m_Depth();
+};
+
+/*
+	Records the time spent in the current scope, the name must outlive the profiler (e.g. a string literal)
+	Optionally adds the time spent to a time counter
+*/
+class ProfilerZone
+{
+public:
+	ProfilerZone(const char* name, ProfilerCounter timeCounter = ProfilerCounter::Count)
+	{
+		if (!Profiler::IsEnabled())
+			return;
+		m_name = name;
+		m_timeCounter = timeCounter;
+		m_depth = Profiler::m_Depth()++;
+		m_start = Profiler::Now();
+	}
+	~ProfilerZone()
+	{
+		if (!m_name)
+			return;
+		const int64 end = Profiler::Now();
+		Profiler::m_Depth()--;
+		Profiler::m_RecordZone(m_name, m_start, end, m_depth);
+		if (m_timeCounter != ProfilerCounter::Count)
+			Profiler::AddCounter(m_timeCounter, end - m_start);
+	}
+
+private:
+	const char* m_name = nullptr;
+	ProfilerCounter m_timeCounter = ProfilerCounter::Count;
+	uint32 m_depth = 0;
+	int64 m_start = 0;
+};
@@ -8,4 +8,6 @@ namespace Random
 	float Float();
 	float FloatRange(float min, float max);
 	int32 IntRange(int32 min, int32 max);
+	// Restarts the random sequence, the generator is seeded with the current time by default
+	void Seed(uint32 seed);
 }
\ No newline at end of file
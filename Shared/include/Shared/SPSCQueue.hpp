@@ -0,0 +1,75 @@
+#pragma once
+#include "Shared/Types.hpp"
+#include <atomic>
+#include <vector>
+
+/*
+	Bounded lock-free queue for exactly one producer thread and one consumer thread
+	the capacity is rounded up to a power of two
+*/
+template<typename T>
+class SPSCQueue
+{
+public:
+	SPSCQueue(size_t capacity = 1024)
+	{
+		size_t size = 2;
+		while (size < capacity)
+			size <<= 1;
+		m_items.resize(size);
+		m_mask = size - 1;
+	}
+
+	// Producer side, returns false if the queue is full
+	bool TryPush(const T& item)
+	{
+		const size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+			return false;
+		m_items[tail & m_mask] = item;
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side, returns false if the queue is empty
+	bool TryPop(T& out)
+	{
+		const size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+			return false;
+		out = m_items[head & m_mask];
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side, copies the next item without removing it, returns false if the queue is empty
+	bool TryPeek(T& out) const
+	{
+		const size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+			return false;
+		out = m_items[head & m_mask];
+		return true;
+	}
+
+	// Approximate when called while the other side is active
+	size_t Size() const
+	{
+		return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+	}
+	bool IsEmpty() const
+	{
+		return Size() == 0;
+	}
+	size_t Capacity() const
+	{
+		return m_mask + 1;
+	}
+
+private:
+	std::vector<T> m_items;
+	size_t m_mask;
+	// Kept on separate cache lines so both threads don't contend on the same line
+	alignas(64) std::atomic<size_t> m_head = { 0 };
+	alignas(64) std::atomic<size_t> m_tail = { 0 };
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include "Shared/String.hpp"
+#include "Shared/Vector.hpp"
+#include <algorithm>
+
+/*
+	Case folded keys for sorting strings case insensitively
+	Keys are meant to be computed once when the string is loaded, comparing two keys gives the same order as
+	comparing upper case copies of the strings but without copying them on every comparison
+*/
+namespace SortKey
+{
+	inline String Make(const String& str)
+	{
+		String key = str;
+		key.ToUpper();
+		return key;
+	}
+
+	// An item with everything it is compared by, gathered once per sort so comparisons don't look anything up
+	struct Entry
+	{
+		uint64 value;
+		// Null when only sorting by value
+		const String* key;
+		const String* title;
+		uint32 id;
+	};
+
+	// Sorts entries by value and then by key in the given direction, entries that are equal in both are ordered by title and id
+	//	ties are ordered in the same direction when reverseTies is set, otherwise they are always in ascending order
+	inline void Sort(Vector<Entry>& entries, bool descending = false, bool reverseTies = false)
+	{
+		std::sort(entries.begin(), entries.end(), [descending, reverseTies](const Entry& a, const Entry& b)
+		{
+			if (a.value != b.value)
+				return descending ? a.value > b.value : a.value < b.value;
+			if (a.key && b.key && a.key != b.key)
+			{
+				const int res = a.key->compare(*b.key);
+				if (res != 0)
+					return descending ? res > 0 : res < 0;
+			}
+			const bool reverse = descending && reverseTies;
+			if (a.title != b.title)
+			{
+				const int res = a.title->compare(*b.title);
+				if (res != 0)
+					return reverse ? res > 0 : res < 0;
+			}
+			return reverse ? a.id > b.id : a.id < b.id;
+		});
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "Shared/Unique.hpp"
+#include "Shared/Thread.hpp"
+#include "Shared/List.hpp"
+#include "Shared/Vector.hpp"
+#include <condition_variable>
+#include <functional>
+
+/*
+	Fixed number of threads that run queued tasks in order
+	Unlike the JobSheduler there are no callbacks on the main thread, tasks are expected to publish their own results.
+	Tasks that are still queued when the pool is destroyed are dropped, running tasks are waited for.
+	Dropped tasks are destroyed without running, anything they have to release should be released by their destructor.
+*/
+class WorkerPool : public Unique
+{
+public:
+	using Task = std::function<void()>;
+
+	WorkerPool(size_t numThreads);
+	~WorkerPool();
+
+	// The owner can be used to drop the task again before it runs
+	void Queue(Task task, const void* owner = nullptr);
+	// Drops the queued tasks of an owner, tasks that already run are not waited for, returns the number of dropped tasks
+	size_t Cancel(const void* owner);
+	// Blocks until all queued tasks have run
+	void Wait();
+
+	size_t GetNumThreads() const { return m_threads.size(); }
+	size_t GetNumQueued();
+
+private:
+	struct QueuedTask
+	{
+		Task task;
+		const void* owner;
+	};
+
+	void m_Worker();
+
+	Vector<Thread> m_threads;
+	List<QueuedTask> m_tasks;
+	Mutex m_lock;
+	std::condition_variable m_taskAdded;
+	std::condition_variable m_taskDone;
+	size_t m_numRunning = 0;
+	bool m_terminate = false;
+};
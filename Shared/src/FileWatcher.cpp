@@ -0,0 +1,165 @@
+#include "stdafx.h"
+#include "FileWatcher.hpp"
+#include "Path.hpp"
+#include "File.hpp"
+#include "Math.hpp"
+#include "Log.hpp"
+#include <thread>
+
+FileWatcher::FileWatcher(const Vector<String>& extensions, bool allowNative)
+{
+	for(String ext : extensions)
+	{
+		ext.TrimFront('.');
+		m_extensions.Add(ext);
+	}
+	m_native = allowNative && m_OpenNative();
+}
+FileWatcher::~FileWatcher()
+{
+	if(m_native)
+		m_CloseNative();
+}
+
+void FileWatcher::Watch(const String& folder)
+{
+	m_folders.Add(folder);
+	if(m_native && !m_WatchNative(folder))
+	{
+		Logf("Can't watch \"%s\" for changes, rescanning every %.1f seconds instead", Logger::Severity::Warning, folder, pollInterval);
+		m_CloseNative();
+		m_native = false;
+	}
+}
+void FileWatcher::SetFiles(const Map<String, FileInfo>& files)
+{
+	m_files.clear();
+	for(auto& file : files)
+	{
+		if(m_MatchesExtension(file.first))
+			m_files.Add(file.first, file.second.lastWriteTime);
+	}
+	m_lastScan.Restart();
+}
+
+Vector<FileChange> FileWatcher::GetChanges(float timeout)
+{
+	Timer timer;
+	while(true)
+	{
+		if(!m_changed.empty() && (m_lastChange.SecondsAsFloat() >= debounceTime || m_firstChange.SecondsAsFloat() >= maxDelay))
+			return m_Flush();
+
+		float wait = timeout - timer.SecondsAsFloat();
+		if(wait <= 0.0f)
+			return Vector<FileChange>();
+		// Wake up when pending changes settle
+		if(!m_changed.empty())
+			wait = Math::Min(wait, debounceTime - m_lastChange.SecondsAsFloat());
+
+		if(m_native)
+		{
+			if(!m_ReadNative(wait))
+			{
+				Logf("Lost file change notifications, rescanning every %.1f seconds instead", Logger::Severity::Warning, pollInterval);
+				m_CloseNative();
+				m_native = false;
+				m_Rescan();
+			}
+		}
+		else if(m_lastScan.SecondsAsFloat() >= pollInterval)
+		{
+			m_Rescan();
+		}
+		else
+		{
+			wait = Math::Min(wait, pollInterval - m_lastScan.SecondsAsFloat());
+			std::this_thread::sleep_for(std::chrono::duration<float>(Math::Max(wait, 0.0f)));
+		}
+	}
+}
+
+bool FileWatcher::m_MatchesExtension(const String& path) const
+{
+	if(m_extensions.empty())
+		return true;
+	String ext = Path::GetExtension(path);
+	for(const String& filter : m_extensions)
+	{
+		if(ext == filter)
+			return true;
+	}
+	return false;
+}
+void FileWatcher::m_MarkChanged(const String& path, uint64 lastWriteTime)
+{
+	if(m_changed.empty())
+		m_firstChange.Restart();
+	m_lastChange.Restart();
+	m_changed[path] = lastWriteTime;
+}
+void FileWatcher::m_MarkFolderChanged(const String& folder)
+{
+	const String prefix = folder + Path::sep;
+	for(auto it = m_files.lower_bound(prefix); it != m_files.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+		m_MarkChanged(it->first);
+}
+void FileWatcher::m_Rescan()
+{
+	m_lastScan.Restart();
+	Map<String, uint64> found;
+	for(const String& folder : m_folders)
+	{
+		Map<String, Vector<FileInfo>> files = Files::ScanFilesRecursive(folder, m_extensions);
+		for(auto& ext : files)
+		{
+			for(FileInfo& file : ext.second)
+				found.Add(file.fullPath, file.lastWriteTime);
+		}
+	}
+
+	// Compare against changes that are still pending, files that didn't change since the last scan don't delay reporting them
+	auto lastSeen = [this](const String& path) -> uint64
+	{
+		uint64* lwt = m_changed.Find(path);
+		if(!lwt)
+			lwt = m_files.Find(path);
+		return lwt ? *lwt : 0;
+	};
+	for(auto& file : found)
+	{
+		if(lastSeen(file.first) != file.second)
+			m_MarkChanged(file.first, file.second);
+	}
+	for(auto& file : m_files)
+	{
+		if(!found.Contains(file.first) && lastSeen(file.first) != 0)
+			m_MarkChanged(file.first, 0);
+	}
+}
+Vector<FileChange> FileWatcher::m_Flush()
+{
+	Vector<FileChange> changes;
+	for(auto& changed : m_changed)
+	{
+		const String& path = changed.first;
+		FileChange change;
+		change.path = path;
+		change.lastWriteTime = File::GetLastWriteTime(path);
+		change.removed = change.lastWriteTime == 0 || Path::IsDirectory(path);
+		if(change.removed)
+		{
+			// Created and removed again before it was reported
+			if(!m_files.Contains(path))
+				continue;
+			m_files.erase(path);
+		}
+		else
+		{
+			m_files[path] = change.lastWriteTime;
+		}
+		changes.Add(change);
+	}
+	m_changed.clear();
+	return changes;
+}
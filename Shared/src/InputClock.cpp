@@ -0,0 +1,9 @@
+#include "stdafx.h"
+#include "InputClock.hpp"
+#include <chrono>
+
+int64 InputClock::Now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,114 @@
+#include "stdafx.h"
+#include "InputSampler.hpp"
+#include "Log.hpp"
+#include <chrono>
+#include <algorithm>
+
+void SyntheticInputSource::Schedule(int64 time, uint8 device, uint32 code, bool pressed)
+{
+	TimedInputEvent evt;
+	evt.device = device;
+	evt.code = code;
+	evt.pressed = pressed;
+	evt.timestamp = time;
+
+	m_lock.lock();
+	// Keep events sorted, events with the same time stay in scheduling order
+	auto it = std::upper_bound(m_pending.begin(), m_pending.end(), evt,
+		[](const TimedInputEvent& l, const TimedInputEvent& r) { return l.timestamp < r.timestamp; });
+	m_pending.insert(it, evt);
+	m_lock.unlock();
+}
+size_t SyntheticInputSource::GetPendingCount()
+{
+	m_lock.lock();
+	size_t count = m_pending.size();
+	m_lock.unlock();
+	return count;
+}
+void SyntheticInputSource::Poll(int64 now, Vector<TimedInputEvent>& events)
+{
+	m_lock.lock();
+	auto end = m_pending.begin();
+	while (end != m_pending.end() && end->timestamp <= now)
+		end++;
+	events.insert(events.end(), m_pending.begin(), end);
+	m_pending.erase(m_pending.begin(), end);
+	m_lock.unlock();
+}
+
+InputSampler::InputSampler(size_t queueSize) : m_queue(queueSize)
+{
+}
+InputSampler::~InputSampler()
+{
+	Stop();
+}
+void InputSampler::AddSource(Ref<InputSource> source)
+{
+	assert(!m_running);
+	m_sources.Add(source);
+}
+bool InputSampler::Start(uint32 rateHz)
+{
+	if (m_running)
+		return false;
+	m_rate = std::max(1u, rateHz);
+	m_running = true;
+	m_thread = Thread(&InputSampler::m_Run, this);
+	return true;
+}
+void InputSampler::Stop()
+{
+	if (!m_running)
+		return;
+	m_running = false;
+	if (m_thread.joinable())
+		m_thread.join();
+}
+bool InputSampler::IsRunning() const
+{
+	return m_running;
+}
+uint32 InputSampler::GetRate() const
+{
+	return m_rate;
+}
+bool InputSampler::Pop(TimedInputEvent& out)
+{
+	return m_queue.TryPop(out);
+}
+uint64 InputSampler::GetDroppedCount() const
+{
+	return m_dropped;
+}
+
+void InputSampler::m_Run()
+{
+	using namespace std::chrono;
+	const auto period = duration_cast<steady_clock::duration>(microseconds(1000000 / m_rate));
+	auto nextTick = steady_clock::now();
+
+	Vector<TimedInputEvent> events;
+	while (m_running)
+	{
+		const int64 now = InputClock::Now();
+		for (auto& source : m_sources)
+			source->Poll(now, events);
+
+		for (auto& evt : events)
+		{
+			if (!m_queue.TryPush(evt))
+				m_dropped++;
+		}
+		events.clear();
+
+		// Sleep till the next sampling period, skip periods that were missed instead of bursting to catch up
+		nextTick += period;
+		const auto current = steady_clock::now();
+		if (nextTick < current)
+			nextTick = current;
+		else
+			std::this_thread::sleep_until(nextTick);
+	}
+}
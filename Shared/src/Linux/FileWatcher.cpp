@@ -0,0 +1,146 @@
+#include "stdafx.h"
+#include "FileWatcher.hpp"
+#include "Path.hpp"
+#include "Log.hpp"
+#include "List.hpp"
+
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <errno.h>
+
+static const uint32 watchMask = IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+bool FileWatcher::m_OpenNative()
+{
+	m_nativeHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	return m_nativeHandle >= 0;
+}
+void FileWatcher::m_CloseNative()
+{
+	if(m_nativeHandle >= 0)
+		close((int)m_nativeHandle);
+	m_nativeHandle = -1;
+	m_nativeFolders.clear();
+}
+bool FileWatcher::m_WatchNative(const String& folder)
+{
+	// Every folder needs its own watch, inotify is not recursive
+	List<String> folderQueue;
+	folderQueue.AddBack(folder);
+	while(!folderQueue.empty())
+	{
+		String path = folderQueue.front();
+		folderQueue.pop_front();
+
+		int watch = inotify_add_watch((int)m_nativeHandle, *path, watchMask);
+		if(watch < 0)
+		{
+			// Out of watches, other errors are folders that can't be read or are already gone
+			if(errno == ENOSPC || errno == ENOMEM)
+				return false;
+			continue;
+		}
+		m_nativeFolders[watch] = path;
+
+		DIR* dir = opendir(*path);
+		if(dir == nullptr)
+			continue;
+		while(dirent* ent = readdir(dir))
+		{
+			String name = ent->d_name;
+			if(name == "." || name == "..")
+				continue;
+			String subPath = Path::Normalize(path + Path::sep + name);
+			bool isDir = ent->d_type == DT_DIR;
+			if(ent->d_type == DT_UNKNOWN || ent->d_type == DT_LNK)
+			{
+				struct stat buffer;
+				isDir = stat(*subPath, &buffer) == 0 && S_ISDIR(buffer.st_mode);
+			}
+			if(isDir)
+				folderQueue.AddBack(subPath);
+		}
+		closedir(dir);
+	}
+	return true;
+}
+bool FileWatcher::m_ReadNative(float timeout)
+{
+	pollfd pfd = { (int)m_nativeHandle, POLLIN, 0 };
+	if(poll(&pfd, 1, (int)(timeout * 1000.0f)) <= 0)
+		return true;
+
+	alignas(inotify_event) char buffer[16 * 1024];
+	ssize_t length;
+	while((length = read((int)m_nativeHandle, buffer, sizeof(buffer))) > 0)
+	{
+		const inotify_event* event;
+		for(char* ptr = buffer; ptr < buffer + length; ptr += sizeof(inotify_event) + event->len)
+		{
+			event = (const inotify_event*)ptr;
+			if(event->mask & IN_Q_OVERFLOW)
+			{
+				// Notifications were dropped, compare against the files on disk instead
+				for(const String& folder : m_folders)
+				{
+					if(!m_WatchNative(folder))
+						return false;
+				}
+				m_Rescan();
+				continue;
+			}
+			if(event->mask & IN_IGNORED)
+			{
+				m_nativeFolders.erase(event->wd);
+				continue;
+			}
+
+			String* folder = m_nativeFolders.Find(event->wd);
+			if(!folder || event->len == 0)
+				continue;
+			String path = Path::Normalize(*folder + Path::sep + event->name);
+
+			if(event->mask & IN_ISDIR)
+			{
+				if(event->mask & (IN_CREATE | IN_MOVED_TO))
+				{
+					// Watch before scanning so files written in the meantime aren't missed
+					if(!m_WatchNative(path))
+						return false;
+					Map<String, Vector<FileInfo>> files = Files::ScanFilesRecursive(path, m_extensions);
+					for(auto& ext : files)
+					{
+						for(FileInfo& file : ext.second)
+							m_MarkChanged(file.fullPath);
+					}
+				}
+				else
+				{
+					// Moved away folders keep their watch, stop it since the path no longer matches
+					const String prefix = path + Path::sep;
+					for(auto it = m_nativeFolders.begin(); it != m_nativeFolders.end();)
+					{
+						if(it->second == path || it->second.compare(0, prefix.size(), prefix) == 0)
+						{
+							inotify_rm_watch((int)m_nativeHandle, it->first);
+							it = m_nativeFolders.erase(it);
+						}
+						else
+						{
+							++it;
+						}
+					}
+					m_MarkFolderChanged(path);
+				}
+			}
+			else if(m_MatchesExtension(path))
+			{
+				m_MarkChanged(path);
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,128 @@
+#include "stdafx.h"
+#include "LuaLazyList.hpp"
+#include <algorithm>
+
+LuaLazyList::LuaLazyList(lua_State* L, size_t cacheSize) : m_lua(L), m_cacheSize(std::max<size_t>(cacheSize, 1))
+{
+}
+LuaLazyList::~LuaLazyList()
+{
+	// Releases the cached elements
+	if (m_cache != LUA_NOREF)
+		luaL_unref(m_lua, LUA_REGISTRYINDEX, m_cache);
+}
+
+void LuaLazyList::Set(size_t count, PushElementFunction pushElement)
+{
+	m_count = count;
+	m_pushElement = std::move(pushElement);
+	m_numCreated = 0;
+	m_recent.clear();
+
+	// Drop all cached elements at once by replacing the table
+	lua_newtable(m_lua);
+	if (m_cache == LUA_NOREF)
+		m_cache = luaL_ref(m_lua, LUA_REGISTRYINDEX);
+	else
+		lua_rawseti(m_lua, LUA_REGISTRYINDEX, m_cache);
+}
+
+void LuaLazyList::Push()
+{
+	lua_newtable(m_lua);
+	lua_createtable(m_lua, 0, 3);
+	lua_pushlightuserdata(m_lua, this);
+	lua_pushcclosure(m_lua, &LuaLazyList::m_Index, 1);
+	lua_setfield(m_lua, -2, "__index");
+	lua_pushlightuserdata(m_lua, this);
+	lua_pushcclosure(m_lua, &LuaLazyList::m_Length, 1);
+	lua_setfield(m_lua, -2, "__len");
+	lua_pushlightuserdata(m_lua, this);
+	lua_pushcclosure(m_lua, &LuaLazyList::m_Pairs, 1);
+	lua_setfield(m_lua, -2, "__pairs");
+	lua_setmetatable(m_lua, -2);
+}
+
+void LuaLazyList::m_PushElement(lua_State* L, lua_Integer index)
+{
+	if (index < 1 || (size_t)index > m_count || m_cache == LUA_NOREF)
+	{
+		lua_pushnil(L);
+		return;
+	}
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, m_cache);
+	if (lua_rawgeti(L, -1, index) != LUA_TNIL)
+	{
+		// Move to the back of the LRU list
+		auto it = std::find(m_recent.begin(), m_recent.end(), index);
+		if (it != m_recent.end())
+			std::rotate(it, it + 1, m_recent.end());
+		lua_remove(L, -2);
+		return;
+	}
+	lua_pop(L, 1);
+
+	m_pushElement(L, (size_t)index - 1);
+	m_numCreated++;
+	if (lua_isnil(L, -1))
+	{
+		lua_remove(L, -2);
+		return;
+	}
+	lua_pushvalue(L, -1);
+	lua_rawseti(L, -3, index);
+
+	m_recent.Add(index);
+	if (m_recent.size() > m_cacheSize)
+	{
+		lua_pushnil(L);
+		lua_rawseti(L, -3, m_recent.front());
+		m_recent.erase(m_recent.begin());
+	}
+	lua_remove(L, -2);
+}
+
+int LuaLazyList::m_Index(lua_State* L)
+{
+	LuaLazyList* list = (LuaLazyList*)lua_touserdata(L, lua_upvalueindex(1));
+	int isInteger = 0;
+	lua_Integer index = lua_tointegerx(L, 2, &isInteger);
+	if (!isInteger)
+	{
+		lua_pushnil(L);
+		return 1;
+	}
+	list->m_PushElement(L, index);
+	return 1;
+}
+
+int LuaLazyList::m_Length(lua_State* L)
+{
+	LuaLazyList* list = (LuaLazyList*)lua_touserdata(L, lua_upvalueindex(1));
+	lua_pushinteger(L, (lua_Integer)list->m_count);
+	return 1;
+}
+
+int LuaLazyList::m_Pairs(lua_State* L)
+{
+	lua_pushvalue(L, lua_upvalueindex(1));
+	lua_pushcclosure(L, &LuaLazyList::m_Next, 1);
+	lua_pushvalue(L, 1);
+	lua_pushinteger(L, 0);
+	return 3;
+}
+
+int LuaLazyList::m_Next(lua_State* L)
+{
+	LuaLazyList* list = (LuaLazyList*)lua_touserdata(L, lua_upvalueindex(1));
+	lua_Integer index = luaL_checkinteger(L, 2) + 1;
+	if (index < 1 || (size_t)index > list->m_count)
+	{
+		lua_pushnil(L);
+		return 1;
+	}
+	lua_pushinteger(L, index);
+	list->m_PushElement(L, index);
+	return 2;
+}
@@ -0,0 +1,19 @@
+#include "stdafx.h"
+#include "FileWatcher.hpp"
+
+// No native change notifications yet, the watcher falls back to rescanning
+bool FileWatcher::m_OpenNative()
+{
+	return false;
+}
+void FileWatcher::m_CloseNative()
+{
+}
+bool FileWatcher::m_WatchNative(const String& folder)
+{
+	return false;
+}
+bool FileWatcher::m_ReadNative(float timeout)
+{
+	return false;
+}
@@ -134,6 +134,9 @@ String Path::GetModuleName()
 bool Path::CreateDirRecursive(String path)
 {
 	String path1;
+	// Keep the root of absolute unix paths
+	if(!path.empty() && path[0] == Path::sep)
+		path1 = String(1, Path::sep);
 	while(!path.empty())
 	{
 		String segment = path;
@@ -151,7 +154,7 @@ bool Path::CreateDirRecursive(String path)
 			path.clear();
 		}
 
-		if(!path1.empty())
+		if(!path1.empty() && path1.back() != Path::sep)
 			path1 += Path::sep;
 		path1 += segment;
 
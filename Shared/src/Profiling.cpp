@@ -0,0 +1,277 @@
+#include "stdafx.h"
+#include "Profiling.hpp"
+#include "Thread.hpp"
+#include "File.hpp"
+#include "Ref.hpp"
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+namespace
+{
+	// Zones recorded by a single thread
+	struct ThreadZoneBuffer
+	{
+		uint32 id = 0;
+		String name;
+		Mutex lock;
+		Vector<ProfilerZoneRecord> zones;
+		// Total number of zones written, the ring index is this modulo the buffer size
+		size_t numWritten = 0;
+	};
+
+	std::atomic<bool> g_enabled(false);
+	std::atomic<int64> g_counters[(size_t)ProfilerCounter::Count];
+
+	// Buffers are kept after threads exit so their zones can still be exported
+	Mutex g_threadsLock;
+	Vector<Ref<ThreadZoneBuffer>> g_threads;
+
+	Mutex g_frameLock;
+	ProfilerFrame g_frames[Profiler::frameBufferSize];
+	uint64 g_numFrames = 0;
+	int64 g_frameStart = -1;
+
+	thread_local ThreadZoneBuffer* t_buffer = nullptr;
+	thread_local uint32 t_depth = 0;
+	// Name set before the thread recorded anything, the buffer is only allocated once it does
+	thread_local String t_name;
+
+	ThreadZoneBuffer& GetThreadBuffer()
+	{
+		if (!t_buffer)
+		{
+			Ref<ThreadZoneBuffer> buffer = Ref<ThreadZoneBuffer>(new ThreadZoneBuffer());
+			buffer->zones.resize(Profiler::zoneBufferSize);
+			g_threadsLock.lock();
+			buffer->id = (uint32)g_threads.size() + 1;
+			buffer->name = t_name.empty() ? Utility::Sprintf("Thread %d", buffer->id) : t_name;
+			g_threads.Add(buffer);
+			g_threadsLock.unlock();
+			t_buffer = buffer.get();
+		}
+		return *t_buffer;
+	}
+
+	Vector<Ref<ThreadZoneBuffer>> GetThreadBuffers()
+	{
+		g_threadsLock.lock();
+		Vector<Ref<ThreadZoneBuffer>> threads = g_threads;
+		g_threadsLock.unlock();
+		return threads;
+	}
+
+	// Calls the callback for every zone still in the buffer, in recording order
+	template<typename Callback>
+	void ForEachZone(ThreadZoneBuffer& buffer, Callback&& callback)
+	{
+		const size_t size = buffer.zones.size();
+		const size_t count = std::min(buffer.numWritten, size);
+		for (size_t i = buffer.numWritten - count; i < buffer.numWritten; i++)
+			callback(buffer.zones[i % size]);
+	}
+
+	void AppendJsonString(String& out, const char* str)
+	{
+		out += '"';
+		for (; *str; str++)
+		{
+			if (*str == '"' || *str == '\\')
+				out += '\\';
+			if ((uint8)*str < 0x20)
+				continue;
+			out += *str;
+		}
+		out += '"';
+	}
+}
+
+void Profiler::SetEnabled(bool enabled)
+{
+	if (enabled && !g_enabled)
+	{
+		// Initialize the epoch
+		Now();
+		for (auto& counter : g_counters)
+			counter = 0;
+	}
+	g_enabled = enabled;
+}
+bool Profiler::IsEnabled()
+{
+	return g_enabled.load(std::memory_order_relaxed);
+}
+int64 Profiler::Now()
+{
+	static const auto epoch = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	t_name = name;
+	if (!t_buffer)
+		return;
+	t_buffer->lock.lock();
+	t_buffer->name = name;
+	t_buffer->lock.unlock();
+}
+uint32 Profiler::GetThreadId()
+{
+	return GetThreadBuffer().id;
+}
+
+void Profiler::BeginFrame()
+{
+	if (!IsEnabled())
+		return;
+	g_frameLock.lock();
+	g_frameStart = Now();
+	g_frameLock.unlock();
+}
+void Profiler::EndFrame()
+{
+	if (!IsEnabled())
+		return;
+	g_frameLock.lock();
+	if (g_frameStart >= 0)
+	{
+		ProfilerFrame& frame = g_frames[g_numFrames % frameBufferSize];
+		frame.index = g_numFrames++;
+		frame.start = g_frameStart;
+		frame.duration = Now() - g_frameStart;
+		for (size_t i = 0; i < (size_t)ProfilerCounter::Count; i++)
+			frame.counters[i] = g_counters[i].exchange(0, std::memory_order_relaxed);
+		g_frameStart = -1;
+	}
+	g_frameLock.unlock();
+}
+
+void Profiler::AddCounter(ProfilerCounter counter, int64 amount)
+{
+	if (!IsEnabled())
+		return;
+	g_counters[(size_t)counter].fetch_add(amount, std::memory_order_relaxed);
+}
+const char* Profiler::GetCounterName(ProfilerCounter counter)
+{
+	switch (counter)
+	{
+	case ProfilerCounter::DrawCalls: return "DrawCalls";
+	case ProfilerCounter::TextDrawCalls: return "TextDrawCalls";
+	case ProfilerCounter::TextureUploads: return "TextureUploads";
+	case ProfilerCounter::BufferAllocations: return "BufferAllocations";
+	case ProfilerCounter::LuaTime: return "LuaTime";
+	case ProfilerCounter::MixTime: return "MixTime";
+	default: return "Unknown";
+	}
+}
+
+Vector<ProfilerFrame> Profiler::GetFrames()
+{
+	Vector<ProfilerFrame> frames;
+	g_frameLock.lock();
+	const uint64 count = std::min<uint64>(g_numFrames, frameBufferSize);
+	frames.reserve(count);
+	for (uint64 i = g_numFrames - count; i < g_numFrames; i++)
+		frames.Add(g_frames[i % frameBufferSize]);
+	g_frameLock.unlock();
+	return frames;
+}
+
+Vector<ProfilerZoneSummary> Profiler::GetZoneSummary(int64 begin, int64 end)
+{
+	Vector<ProfilerZoneSummary> summary;
+	for (auto& buffer : GetThreadBuffers())
+	{
+		buffer->lock.lock();
+		ForEachZone(*buffer, [&](const ProfilerZoneRecord& zone)
+		{
+			if (zone.start < begin || zone.start >= end)
+				return;
+			// Few distinct zones are active per frame so a linear search is fine
+			auto it = std::find_if(summary.begin(), summary.end(), [&](const ProfilerZoneSummary& s)
+			{
+				return s.name == zone.name && s.threadId == zone.threadId;
+			});
+			if (it == summary.end())
+				summary.Add({ zone.name, zone.threadId, 1, zone.duration });
+			else
+			{
+				it->calls++;
+				it->totalTime += zone.duration;
+			}
+		});
+		buffer->lock.unlock();
+	}
+	std::sort(summary.begin(), summary.end(), [](const ProfilerZoneSummary& l, const ProfilerZoneSummary& r)
+	{
+		return l.totalTime > r.totalTime;
+	});
+	return summary;
+}
+
+bool Profiler::ExportChromeTrace(const String& path)
+{
+	String json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	auto BeginEvent = [&]()
+	{
+		if (!first)
+			json += ",\n";
+		first = false;
+	};
+
+	for (auto& buffer : GetThreadBuffers())
+	{
+		buffer->lock.lock();
+		BeginEvent();
+		json += Utility::Sprintf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", buffer->id);
+		AppendJsonString(json, *buffer->name);
+		json += "}}";
+
+		ForEachZone(*buffer, [&](const ProfilerZoneRecord& zone)
+		{
+			BeginEvent();
+			json += "{\"name\":";
+			AppendJsonString(json, zone.name);
+			json += Utility::Sprintf(",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld}",
+				zone.threadId, (long long)zone.start, (long long)zone.duration);
+		});
+		buffer->lock.unlock();
+	}
+
+	for (const ProfilerFrame& frame : GetFrames())
+	{
+		BeginEvent();
+		json += Utility::Sprintf("{\"name\":\"FrameTime\",\"ph\":\"C\",\"pid\":1,\"ts\":%lld,\"args\":{\"us\":%lld}}",
+			(long long)frame.start, (long long)frame.duration);
+		for (size_t i = 0; i < (size_t)ProfilerCounter::Count; i++)
+		{
+			json += Utility::Sprintf(",\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"ts\":%lld,\"args\":{\"value\":%lld}}",
+				GetCounterName((ProfilerCounter)i), (long long)frame.start, (long long)frame.counters[i]);
+		}
+	}
+	json += "\n]}\n";
+
+	File file;
+	if (!file.OpenWrite(path))
+		return false;
+	file.Write(json.data(), json.size());
+	file.Close();
+	return true;
+}
+
+void Profiler::m_RecordZone(const char* name, int64 start, int64 end, uint32 depth)
+{
+	ThreadZoneBuffer& buffer = GetThreadBuffer();
+	// Only contended while the zones are being read for the overlay or an export
+	buffer.lock.lock();
+	buffer.zones[buffer.numWritten % buffer.zones.size()] = { name, start, end - start, buffer.id, depth };
+	buffer.numWritten++;
+	buffer.lock.unlock();
+}
+uint32& Profiler::m_Depth()
+{
+	return t_depth;
+}
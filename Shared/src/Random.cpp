@@ -26,5 +26,9 @@ namespace Random
 		uniform_int_distribution<int32> intDist(min, max);
 		return intDist(gen);
 	}
+	void Seed(uint32 seed)
+	{
+		gen.seed(seed);
+	}
 
 }
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "stdafx.h"
+#include "MappedFile.hpp"
+#include "Log.hpp"
+
+/*
+	Unix implementation
+*/
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+bool MappedFile::Open(const String& path)
+{
+	Close();
+
+	int handle = open(*path, O_RDONLY);
+	if(handle == -1)
+	{
+		Logf("Failed to open file for mapping %s: %d", Logger::Severity::Warning, *path, errno);
+		return false;
+	}
+
+	struct stat info;
+	if(fstat(handle, &info) != 0 || info.st_size <= 0)
+	{
+		close(handle);
+		return false;
+	}
+
+	// The mapping keeps its own reference to the file
+	void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, handle, 0);
+	close(handle);
+	if(data == MAP_FAILED)
+	{
+		Logf("Failed to map file %s: %d", Logger::Severity::Warning, *path, errno);
+		return false;
+	}
+
+	m_data = (uint8*)data;
+	m_size = (size_t)info.st_size;
+	return true;
+}
+void MappedFile::Close()
+{
+	if(m_data)
+	{
+		munmap(m_data, m_size);
+		m_data = nullptr;
+		m_size = 0;
+	}
+}
@@ -0,0 +1,142 @@
+#include "stdafx.h"
+#include "FileWatcher.hpp"
+#include "Path.hpp"
+#include "Log.hpp"
+
+static const DWORD notifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+
+// A watched folder with the overlapped read its notifications are written to
+struct FileWatcher::NativeWatch
+{
+	HANDLE directory = INVALID_HANDLE_VALUE;
+	OVERLAPPED overlapped = {};
+	alignas(DWORD) uint8 buffer[64 * 1024];
+
+	// Starts reading the next notifications into the buffer
+	bool ReadChanges()
+	{
+		overlapped = {};
+		return ReadDirectoryChangesW(directory, buffer, sizeof(buffer), TRUE, notifyFilter, NULL, &overlapped, NULL) != FALSE;
+	}
+};
+
+bool FileWatcher::m_OpenNative()
+{
+	// All watched folders report to the same completion port
+	HANDLE port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+	if(port == NULL)
+		return false;
+	m_nativeHandle = (intptr_t)port;
+	return true;
+}
+void FileWatcher::m_CloseNative()
+{
+	for(auto& watch : m_nativeWatches)
+	{
+		// The buffer is written to until the pending read is cancelled
+		DWORD bytes;
+		if(CancelIoEx(watch.second->directory, &watch.second->overlapped) || GetLastError() != ERROR_NOT_FOUND)
+			GetOverlappedResult(watch.second->directory, &watch.second->overlapped, &bytes, TRUE);
+		CloseHandle(watch.second->directory);
+		delete watch.second;
+	}
+	m_nativeWatches.clear();
+	m_nativeFolders.clear();
+	if(m_nativeHandle != -1)
+		CloseHandle((HANDLE)m_nativeHandle);
+	m_nativeHandle = -1;
+}
+bool FileWatcher::m_WatchNative(const String& folder)
+{
+	// A single watch covers all subfolders
+	HANDLE directory = CreateFileW(*Utility::ConvertToWString(folder), FILE_LIST_DIRECTORY,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+	if(directory == INVALID_HANDLE_VALUE)
+		return false;
+
+	int id = m_nativeFolders.empty() ? 0 : m_nativeFolders.rbegin()->first + 1;
+	if(CreateIoCompletionPort(directory, (HANDLE)m_nativeHandle, (ULONG_PTR)id, 0) == NULL)
+	{
+		CloseHandle(directory);
+		return false;
+	}
+
+	NativeWatch* watch = new NativeWatch();
+	watch->directory = directory;
+	m_nativeWatches[id] = watch;
+	m_nativeFolders[id] = folder;
+	return watch->ReadChanges();
+}
+bool FileWatcher::m_ReadNative(float timeout)
+{
+	DWORD length = 0;
+	ULONG_PTR id = 0;
+	OVERLAPPED* overlapped = nullptr;
+	BOOL success = GetQueuedCompletionStatus((HANDLE)m_nativeHandle, &length, &id, &overlapped, (DWORD)(timeout * 1000.0f));
+	if(overlapped == nullptr)
+		return GetLastError() == WAIT_TIMEOUT;
+
+	NativeWatch** watch = m_nativeWatches.Find((int)id);
+	String* folder = m_nativeFolders.Find((int)id);
+	if(!watch || !folder)
+		return true;
+	if(!success)
+	{
+		// The watched folder itself is gone
+		CloseHandle((*watch)->directory);
+		delete *watch;
+		m_nativeWatches.erase((int)id);
+		m_MarkFolderChanged(*folder);
+		m_nativeFolders.erase((int)id);
+		return true;
+	}
+
+	if(length == 0)
+	{
+		// Notifications didn't fit in the buffer, compare against the files on disk instead
+		m_Rescan();
+	}
+	else
+	{
+		for(uint8* ptr = (*watch)->buffer;;)
+		{
+			const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)ptr;
+			WString name(info->FileName, info->FileNameLength / sizeof(wchar_t));
+			String path = Path::Normalize(*folder + Path::sep + Utility::ConvertToUTF8(name));
+
+			// Notifications don't tell files and folders apart, folders are recognized by what's on disk or what's known to be in them
+			if(info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+			{
+				if(Path::IsDirectory(path))
+				{
+					Map<String, Vector<FileInfo>> files = Files::ScanFilesRecursive(path, m_extensions);
+					for(auto& ext : files)
+					{
+						for(FileInfo& file : ext.second)
+							m_MarkChanged(file.fullPath);
+					}
+				}
+				else if(m_MatchesExtension(path))
+				{
+					m_MarkChanged(path);
+				}
+			}
+			else if(info->Action == FILE_ACTION_REMOVED || info->Action == FILE_ACTION_RENAMED_OLD_NAME)
+			{
+				m_MarkFolderChanged(path);
+				if(m_MatchesExtension(path))
+					m_MarkChanged(path);
+			}
+			else if(m_MatchesExtension(path) && !Path::IsDirectory(path))
+			{
+				m_MarkChanged(path);
+			}
+
+			if(info->NextEntryOffset == 0)
+				break;
+			ptr += info->NextEntryOffset;
+		}
+	}
+	return (*watch)->ReadChanges();
+}
@@ -0,0 +1,63 @@
+#include "stdafx.h"
+#include "MappedFile.hpp"
+#include "Log.hpp"
+
+/*
+	Windows implementation
+*/
+MappedFile::~MappedFile()
+{
+	Close();
+}
+bool MappedFile::Open(const String& path)
+{
+	Close();
+	WString wstringPath = Utility::ConvertToWString(path);
+	HANDLE h = CreateFileW(*wstringPath,
+		GENERIC_READ, // Desired Access
+		FILE_SHARE_READ | FILE_SHARE_DELETE, // Mapped files can still be deleted or replaced, they stay readable until unmapped
+		nullptr,
+		OPEN_EXISTING,
+		0, 0);
+	if(h == INVALID_HANDLE_VALUE)
+	{
+		Logf("Failed to open file for mapping %s: %s", Logger::Severity::Warning, *path, Utility::WindowsFormatMessage(GetLastError()));
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(h, &size) || size.QuadPart <= 0)
+	{
+		CloseHandle(h);
+		return false;
+	}
+
+	// The view keeps the mapping and the file open
+	HANDLE mapping = CreateFileMappingW(h, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	CloseHandle(h);
+	if(mapping == nullptr)
+	{
+		Logf("Failed to map file %s: %s", Logger::Severity::Warning, *path, Utility::WindowsFormatMessage(GetLastError()));
+		return false;
+	}
+	void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+	CloseHandle(mapping);
+	if(data == nullptr)
+	{
+		Logf("Failed to map file %s: %s", Logger::Severity::Warning, *path, Utility::WindowsFormatMessage(GetLastError()));
+		return false;
+	}
+
+	m_data = (uint8*)data;
+	m_size = (size_t)size.QuadPart;
+	return true;
+}
+void MappedFile::Close()
+{
+	if(m_data)
+	{
+		UnmapViewOfFile(m_data);
+		m_data = nullptr;
+		m_size = 0;
+	}
+}
@@ -0,0 +1,85 @@
+#include "stdafx.h"
+#include "WorkerPool.hpp"
+
+WorkerPool::WorkerPool(size_t numThreads)
+{
+	assert(numThreads > 0);
+	m_threads.reserve(numThreads);
+	for(size_t i = 0; i < numThreads; i++)
+		m_threads.emplace_back(&WorkerPool::m_Worker, this);
+}
+WorkerPool::~WorkerPool()
+{
+	// Destroyed outside of the lock, in case their destructors queue or cancel tasks
+	List<QueuedTask> dropped;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_terminate = true;
+		dropped.swap(m_tasks);
+	}
+	dropped.clear();
+	m_taskAdded.notify_all();
+	for(Thread& thread : m_threads)
+		thread.join();
+}
+
+void WorkerPool::Queue(Task task, const void* owner)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_tasks.AddBack({ std::move(task), owner });
+	}
+	m_taskAdded.notify_one();
+}
+size_t WorkerPool::Cancel(const void* owner)
+{
+	List<QueuedTask> dropped;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		for(auto it = m_tasks.begin(); it != m_tasks.end();)
+		{
+			auto next = std::next(it);
+			if(it->owner == owner)
+				dropped.splice(dropped.end(), m_tasks, it);
+			it = next;
+		}
+		if(m_tasks.empty() && m_numRunning == 0)
+			m_taskDone.notify_all();
+	}
+	return dropped.size();
+}
+void WorkerPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+	m_taskDone.wait(lock, [this]() { return m_tasks.empty() && m_numRunning == 0; });
+}
+size_t WorkerPool::GetNumQueued()
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_tasks.size();
+}
+
+void WorkerPool::m_Worker()
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+	while(true)
+	{
+		m_taskAdded.wait(lock, [this]() { return m_terminate || !m_tasks.empty(); });
+		if(m_terminate)
+			break;
+
+		Task task = std::move(m_tasks.front().task);
+		m_tasks.pop_front();
+		m_numRunning++;
+		lock.unlock();
+
+		task();
+		// Whatever the task holds on to is released before the next one runs
+		task = Task();
+
+		lock.lock();
+		m_numRunning--;
+		if(m_tasks.empty() && m_numRunning == 0)
+			m_taskDone.notify_all();
+	}
+}
@@ -0,0 +1,129 @@
+#include "stdafx.h"
+#include <GUI/AnimationLoader.hpp>
+#include <Shared/WorkerPool.hpp>
+using namespace Graphics;
+
+static size_t CountThreads()
+{
+#ifdef __linux__
+	return Path::GetSubDirs("/proc/self/task").size();
+#else
+	return 0;
+#endif
+}
+
+// Waits for a condition that is met by the decode pool
+template<typename Condition>
+static bool WaitFor(Condition condition)
+{
+	Timer timer;
+	while(!condition())
+	{
+		if(timer.SecondsAsFloat() > 20.0f)
+			return false;
+		std::this_thread::yield();
+	}
+	return true;
+}
+
+Test("GUI.AnimationLoader.Stress")
+{
+	const int numAnimations = 100;
+	const int numFrames = 6;
+	const String root = Path::Normalize(Path::GetCurrentPath() + "/animation_test");
+	if(Path::IsDirectory(root))
+		Path::DeleteDir(root);
+	TestEnsure(Path::CreateDir(root));
+
+	// Every frame gets its own color, so the order of decoded frames can be checked
+	for(int a = 0; a < numAnimations; a++)
+	{
+		const String folder = Path::Normalize(root + Utility::Sprintf("/%d", a));
+		TestEnsure(Path::CreateDir(folder));
+		for(int f = 0; f < numFrames; f++)
+		{
+			Image image = ImageRes::Create(Vector2i(8, 8));
+			for(int i = 0; i < 64; i++)
+				image->GetBits()[i] = Colori((uint8)(f * 10), (uint8)a, 0, 255);
+			image->SavePNG(Path::Normalize(folder + Utility::Sprintf("/%02d.png", f)));
+		}
+	}
+
+	AnimationLoader::GetPool();
+	const size_t baseThreads = CountThreads();
+
+	Vector<Ref<ImageAnimation>> animations;
+	for(int a = 0; a < numAnimations; a++)
+	{
+		Ref<ImageAnimation> ia = std::make_shared<ImageAnimation>();
+		ia->Compressed = true;
+		ia->TimesToLoop = 0;
+		ia->LoopCounter = 0;
+		ia->SecondsPerFrame = 1.0f / 60.0f;
+		ia->LoadComplete.store(false);
+		ia->Cancelled.store(false);
+		ia->State = nullptr;
+		AnimationLoader::Load(ia, Files::ScanFiles(Path::Normalize(root + Utility::Sprintf("/%d", a))));
+		animations.Add(ia);
+	}
+
+	// Loading doesn't create a thread per animation
+	TestEnsure(CountThreads() == baseThreads);
+	TestEnsure(WaitFor([&]()
+	{
+		for(auto& ia : animations)
+		{
+			if(!ia->LoadComplete.load())
+				return false;
+		}
+		return true;
+	}));
+
+	// Play every animation for two loops
+	for(int step = 1; step < numFrames * 2; step++)
+	{
+		const int frame = step % numFrames;
+		for(int a = 0; a < numAnimations; a++)
+		{
+			Ref<ImageAnimation> ia = animations[a];
+			Image image;
+			TestEnsure(WaitFor([&]() { return (image = AnimationLoader::TakeFrame(ia, frame)) != nullptr; }));
+			TestEnsure(image->GetBits()[0].x == frame * 10 && image->GetBits()[0].y == a);
+
+			ia->LoadMutex.lock();
+			TestEnsure(ia->DecodedFrames.size() <= (size_t)AnimationLoader::maxBufferedFrames);
+			ia->LoadMutex.unlock();
+		}
+		TestEnsure(CountThreads() == baseThreads);
+	}
+
+	for(auto& ia : animations)
+	{
+		AnimationLoader::Cancel(*ia);
+		TestEnsure(ia->PendingTasks.load() == 0);
+	}
+	TestEnsure(CountThreads() == baseThreads);
+
+	// Cancelling right after loading drops the queued loads instead of waiting for them
+	animations.clear();
+	for(int a = 0; a < numAnimations; a++)
+	{
+		Ref<ImageAnimation> ia = std::make_shared<ImageAnimation>();
+		ia->Compressed = true;
+		ia->SecondsPerFrame = 1.0f / 60.0f;
+		ia->LoadComplete.store(false);
+		ia->Cancelled.store(false);
+		ia->State = nullptr;
+		AnimationLoader::Load(ia, Files::ScanFiles(Path::Normalize(root + Utility::Sprintf("/%d", a))));
+		animations.Add(ia);
+	}
+	for(auto& ia : animations)
+	{
+		AnimationLoader::Cancel(*ia);
+		TestEnsure(ia->PendingTasks.load() == 0);
+	}
+	TestEnsure(AnimationLoader::GetPool().GetNumQueued() == 0);
+	Logf("Decoded %d animations on %d threads", Logger::Severity::Info, numAnimations, (int32)AnimationLoader::GetPool().GetNumThreads());
+
+	Path::DeleteDir(root);
+}
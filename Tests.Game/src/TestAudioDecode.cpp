@@ -0,0 +1,213 @@
+#include "stdafx.h"
+#include <Audio/Audio.hpp>
+#include <Audio/ProgressivePcm.hpp>
+#include <thread>
+
+#ifdef VORBISENC_FOUND
+#include <vorbis/vorbisenc.h>
+#include <vorbis/vorbisfile.h>
+
+// Encodes a few tones over some noise, so it doesn't compress to nothing
+static bool WriteTestOgg(const String& path, uint32 sampleRate, float duration)
+{
+	File file;
+	if (!file.OpenWrite(path))
+		return false;
+
+	vorbis_info vi;
+	vorbis_info_init(&vi);
+	if (vorbis_encode_init_vbr(&vi, 2, sampleRate, 0.4f) != 0)
+		return false;
+	vorbis_comment vc;
+	vorbis_comment_init(&vc);
+	vorbis_dsp_state vd;
+	vorbis_analysis_init(&vd, &vi);
+	vorbis_block vb;
+	vorbis_block_init(&vd, &vb);
+	ogg_stream_state os;
+	ogg_stream_init(&os, 1);
+
+	ogg_page og;
+	ogg_packet op;
+	auto writePage = [&]()
+	{
+		file.Write(og.header, og.header_len);
+		file.Write(og.body, og.body_len);
+	};
+
+	ogg_packet header, headerComment, headerCode;
+	vorbis_analysis_headerout(&vd, &vc, &header, &headerComment, &headerCode);
+	ogg_stream_packetin(&os, &header);
+	ogg_stream_packetin(&os, &headerComment);
+	ogg_stream_packetin(&os, &headerCode);
+	while (ogg_stream_flush(&os, &og) != 0)
+		writePage();
+
+	const uint32 numFrames = (uint32)(duration * sampleRate);
+	const uint32 blockSize = 4096;
+	uint32 noise = 1;
+	for (uint32 frame = 0;; frame += blockSize)
+	{
+		const uint32 count = frame < numFrames ? Math::Min(blockSize, numFrames - frame) : 0;
+		if (count > 0)
+		{
+			float** buffer = vorbis_analysis_buffer(&vd, count);
+			for (uint32 i = 0; i < count; i++)
+			{
+				const float t = (float)(frame + i) / sampleRate;
+				noise = noise * 1664525u + 1013904223u;
+				const float n = ((float)(noise >> 8) / (float)(1 << 24) - 0.5f) * 0.1f;
+				buffer[0][i] = 0.3f * sinf(2.0f * Math::pi * 220.0f * t) + n;
+				buffer[1][i] = 0.3f * sinf(2.0f * Math::pi * 330.0f * t) + n;
+			}
+		}
+		// Zero frames end the stream
+		vorbis_analysis_wrote(&vd, count);
+
+		while (vorbis_analysis_blockout(&vd, &vb) == 1)
+		{
+			vorbis_analysis(&vb, nullptr);
+			vorbis_bitrate_addblock(&vb);
+			while (vorbis_bitrate_flushpacket(&vd, &op))
+			{
+				ogg_stream_packetin(&os, &op);
+				while (ogg_stream_pageout(&os, &og) != 0)
+					writePage();
+			}
+		}
+		if (count == 0)
+			break;
+	}
+	while (ogg_stream_flush(&os, &og) != 0)
+		writePage();
+
+	ogg_stream_clear(&os);
+	vorbis_block_clear(&vb);
+	vorbis_dsp_clear(&vd);
+	vorbis_comment_clear(&vc);
+	vorbis_info_clear(&vi);
+	return true;
+}
+
+Test("Audio.Decode.PreloadOgg")
+{
+	Audio* audio = new Audio();
+	TestEnsure(audio->Init(false));
+
+	// Encoded at the output rate so loading is just decoding
+	const String path = Path::Normalize(Path::GetCurrentPath() + "/decode_test.ogg");
+	const float duration = 180.0f;
+	const uint32 sampleRate = audio->GetSampleRate();
+	TestEnsure(WriteTestOgg(path, sampleRate, duration));
+
+	// Decoding without storing anything, for comparison
+	Timer timer;
+	int64 numFrames = 0;
+	{
+		OggVorbis_File ovf;
+		TestEnsure(ov_fopen(*path, &ovf) == 0);
+		float** buffer;
+		long r;
+		while ((r = ov_read_float(&ovf, &buffer, 4096, nullptr)) != 0)
+		{
+			if (r > 0)
+				numFrames += r;
+		}
+		ov_clear(&ovf);
+	}
+	const float decodeTime = timer.SecondsAsFloat();
+	TestEnsure(numFrames == (int64)(duration * sampleRate));
+
+	// Creating the stream only waits for the start of the song, the rest is decoded while it plays
+	timer.Restart();
+	Ref<AudioStream> stream = audio->CreateStream(path, true);
+	const float createTime = timer.SecondsAsFloat();
+	TestEnsure(stream);
+	stream->WaitForDecode();
+	const float preloadTime = timer.SecondsAsFloat();
+	// The count is the number of frames that were decoded once decoding is done
+	TestEnsure(stream->GetPCMCount() == (uint64)numFrames);
+	TestEnsure(stream->GetSampleRate() == sampleRate);
+
+	Logf("Decoding %.0f seconds of ogg took %.1fms, preloading it took %.1fms (%.1fms until it could play)", Logger::Severity::Info,
+		duration, decodeTime * 1000.0f, preloadTime * 1000.0f, createTime * 1000.0f);
+
+	stream.reset();
+	delete audio;
+	Path::Delete(path);
+}
+#endif
+
+// Writes the frame index to the left channel and its negation to the right one, slower than it is read
+static void SlowDecode(ProgressivePcm& pcm, uint64 numFrames)
+{
+	constexpr uint32 blockSize = 1000;
+	float block[blockSize * 2];
+	for (uint64 frame = 0; frame < numFrames && !pcm.IsStopping(); frame += blockSize)
+	{
+		const uint32 count = (uint32)Math::Min<uint64>(blockSize, numFrames - frame);
+		for (uint32 i = 0; i < count; i++)
+		{
+			block[i * 2] = (float)(frame + i);
+			block[i * 2 + 1] = -(float)(frame + i);
+		}
+		pcm.Append(block, count);
+		std::this_thread::sleep_for(std::chrono::microseconds(500));
+	}
+}
+
+Test("Audio.Decode.Progressive")
+{
+	const uint64 numFrames = 48000 * 4;
+	ProgressivePcm pcm;
+	pcm.Start(numFrames, [&](ProgressivePcm& pcm) { SlowDecode(pcm, numFrames); });
+
+	// Playback starts once the lead time is decoded
+	TestEnsure(pcm.WaitFor(4800) == 4800);
+	TestEnsure(pcm.IsDecoding());
+
+	// Read in mixer sized blocks as fast as possible, every frame must be there in order
+	uint64 position = 0;
+	size_t numUnderruns = 0;
+	size_t numWrong = 0;
+	while (true)
+	{
+		if (pcm.GetDecodedFrames() < position + 384 && pcm.IsDecoding())
+			numUnderruns++;
+		const uint64 available = pcm.WaitFor(position + 384);
+		if (available <= position)
+			break;
+		const float* data = pcm.GetData();
+		for (uint64 i = position; i < available; i++)
+		{
+			if (data[i * 2] != (float)i || data[i * 2 + 1] != -(float)i)
+				numWrong++;
+		}
+		position = available;
+	}
+	Logf("Read %d frames while decoding, caught up with the decoder %d times", Logger::Severity::Info, (int32)position, (int32)numUnderruns);
+	TestEnsure(numWrong == 0);
+	TestEnsure(position == numFrames);
+	TestEnsure(numUnderruns > 0);
+	TestEnsure(!pcm.IsDecoding());
+	TestEnsure(pcm.GetNumFrames() == numFrames);
+}
+
+Test("Audio.Decode.ProgressiveEnd")
+{
+	// Decoding less than expected shortens the pcm
+	ProgressivePcm shorter;
+	shorter.Start(10000, [](ProgressivePcm& pcm) { SlowDecode(pcm, 6000); });
+	TestEnsure(shorter.WaitFor(10000) == 6000);
+	TestEnsure(shorter.GetNumFrames() == 6000);
+
+	// Stopping doesn't wait for the rest
+	ProgressivePcm stopped;
+	stopped.Start(48000 * 600, [](ProgressivePcm& pcm) { SlowDecode(pcm, 48000 * 600); });
+	TestEnsure(stopped.WaitFor(1000) == 1000);
+	Timer timer;
+	stopped.Stop();
+	TestEnsure(timer.SecondsAsFloat() < 1.0f);
+	TestEnsure(!stopped.IsDecoding());
+	TestEnsure(stopped.WaitFor(48000 * 600) < 48000 * 600);
+}
@@ -0,0 +1,105 @@
+#include "stdafx.h"
+#include <Audio/Audio.hpp>
+#include <Audio/Audio_Impl.hpp>
+#include <Audio/AudioOutput.hpp>
+#include <atomic>
+#include <thread>
+
+// Measures device timing without a loopback, using the dummy SDL driver that asks for a buffer every period
+#ifndef _WIN32
+#include "SDL2/SDL.h"
+
+// Passes callbacks on to the mixer and records when they came and where they ended in the mixed blocks
+class MixRecorder : public IMixer
+{
+public:
+	static constexpr uint32 maxCallbacks = 1024;
+
+	MixRecorder(Audio_Impl* impl) : m_impl(impl)
+	{
+	}
+
+	void Mix(void* data, uint32& numSamples) override
+	{
+		const uint32 index = numCallbacks.load(std::memory_order_relaxed);
+		if (index >= maxCallbacks)
+			return;
+		times[index] = m_timer.Seconds();
+		sizes[index] = numSamples;
+		m_impl->Mix(data, numSamples);
+		// A whole number of blocks was used
+		aligned[index] = m_impl->m_remainingSamples == 0;
+		numCallbacks.store(index + 1, std::memory_order_release);
+	}
+
+	double times[maxCallbacks];
+	uint32 sizes[maxCallbacks];
+	bool aligned[maxCallbacks];
+	std::atomic<uint32> numCallbacks = { 0 };
+
+private:
+	Audio_Impl* m_impl;
+	Timer m_timer;
+};
+
+Test("Audio.Output.PeriodAlignment")
+{
+	// Switched while the subsystem is held, so the audio output doesn't reinitialize the default driver
+	TestEnsure(SDL_InitSubSystem(SDL_INIT_AUDIO) == 0);
+	if (SDL_AudioInit("dummy") != 0)
+	{
+		Logf("Dummy audio driver not available: %s", Logger::Severity::Warning, SDL_GetError());
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+		return;
+	}
+
+	for (uint32 bufferSize : { 256u, 441u, 512u, 1024u })
+	{
+		Audio* audio = new Audio();
+		TestEnsure(audio->Init(false, bufferSize));
+		Audio_Impl* impl = audio->GetImpl();
+		const uint32 period = impl->output->GetPeriodSize();
+		const uint32 blockLength = impl->GetBlockLength();
+		TestEnsure(period > 0 && blockLength <= 384);
+
+		MixRecorder recorder(impl);
+		impl->output->Start(&recorder);
+		const double expected = (double)period / (double)impl->GetSampleRate();
+		std::this_thread::sleep_for(std::chrono::duration<double>(expected * 101));
+		impl->output->Start(impl);
+		// A callback may still be running
+		std::this_thread::sleep_for(std::chrono::duration<double>(expected * 2));
+
+		const uint32 numCallbacks = recorder.numCallbacks.load(std::memory_order_acquire);
+		TestEnsure(numCallbacks > 10);
+		uint32 numAligned = 0;
+		double sum = 0.0, sumSquared = 0.0, maxDeviation = 0.0;
+		for (uint32 i = 0; i < numCallbacks; i++)
+		{
+			TestEnsure(recorder.sizes[i] == period);
+			if (recorder.aligned[i])
+				numAligned++;
+			if (i == 0)
+				continue;
+			const double interval = recorder.times[i] - recorder.times[i - 1];
+			sum += interval;
+			sumSquared += interval * interval;
+			maxDeviation = Math::Max(maxDeviation, fabs(interval - expected));
+		}
+		const double mean = sum / (numCallbacks - 1);
+		const double deviation = sqrt(Math::Max(sumSquared / (numCallbacks - 1) - mean * mean, 0.0));
+		Logf("Buffer of %d: period %d, blocks of %d, %d/%d callbacks aligned, interval %.2fms (expected %.2fms), jitter %.3fms, worst %.3fms",
+			Logger::Severity::Info, bufferSize, period, blockLength, numAligned, numCallbacks,
+			mean * 1000.0, expected * 1000.0, deviation * 1000.0, maxDeviation * 1000.0);
+
+		// Every callback ends on a block boundary when the block length divides the period
+		if (period % blockLength == 0)
+			TestEnsure(numAligned == numCallbacks);
+
+		delete audio;
+	}
+
+	SDL_AudioInit(nullptr);
+	SDL_QuitSubSystem(SDL_INIT_AUDIO);
+}
+#endif
@@ -0,0 +1,210 @@
+#include "stdafx.h"
+#include <Audio/DSP.hpp>
+
+static const uint32 sampleRate = 48000;
+
+// Filters one channel with a cascade of scalar biquads, the way effects filtered samples before
+static void FilterScalar(Vector<BQF>& cascade, float* out, uint32 numFrames, uint32 channel)
+{
+	for (uint32 i = 0; i < numFrames; i++)
+	{
+		float sample = out[i * 2 + channel];
+		for (BQF& filter : cascade)
+			sample = filter.Update(sample);
+		out[i * 2 + channel] = sample;
+	}
+}
+
+// Sine on the left, cosine on the right
+static Vector<float> MakeTone(float freq, uint32 numFrames)
+{
+	Vector<float> tone(numFrames * 2);
+	const double w = 2.0 * Math::pi * freq / sampleRate;
+	for (uint32 i = 0; i < numFrames; i++)
+	{
+		tone[i * 2] = (float)sin(w * i) * 0.5f;
+		tone[i * 2 + 1] = (float)cos(w * i) * 0.5f;
+	}
+	return tone;
+}
+
+// Gain in dB of one channel, after the filter has settled
+static float GetGain(const Vector<float>& in, const Vector<float>& out, uint32 channel, uint32 skip)
+{
+	double inPower = 0.0, outPower = 0.0;
+	for (size_t i = skip; i < in.size() / 2; i++)
+	{
+		inPower += in[i * 2 + channel] * in[i * 2 + channel];
+		outPower += out[i * 2 + channel] * out[i * 2 + channel];
+	}
+	return (float)(10.0 * log10(Math::Max(outPower, 1e-20) / inPower));
+}
+
+Test("Audio.Biquad.FrequencyResponse")
+{
+	struct Cascade
+	{
+		const char* name;
+		Vector<BQF> left;
+		Vector<BQF> right;
+	};
+	Vector<Cascade> cascades;
+	{
+		Cascade c = { "Low-pass/High-pass" };
+		c.left.resize(1);
+		c.right.resize(1);
+		c.left[0].SetLowPass(0.707f, 1000.0f, (float)sampleRate);
+		c.right[0].SetHighPass(2.0f, 2000.0f, (float)sampleRate);
+		cascades.Add(c);
+	}
+	{
+		Cascade c = { "Peaking/High-shelf" };
+		c.left.resize(1);
+		c.right.resize(1);
+		c.left[0].SetPeaking(1.0f, 3000.0f, 9.0f, (float)sampleRate);
+		c.right[0].SetHighShelf(1.5f, 4000.0f, -8.0f, (float)sampleRate);
+		cascades.Add(c);
+	}
+	{
+		Cascade c = { "Low-pass with peak" };
+		c.left.resize(2);
+		c.left[0].SetLowPass(1.0f, 5000.0f, (float)sampleRate);
+		c.left[1].SetPeaking(0.8f, 5000.0f, 6.0f, (float)sampleRate);
+		c.right = c.left;
+		cascades.Add(c);
+	}
+	{
+		Cascade c = { "Phaser all-pass" };
+		c.left.resize(StereoBiquad::maxSections);
+		c.right.resize(StereoBiquad::maxSections);
+		for (uint32 i = 0; i < StereoBiquad::maxSections; i++)
+		{
+			c.left[i].SetAllPass(0.707f, 800.0f, (float)sampleRate);
+			c.right[i].SetAllPass(0.707f, 6000.0f, (float)sampleRate);
+		}
+		cascades.Add(c);
+	}
+
+	const uint32 numFrames = 16384;
+	const uint32 skip = 8192;
+	for (Cascade& cascade : cascades)
+	{
+		float maxError = 0.0f;
+		for (float freq = 40.0f; freq < 20000.0f; freq *= 1.5f)
+		{
+			const Vector<float> tone = MakeTone(freq, numFrames);
+
+			Vector<float> reference = tone;
+			Vector<BQF> left = cascade.left, right = cascade.right;
+			FilterScalar(left, reference.data(), numFrames, 0);
+			FilterScalar(right, reference.data(), numFrames, 1);
+
+			Vector<float> filtered = tone;
+			StereoBiquad filter((uint32)cascade.left.size());
+			for (uint32 i = 0; i < cascade.left.size(); i++)
+				filter.SetSection(i, cascade.left[i], cascade.right[i]);
+			// In uneven parts, like the mixer would
+			for (uint32 i = 0; i < numFrames;)
+			{
+				const uint32 count = Math::Min(numFrames - i, 1 + (i * 7) % 500);
+				filter.Process(filtered.data() + i * 2, count);
+				i += count;
+			}
+
+			for (uint32 c = 0; c < 2; c++)
+			{
+				const float referenceGain = GetGain(tone, reference, c, skip);
+				const float gain = GetGain(tone, filtered, c, skip);
+				maxError = Math::Max(maxError, fabsf(gain - referenceGain));
+			}
+		}
+		Logf("%s: largest difference from scalar filter %.5fdB", Logger::Severity::Info, cascade.name, maxError);
+		TestEnsure(maxError < 0.01f);
+	}
+}
+
+Test("Audio.Biquad.Sweep")
+{
+	// A low-pass sweeping up and down twice a second, like the wobble effect
+	const uint32 numFrames = sampleRate * 2;
+	Vector<float> noise(numFrames * 2);
+	uint32 seed = 1;
+	for (float& sample : noise)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		sample = ((float)(seed >> 8) / (float)(1 << 24) - 0.5f);
+	}
+	auto getFreq = [&](uint32 i)
+	{
+		const float f = fabsf(2.0f * (float)(i % (sampleRate / 2)) / (float)(sampleRate / 2) - 1.0f);
+		return 300.0f * powf(40.0f, f);
+	};
+
+	// Coefficients set every sample
+	Vector<float> reference = noise;
+	BQF filters[2];
+	for (uint32 i = 0; i < numFrames; i++)
+	{
+		for (uint32 c = 0; c < 2; c++)
+		{
+			filters[c].SetLowPass(1.414f, getFreq(i), (float)sampleRate);
+			reference[i * 2 + c] = filters[c].Update(reference[i * 2 + c]);
+		}
+	}
+
+	// Coefficients set once per block
+	Vector<float> filtered = noise;
+	StereoBiquad filter;
+	for (uint32 i = 0; i < numFrames; i += StereoBiquad::blockSize)
+	{
+		const uint32 count = Math::Min(StereoBiquad::blockSize, numFrames - i);
+		BQF target;
+		target.SetLowPass(1.414f, getFreq(i + count - 1), (float)sampleRate);
+		filter.SetSection(0, target);
+		filter.Process(filtered.data() + i * 2, count);
+	}
+
+	double signal = 0.0, error = 0.0;
+	float maxStep = 0.0f;
+	for (size_t i = 0; i < reference.size(); i++)
+	{
+		signal += reference[i] * reference[i];
+		error += (filtered[i] - reference[i]) * (filtered[i] - reference[i]);
+		if (i >= 2)
+			maxStep = Math::Max(maxStep, fabsf(filtered[i] - filtered[i - 2]));
+	}
+	const float errorDb = (float)(10.0 * log10(error / signal));
+	Logf("Block-rate sweep differs from per-sample sweep by %.1fdB", Logger::Severity::Info, errorDb);
+	TestEnsure(errorDb < -30.0f);
+	TestEnsure(maxStep < 1.0f);
+}
+
+Test("Audio.Biquad.Throughput")
+{
+	const uint32 numFrames = sampleRate * 10;
+	const uint32 numSections = 6;
+	const Vector<float> tone = MakeTone(440.0f, numFrames);
+	Vector<BQF> cascade(numSections);
+	for (BQF& section : cascade)
+		section.SetAllPass(0.707f, 2000.0f, (float)sampleRate);
+
+	Vector<float> reference = tone;
+	Timer timer;
+	Vector<BQF> left = cascade, right = cascade;
+	FilterScalar(left, reference.data(), numFrames, 0);
+	FilterScalar(right, reference.data(), numFrames, 1);
+	const float scalarTime = timer.SecondsAsFloat();
+
+	Vector<float> filtered = tone;
+	StereoBiquad filter(numSections);
+	for (uint32 i = 0; i < numSections; i++)
+		filter.SetSection(i, cascade[i]);
+	timer.Restart();
+	for (uint32 i = 0; i < numFrames; i += 384)
+		filter.Process(filtered.data() + i * 2, Math::Min(384u, numFrames - i));
+	const float stereoTime = timer.SecondsAsFloat();
+
+	Logf("%d biquads over 10 seconds: %.1fms per channel, %.1fms for both channels at once", Logger::Severity::Info,
+		numSections, scalarTime * 1000.0f, stereoTime * 1000.0f);
+	TestEnsure(filtered != tone);
+}
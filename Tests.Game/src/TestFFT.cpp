@@ -0,0 +1,97 @@
+#include "stdafx.h"
+#include <Audio/FFT.hpp>
+#include <Audio/SpectrumAnalyzer.hpp>
+
+// Transform of real input by its definition, with the same packing as RealFFT
+static Vector<double> NaiveDFT(const Vector<float>& in)
+{
+	const size_t size = in.size();
+	Vector<double> out(size);
+	for (size_t k = 0; k <= size / 2; k++)
+	{
+		double real = 0.0, imag = 0.0;
+		for (size_t n = 0; n < size; n++)
+		{
+			const double angle = -2.0 * Math::pi * (double)(k * n % size) / (double)size;
+			real += in[n] * cos(angle);
+			imag += in[n] * sin(angle);
+		}
+		if (k == 0)
+			out[0] = real;
+		else if (k == size / 2)
+			out[1] = real;
+		else
+		{
+			out[k * 2] = real;
+			out[k * 2 + 1] = imag;
+		}
+	}
+	return out;
+}
+
+Test("Audio.FFT.MatchesDFT")
+{
+	uint32 seed = 1;
+	RealFFT fft;
+	for (uint32 size = 4; size <= 2048; size *= 2)
+	{
+		Vector<float> in(size);
+		for (float& sample : in)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			sample = (float)(seed >> 8) / (float)(1 << 24) * 2.0f - 1.0f;
+		}
+
+		fft.SetSize(size);
+		TestEnsure(fft.GetSize() == size);
+		Vector<float> out = in;
+		fft.Forward(out.data());
+		const Vector<double> reference = NaiveDFT(in);
+
+		double maxError = 0.0;
+		for (uint32 i = 0; i < size; i++)
+			maxError = Math::Max(maxError, fabs(out[i] - reference[i]));
+		// Relative to the expected magnitude of a bin of noise
+		const double relativeError = maxError / sqrt((double)size);
+		Logf("FFT of %d samples: largest relative error %.2e", Logger::Severity::Info, size, relativeError);
+		TestEnsure(relativeError < 1e-5);
+	}
+
+	// Sizes are rounded down to a power of two
+	fft.SetSize(384);
+	TestEnsure(fft.GetSize() == 256);
+}
+
+Test("Audio.FFT.Spectrum")
+{
+	const uint32 sampleRate = 48000;
+	SpectrumAnalyzer analyzer;
+	analyzer.SetSampleRate(sampleRate);
+	for (uint32 numBuckets : { 16u, 32u })
+	{
+		analyzer.SetSize(2048, numBuckets);
+		TestEnsure(analyzer.GetWindowSize() == 2048 && analyzer.GetNumBuckets() == numBuckets);
+
+		// A 3 kHz tone pushed in mixer sized blocks
+		Vector<float> block(384 * 2);
+		for (uint32 b = 0; b < 16; b++)
+		{
+			for (uint32 i = 0; i < 384; i++)
+			{
+				const float sample = (float)sin(2.0 * Math::pi * 3000.0 * (b * 384 + i) / sampleRate) * 0.5f;
+				block[i * 2] = block[i * 2 + 1] = sample;
+			}
+			analyzer.Push(block.data(), 384);
+		}
+
+		Vector<float> buckets(numBuckets), bucketsN(numBuckets);
+		analyzer.Process(buckets.data(), bucketsN.data());
+		const uint32 loudest = (uint32)(std::max_element(bucketsN.begin(), bucketsN.end()) - bucketsN.begin());
+		// 3 kHz is the start of bucket 11 of 16
+		TestEnsure(loudest == (numBuckets == 16 ? 11 : 22) || loudest == (numBuckets == 16 ? 10 : 21));
+		// Half the amplitude after the Hann window
+		TestEnsure(fabsf(bucketsN[loudest] - 0.25f) < 0.01f);
+		for (float value : buckets)
+			TestEnsure(std::isfinite(value));
+	}
+}
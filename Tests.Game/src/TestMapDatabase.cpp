@@ -0,0 +1,366 @@
+#include "stdafx.h"
+#include <Beatmap/MapDatabase.hpp>
+#include <Beatmap/Database.hpp>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+static void WriteChart(const String& path, const String& title)
+{
+	String chart = "title=" + title + "\r\n"
+		"artist=Test\r\n"
+		"effector=Test\r\n"
+		"difficulty=extended\r\n"
+		"level=10\r\n"
+		"t=120\r\n"
+		"m=song.ogg\r\n"
+		"o=0\r\n"
+		"--\r\n"
+		"0000|00|--\r\n"
+		"--\r\n";
+	File file;
+	TestEnsure(file.OpenWrite(path));
+	file.Write(*chart, chart.size());
+}
+
+// Applies changes found by the database until the condition is met
+template<typename Condition>
+static bool UpdateUntil(MapDatabase& database, Condition condition)
+{
+	Timer timer;
+	while(!condition())
+	{
+		if(timer.SecondsAsFloat() > 20.0f)
+			return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		database.Update();
+	}
+	return true;
+}
+
+Test("MapDatabase.WatchChanges")
+{
+	const String root = Path::Normalize(Path::GetCurrentPath() + "/map_database_test");
+	if(Path::IsDirectory(root))
+		Path::DeleteDir(root);
+	TestEnsure(Path::CreateDir(root));
+	const String songs = Path::Normalize(root + "/songs");
+	TestEnsure(Path::CreateDir(songs));
+	TestEnsure(Path::CreateDir(Path::Normalize(songs + "/first")));
+	WriteChart(Path::Normalize(songs + "/first/chart.ksh"), "First");
+
+	// Keep the test database away from the game's one
+	const String gameDir = Path::gameDir;
+	Path::gameDir = root;
+	{
+		MapDatabase database;
+		database.AddSearchPath(songs);
+
+		// Search status is reported from the search thread
+		std::atomic<size_t> numScans(0);
+		std::mutex statusLock;
+		String lastStatus;
+		database.OnSearchStatusUpdated.AddLambda([&](String status)
+		{
+			if(status == "[START] Chart Database - Enumerate Files and Folders")
+				numScans++;
+			std::lock_guard<std::mutex> lock(statusLock);
+			lastStatus = status;
+		});
+		size_t numFolderAdds = 0;
+		database.OnFoldersAdded.AddLambda([&](Vector<FolderIndex*> folders) { numFolderAdds++; });
+
+		database.StartSearching();
+		TestEnsure(UpdateUntil(database, [&]() { return !database.IsSearching() && database.GetChartMap().size() == 1; }));
+		TestEnsure(numScans == 1);
+
+		// Extracting a chart pack adds all of its charts at once
+		const String pack = Path::Normalize(songs + "/pack");
+		const int32 numPackCharts = 20;
+		numFolderAdds = 0;
+		TestEnsure(Path::CreateDir(pack));
+		for(int32 i = 0; i < numPackCharts; i++)
+		{
+			const String folder = Path::Normalize(pack + Utility::Sprintf("/%d", i));
+			TestEnsure(Path::CreateDir(folder));
+			WriteChart(Path::Normalize(folder + "/chart.ksh"), Utility::Sprintf("Pack %d", i));
+		}
+		TestEnsure(UpdateUntil(database, [&]() { return database.GetChartMap().size() == 1 + numPackCharts; }));
+		TestEnsure(numFolderAdds == 1);
+
+		// Changed charts are updated
+		const String firstPath = Path::Normalize(songs + "/first/chart.ksh");
+		WriteChart(firstPath, "Changed");
+		TestEnsure(UpdateUntil(database, [&]()
+		{
+			ChartIndex* chart = database.FindFirstChartByPath(firstPath);
+			return chart && chart->title == "Changed";
+		}));
+
+		// Removed charts and folders are removed
+		Path::DeleteDir(pack);
+		TestEnsure(UpdateUntil(database, [&]() { return database.GetChartMap().size() == 1; }));
+		Path::Delete(firstPath);
+		TestEnsure(UpdateUntil(database, [&]() { return database.GetChartMap().empty() && database.GetFolderMap().empty(); }));
+
+		// None of this needed another scan of the song folders, or showed a search status after the search was done
+		TestEnsure(numScans == 1);
+		{
+			std::lock_guard<std::mutex> lock(statusLock);
+			TestEnsure(lastStatus.empty());
+		}
+		database.StopSearching();
+	}
+	Path::gameDir = gameDir;
+
+	Path::DeleteDir(root);
+}
+
+// Fills a database with charts and scores without any chart files
+static void CreateLargeDatabase(const String& path, int32 numFolders, int32 chartsPerFolder, int32 scoresPerChart)
+{
+	Database database;
+	TestEnsure(database.Open(path));
+	database.Exec("BEGIN");
+	DBStatement addFolder = database.Query("INSERT INTO Folders(path,rowid) VALUES(?,?)");
+	DBStatement addChart = database.Query("INSERT INTO Charts("
+		"folderId,path,title,artist,title_translit,artist_translit,jacket_path,effector,illustrator,"
+		"diff_name,diff_shortname,bpm,diff_index,level,hash,preview_file,preview_offset,preview_length,lwt,custom_offset) "
+		"VALUES(?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,0)");
+	DBStatement addScore = database.Query("INSERT INTO "
+		"Scores(score,crit,near,early,late,combo,miss,gauge,auto_flags,replay,timestamp,chart_hash,user_name,user_id,local_score,window_perfect,window_good,window_hold,window_miss,window_slam,gauge_type,gauge_opt,mirror,random) "
+		"VALUES(?,0,0,0,0,0,0,1.0,0,'',0,?,'','',1,46,150,150,300,84,0,0,0,0)");
+	for(int32 f = 1; f <= numFolders; f++)
+	{
+		const String folderPath = Utility::Sprintf("songs/%d", f);
+		addFolder.BindString(1, folderPath);
+		addFolder.BindInt(2, f);
+		addFolder.Step();
+		addFolder.Rewind();
+		for(int32 c = 0; c < chartsPerFolder; c++)
+		{
+			const String hash = Utility::Sprintf("%08x%032x", f, c);
+			addChart.BindInt(1, f);
+			addChart.BindString(2, folderPath + Utility::Sprintf("/%d.ksh", c));
+			addChart.BindString(3, Utility::Sprintf("Title %d", f));
+			addChart.BindString(4, "Artist");
+			addChart.BindString(5, "");
+			addChart.BindString(6, "");
+			addChart.BindString(7, "jacket.png");
+			addChart.BindString(8, "Effector");
+			addChart.BindString(9, "Illustrator");
+			addChart.BindString(10, "Novice");
+			addChart.BindString(11, "NOV");
+			addChart.BindString(12, "120");
+			addChart.BindInt(13, c % 4);
+			addChart.BindInt(14, c + 1);
+			addChart.BindString(15, hash);
+			addChart.BindString(16, "song.ogg");
+			addChart.BindInt(17, 0);
+			addChart.BindInt(18, 10000);
+			addChart.BindInt64(19, 1);
+			addChart.Step();
+			addChart.Rewind();
+			for(int32 s = 0; s < scoresPerChart; s++)
+			{
+				addScore.BindInt(1, 9000000 + s * 1000);
+				addScore.BindString(2, hash);
+				addScore.Step();
+				addScore.Rewind();
+			}
+		}
+	}
+	database.Exec("END");
+}
+
+static size_t CountScores(MapDatabase& database)
+{
+	size_t numScores = 0;
+	for(auto& chart : database.GetChartMap())
+		numScores += chart.second->scores.size();
+	return numScores;
+}
+
+Test("MapDatabase.LargeDatabaseStartup")
+{
+	const String root = Path::Normalize(Path::GetCurrentPath() + "/map_database_test");
+	if(Path::IsDirectory(root))
+		Path::DeleteDir(root);
+	TestEnsure(Path::CreateDir(root));
+
+	const int32 numFolders = 5000;
+	const int32 chartsPerFolder = 4;
+	const int32 scoresPerChart = 3;
+	const size_t numCharts = numFolders * chartsPerFolder;
+	const size_t numScores = numCharts * scoresPerChart;
+
+	const String gameDir = Path::gameDir;
+	Path::gameDir = root;
+	{
+		// Creates the tables
+		MapDatabase database;
+	}
+	CreateLargeDatabase(Path::Absolute("maps.db"), numFolders, chartsPerFolder, scoresPerChart);
+
+	float chartsTime, streamTime, fullTime;
+	{
+		MapDatabase database;
+		size_t numUpdatedFolders = 0;
+		database.OnFoldersUpdated.AddLambda([&](Vector<FolderIndex*> folders) { numUpdatedFolders += folders.size(); });
+
+		// Charts can be shown right away
+		Timer timer;
+		database.LoadDatabaseWithoutSearching(false);
+		chartsTime = timer.SecondsAsFloat();
+		TestEnsure(database.GetChartMap().size() == numCharts);
+		TestEnsure(database.IsLoadingScores());
+
+		// Scores follow over the next updates, song select updates the database twice a second
+		timer.Restart();
+		size_t numUpdates = 0;
+		while(database.IsLoadingScores() && numUpdates < 10)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(500));
+			database.Update();
+			numUpdates++;
+		}
+		streamTime = timer.SecondsAsFloat();
+		TestEnsure(!database.IsLoadingScores());
+		TestEnsure(CountScores(database) == numScores);
+		TestEnsure(numUpdatedFolders == (size_t)numFolders);
+		for(auto& chart : database.GetChartMap())
+			TestEnsure(chart.second->scores.front()->score >= chart.second->scores.back()->score);
+	}
+	{
+		MapDatabase database;
+		Timer timer;
+		database.LoadDatabaseWithoutSearching();
+		fullTime = timer.SecondsAsFloat();
+		TestEnsure(!database.IsLoadingScores());
+		TestEnsure(CountScores(database) == numScores);
+	}
+	Path::gameDir = gameDir;
+
+	Logf("Loaded %d charts in %.1fms, scores streamed in %.1fms. Loading everything at once took %.1fms", Logger::Severity::Info,
+		(int32)numCharts, chartsTime * 1000.0f, streamTime * 1000.0f, fullTime * 1000.0f);
+
+	Path::DeleteDir(root);
+}
+
+Test("MapDatabase.StreamedScoresAfterHashChange")
+{
+	const String root = Path::Normalize(Path::GetCurrentPath() + "/map_database_test");
+	if(Path::IsDirectory(root))
+		Path::DeleteDir(root);
+	TestEnsure(Path::CreateDir(root));
+	const String songs = Path::Normalize(root + "/songs");
+	TestEnsure(Path::CreateDir(songs));
+	const String folderPath = Path::Normalize(songs + "/first");
+	TestEnsure(Path::CreateDir(folderPath));
+	const String chartPath = Path::Normalize(folderPath + "/chart.ksh");
+	WriteChart(chartPath, "First");
+
+	const String gameDir = Path::gameDir;
+	Path::gameDir = root;
+	{
+		// Creates the tables
+		MapDatabase database;
+	}
+
+	// The stored hash doesn't match the chart file, so the search updates it while the scores are streamed in
+	//	the chart's scores come after many others, so most of them are read after the update
+	const String oldHash = "0000000000000000000000000000000000000000";
+	const int32 numOtherScores = 200000;
+	const int32 numChartScores = 3;
+	{
+		Database db;
+		TestEnsure(db.Open(Path::Absolute("maps.db")));
+		db.Exec("BEGIN");
+		DBStatement addFolder = db.Query("INSERT INTO Folders(path,rowid) VALUES(?,1)");
+		addFolder.BindString(1, folderPath);
+		addFolder.Step();
+		DBStatement addChart = db.Query("INSERT INTO Charts("
+			"folderId,path,title,artist,title_translit,artist_translit,jacket_path,effector,illustrator,"
+			"diff_name,diff_shortname,bpm,diff_index,level,hash,preview_file,preview_offset,preview_length,lwt,custom_offset) "
+			"VALUES(1,?,'First','Test','','','','Test','','Exhaust','EXH','120',2,10,?,'song.ogg',0,0,1,0)");
+		addChart.BindString(1, chartPath);
+		addChart.BindString(2, oldHash);
+		addChart.Step();
+		DBStatement addScore = db.Query("INSERT INTO "
+			"Scores(score,crit,near,early,late,combo,miss,gauge,auto_flags,replay,timestamp,chart_hash,user_name,user_id,local_score,window_perfect,window_good,window_hold,window_miss,window_slam,gauge_type,gauge_opt,mirror,random) "
+			"VALUES(?,0,0,0,0,0,0,1.0,0,'',0,?,'','',1,46,150,150,300,84,0,0,0,0)");
+		for(int32 i = 0; i < numOtherScores + numChartScores; i++)
+		{
+			addScore.BindInt(1, 9000000 + i);
+			addScore.BindString(2, i < numOtherScores ? String("removed chart") : oldHash);
+			addScore.Step();
+			addScore.Rewind();
+		}
+		db.Exec("END");
+	}
+	{
+		MapDatabase database;
+		// Scores that aren't moved to the new hash are still read under the old one
+		database.SetChartUpdateBehavior(false);
+		database.AddSearchPath(songs);
+		database.StartSearching();
+		TestEnsure(database.IsLoadingScores());
+		TestEnsure(UpdateUntil(database, [&]()
+		{
+			ChartIndex* chart = database.FindFirstChartByPath(chartPath);
+			return chart && chart->hash != oldHash;
+		}));
+		TestEnsure(UpdateUntil(database, [&]() { return !database.IsLoadingScores(); }));
+
+		// Scores stay with their chart, like they would if they were all loaded before the update
+		ChartIndex* chart = database.FindFirstChartByPath(chartPath);
+		TestEnsure(chart && chart->scores.size() == numChartScores);
+		database.StopSearching();
+	}
+	Path::gameDir = gameDir;
+
+	Path::DeleteDir(root);
+}
+
+Test("MapDatabase.CollectionChanges")
+{
+	const String root = Path::Normalize(Path::GetCurrentPath() + "/map_database_test");
+	if(Path::IsDirectory(root))
+		Path::DeleteDir(root);
+	TestEnsure(Path::CreateDir(root));
+
+	const String gameDir = Path::gameDir;
+	Path::gameDir = root;
+	{
+		// Creates the tables
+		MapDatabase database;
+	}
+	CreateLargeDatabase(Path::Absolute("maps.db"), 3, 1, 0);
+	{
+		MapDatabase database;
+		database.LoadDatabaseWithoutSearching();
+		TestEnsure(database.GetFolderMap().size() == 3);
+
+		// The song wheel keeps the folders of an active collection filter until this version changes,
+		//	adding or removing a song shows in the wheel without any folder changing
+		uint32 version = database.GetCollectionsVersion();
+		TestEnsure(database.FindFoldersByCollection("Favourites").empty());
+		database.AddOrRemoveToCollection("Favourites", 1);
+		TestEnsure(database.GetCollectionsVersion() != version);
+		version = database.GetCollectionsVersion();
+		database.AddOrRemoveToCollection("Favourites", 2);
+		TestEnsure(database.GetCollectionsVersion() != version);
+		Map<int32, FolderIndex*> folders = database.FindFoldersByCollection("Favourites");
+		TestEnsure(folders.size() == 2 && folders.Contains(1) && folders.Contains(2));
+
+		// Adding a song again removes it
+		version = database.GetCollectionsVersion();
+		database.AddOrRemoveToCollection("Favourites", 1);
+		TestEnsure(database.GetCollectionsVersion() != version);
+		folders = database.FindFoldersByCollection("Favourites");
+		TestEnsure(folders.size() == 1 && folders.Contains(2));
+	}
+	Path::gameDir = gameDir;
+
+	Path::DeleteDir(root);
+}
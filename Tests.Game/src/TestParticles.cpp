@@ -0,0 +1,249 @@
+#include "stdafx.h"
+#include <Graphics/ResourceManagers.hpp>
+using namespace Graphics;
+
+/*
+	Particle emitter that stores every particle as a struct and simulates it while building vertices
+	This is how emitters used to work, it's kept here to compare against the current emitter
+*/
+class ReferenceEmitter
+{
+public:
+	struct Particle
+	{
+		float life = 0.0f;
+		float maxLife = 0.0f;
+		float rotation = 0.0f;
+		float startSize = 0.0f;
+		Color startColor;
+		Vector3 pos;
+		Vector3 velocity;
+		float scale;
+		float fade;
+		float drag;
+	};
+
+	std::unique_ptr<IParticleParameter<float>> lifetime;
+	std::unique_ptr<IParticleParameter<float>> fadeOverTime;
+	std::unique_ptr<IParticleParameter<float>> scaleOverTime;
+	std::unique_ptr<IParticleParameter<Color>> startColor;
+	std::unique_ptr<IParticleParameter<Vector3>> startVelocity;
+	std::unique_ptr<IParticleParameter<float>> startSize;
+	std::unique_ptr<IParticleParameter<float>> startRotation;
+	std::unique_ptr<IParticleParameter<Vector3>> startPosition;
+	std::unique_ptr<IParticleParameter<float>> startDrag;
+	std::unique_ptr<IParticleParameter<Vector3>> gravity;
+	std::unique_ptr<IParticleParameter<float>> spawnVelocityScale;
+	std::unique_ptr<IParticleParameter<float>> spawnRate;
+	Vector3 position;
+	float duration = 5.0f;
+	float scale = 1.0f;
+
+	void Render(float deltaTime, Vector<ParticleVertex>& verts)
+	{
+		uint32 maxParticles = (uint32)ceilf(spawnRate->GetMax()) * (uint32)ceilf(lifetime->GetMax());
+		maxParticles = (uint32)ceil((float)maxParticles / 64.0f) * 64;
+		if(maxParticles > m_particles.size())
+			m_particles.resize(maxParticles);
+
+		m_emitterTime += deltaTime;
+		while(m_emitterTime > duration)
+			m_emitterTime -= duration;
+		m_emitterRate = m_emitterTime / duration;
+		m_spawnCounter += deltaTime * spawnRate->Sample(m_emitterRate);
+
+		float spawnsf;
+		m_spawnCounter = modff(m_spawnCounter, &spawnsf);
+		uint32 numSpawns = (uint32)spawnsf;
+		float spawnTimeOffset = 0.0f;
+		float spawnTimeOffsetStep = deltaTime / spawnsf;
+
+		for(Particle& p : m_particles)
+		{
+			bool render = false;
+			if(p.life <= 0.0f)
+			{
+				if(numSpawns > 0)
+				{
+					m_Init(p);
+					m_Simulate(p, spawnTimeOffset);
+					spawnTimeOffset += spawnTimeOffsetStep;
+					numSpawns--;
+					render = true;
+				}
+			}
+			else
+			{
+				m_Simulate(p, deltaTime);
+				render = true;
+			}
+
+			if(render)
+				verts.Add({ p.pos, p.startColor.WithAlpha(p.fade), Vector4(p.startSize * p.scale, p.rotation, 0, 0) });
+		}
+	}
+
+private:
+	void m_Init(Particle& p)
+	{
+		const float& et = m_emitterRate;
+		p.life = p.maxLife = lifetime->Init(et);
+		p.pos = startPosition->Init(et) * scale;
+		p.velocity = startVelocity->Init(et) * scale;
+		float spawnVelScale = spawnVelocityScale->Init(et);
+		if(spawnVelScale > 0)
+			p.velocity += p.pos.Normalized() * spawnVelScale * scale;
+		p.pos += position;
+		p.startColor = startColor->Init(et);
+		p.rotation = startRotation->Init(et);
+		p.startSize = startSize->Init(et) * scale;
+		p.drag = startDrag->Init(et);
+	}
+	void m_Simulate(Particle& p, float deltaTime)
+	{
+		float c = 1 - p.life / p.maxLife;
+		p.velocity += gravity->Sample(m_emitterTime) * deltaTime * scale;
+		p.pos += p.velocity * deltaTime;
+		p.velocity += -p.velocity * deltaTime * p.drag;
+		p.fade = fadeOverTime->Sample(c);
+		p.scale = scaleOverTime->Sample(c);
+		p.life -= deltaTime;
+	}
+
+	Vector<Particle> m_particles;
+	float m_emitterTime = 0.0f;
+	float m_emitterRate = 0.0f;
+	float m_spawnCounter = 0.0f;
+};
+
+// Sets up both emitters with the same parameters, similar to the hit effects in game
+#define SETUP_PARTICLE_PARAMETER(__name, __member, __value)\
+	emitter->Set##__name(__value);\
+	reference.__member.reset(__value.Duplicate());
+static void SetupEmitters(Ref<ParticleEmitter> emitter, ReferenceEmitter& reference, float spawnRate)
+{
+	emitter->position = reference.position = Vector3(0.5f, 1.0f, 0.0f);
+	emitter->scale = reference.scale = 0.3f;
+	SETUP_PARTICLE_PARAMETER(Lifetime, lifetime, PPRandomRange<float>(0.5f, 1.0f));
+	SETUP_PARTICLE_PARAMETER(FadeOverTime, fadeOverTime, PPRangeFadeIn<float>(1.0f, 0.0f, 0.4f));
+	SETUP_PARTICLE_PARAMETER(ScaleOverTime, scaleOverTime, PPRange<float>(2.0f, 1.0f));
+	SETUP_PARTICLE_PARAMETER(StartColor, startColor, PPConstant<Color>(Color(0.5f, 0.7f, 1.0f)));
+	SETUP_PARTICLE_PARAMETER(StartVelocity, startVelocity, PPCone(Vector3(0, 0, -1), 60.0f, 1.0f, 4.0f));
+	SETUP_PARTICLE_PARAMETER(StartSize, startSize, PPRandomRange<float>(0.25f, 0.4f));
+	SETUP_PARTICLE_PARAMETER(StartRotation, startRotation, PPRandomRange<float>(0.0f, Math::pi * 2));
+	SETUP_PARTICLE_PARAMETER(StartPosition, startPosition, PPSphere(0.1f));
+	SETUP_PARTICLE_PARAMETER(StartDrag, startDrag, PPConstant<float>(0.5f));
+	SETUP_PARTICLE_PARAMETER(Gravity, gravity, PPConstant<Vector3>(Vector3(0.0f, 0.0f, -9.81f)));
+	SETUP_PARTICLE_PARAMETER(SpawnVelocityScale, spawnVelocityScale, PPRandomRange<float>(0.8f, 1.0f));
+	SETUP_PARTICLE_PARAMETER(SpawnRate, spawnRate, PPConstant<float>(spawnRate));
+}
+#undef SETUP_PARTICLE_PARAMETER
+
+static bool VerticesEqual(const Vector<ParticleVertex>& a, const Vector<ParticleVertex>& b)
+{
+	if(a.size() != b.size())
+		return false;
+	for(size_t i = 0; i < a.size(); i++)
+	{
+		for(size_t c = 0; c < 3; c++)
+		{
+			if(a[i].pos[c] != b[i].pos[c])
+				return false;
+		}
+		for(size_t c = 0; c < 4; c++)
+		{
+			if(a[i].color[c] != b[i].color[c] || a[i].params[c] != b[i].params[c])
+				return false;
+		}
+	}
+	return true;
+}
+
+// Simulating particles doesn't need a graphics context, only the resource manager
+class ParticleTestScope
+{
+public:
+	ParticleTestScope()
+	{
+		ResourceManagers::CreateResourceManager<ResourceType::ParticleSystem>();
+		system = ParticleSystemRes::Create(nullptr);
+	}
+	~ParticleTestScope()
+	{
+		system.reset();
+		ResourceManagers::DestroyResourceManager<ResourceType::ParticleSystem>();
+	}
+	ParticleSystem system;
+};
+
+Test("Graphics.Particles.Deterministic")
+{
+	ParticleTestScope scope;
+	Ref<ParticleEmitter> emitter = scope.system->AddEmitter();
+	ReferenceEmitter reference;
+	SetupEmitters(emitter, reference, 500.0f);
+
+	// Uneven frame times
+	const float frameTimes[] = { 1.0f / 60.0f, 1.0f / 144.0f, 1.0f / 30.0f, 0.1f };
+
+	Vector<ParticleVertex> verts;
+	Vector<ParticleVertex> referenceVerts;
+	size_t numCompared = 0;
+	for(uint32 frame = 0; frame < 240; frame++)
+	{
+		const float dt = frameTimes[frame % 4];
+
+		// Both emitters use the same random numbers
+		Random::Seed(frame);
+		emitter->Simulate(dt);
+		verts.clear();
+		emitter->GetVertices(verts);
+
+		Random::Seed(frame);
+		referenceVerts.clear();
+		reference.Render(dt, referenceVerts);
+
+		TestEnsure(VerticesEqual(verts, referenceVerts));
+		numCompared += verts.size();
+	}
+	TestEnsure(numCompared > 0);
+}
+
+Test("Graphics.Particles.Benchmark")
+{
+	ParticleTestScope scope;
+	Ref<ParticleEmitter> emitter = scope.system->AddEmitter();
+	ReferenceEmitter reference;
+	// Lifetime is at most one second, so this keeps up to 100k particles alive
+	SetupEmitters(emitter, reference, 100000.0f);
+
+	const uint32 numFrames = 120;
+	const float dt = 1.0f / 120.0f;
+	Vector<ParticleVertex> verts;
+
+	Random::Seed(1234);
+	Timer timer;
+	for(uint32 i = 0; i < numFrames; i++)
+	{
+		verts.clear();
+		reference.Render(dt, verts);
+	}
+	const float referenceTime = timer.SecondsAsFloat();
+
+	Random::Seed(1234);
+	timer.Restart();
+	float simulateTime = 0.0f;
+	for(uint32 i = 0; i < numFrames; i++)
+	{
+		Timer simulateTimer;
+		emitter->Simulate(dt);
+		simulateTime += simulateTimer.SecondsAsFloat();
+		verts.clear();
+		emitter->GetVertices(verts);
+	}
+	const float time = timer.SecondsAsFloat();
+
+	Logf("%d particles for %d frames: %.2fms per frame as structs, %.2fms per frame as arrays (%.2fms simulating)", Logger::Severity::Info,
+		(int32)verts.size(), numFrames, referenceTime * 1000.0f / numFrames, time * 1000.0f / numFrames, simulateTime * 1000.0f / numFrames);
+	TestEnsure(verts.size() > 50000);
+}
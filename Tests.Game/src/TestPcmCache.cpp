@@ -0,0 +1,164 @@
+#include "stdafx.h"
+#include <Audio/PcmCache.hpp>
+
+// Some stereo pcm that is different for every seed
+static Vector<float> MakePcm(uint64 numFrames, uint32 seed)
+{
+	Vector<float> pcm(numFrames * 2);
+	for (uint64 i = 0; i < numFrames; i++)
+	{
+		pcm[i * 2] = sinf((float)i * 0.01f * (float)(seed + 1)) * 0.5f;
+		pcm[i * 2 + 1] = cosf((float)i * 0.013f * (float)(seed + 1)) * 0.5f;
+	}
+	return pcm;
+}
+
+static String GetTestDirectory()
+{
+	const String directory = Path::GetCurrentPath() + Path::sep + "pcm_cache_test";
+	if (Path::IsDirectory(directory))
+	{
+		Path::ClearDir(directory);
+		Path::DeleteDir(directory);
+	}
+	return directory;
+}
+
+Test("Audio.PcmCache.Eviction")
+{
+	const String directory = GetTestDirectory();
+	const uint64 numFrames = 48000;
+	const uint64 entrySize = 32 + numFrames * 2 * sizeof(float);
+	const Vector<float> a = MakePcm(numFrames, 0), b = MakePcm(numFrames, 1), c = MakePcm(numFrames, 2), d = MakePcm(numFrames, 3);
+	const String keyA = PcmCache::MakeKey("a", 1, "test"), keyB = PcmCache::MakeKey("b", 1, "test");
+	const String keyC = PcmCache::MakeKey("c", 1, "test"), keyD = PcmCache::MakeKey("d", 1, "test");
+	TestEnsure(keyA != keyB && keyA != PcmCache::MakeKey("a", 1, "other"));
+
+	{
+		// Room for two entries
+		PcmCache cache;
+		cache.Open(directory, entrySize * 2 + entrySize / 2);
+		TestEnsure(cache.IsEnabled());
+		TestEnsure(!cache.Load(keyA));
+		TestEnsure(cache.Store(keyA, a.data(), numFrames, 48000));
+		TestEnsure(cache.Store(keyB, b.data(), numFrames, 44100));
+		TestEnsure(cache.GetNumEntries() == 2 && cache.GetSize() == entrySize * 2);
+
+		Ref<CachedPcm> loaded = cache.Load(keyA);
+		TestEnsure(loaded);
+		TestEnsure(loaded->GetNumFrames() == numFrames && loaded->GetSampleRate() == 48000);
+		TestEnsure(memcmp(loaded->GetData(), a.data(), a.size() * sizeof(float)) == 0);
+
+		// Changing the loaded pcm doesn't change the cached pcm
+		loaded->GetData()[0] = 2.0f;
+		TestEnsure(cache.Load(keyA)->GetData()[0] == a[0]);
+
+		// B was used least recently
+		TestEnsure(cache.Store(keyC, c.data(), numFrames, 48000));
+		TestEnsure(cache.GetNumEntries() == 2);
+		TestEnsure(!cache.Load(keyB));
+		TestEnsure(cache.Load(keyC));
+		TestEnsure(cache.GetNumHits() == 3 && cache.GetNumMisses() == 2 && cache.GetNumEvictions() == 1);
+
+		// Entries can't be larger than the whole cache
+		const Vector<float> large = MakePcm(numFrames * 3, 4);
+		TestEnsure(!cache.Store(PcmCache::MakeKey("large", 5, "test"), large.data(), numFrames * 3, 48000));
+	}
+
+	{
+		// The order is kept when the cache is opened again, A was used before C
+		PcmCache cache;
+		cache.Open(directory, entrySize * 2 + entrySize / 2);
+		TestEnsure(cache.GetNumEntries() == 2);
+		TestEnsure(cache.Store(keyD, d.data(), numFrames, 48000));
+		TestEnsure(!cache.Load(keyA));
+		TestEnsure(cache.Load(keyC) && cache.Load(keyD));
+		TestEnsure(cache.GetNumEvictions() == 1);
+
+		// Opening with a smaller size removes entries, a size of 0 disables the cache
+		cache.Open(directory, entrySize);
+		TestEnsure(cache.GetNumEntries() == 1 && cache.Load(keyD));
+		cache.Open(directory, 0);
+		TestEnsure(!cache.IsEnabled());
+		TestEnsure(!cache.Load(keyD));
+		TestEnsure(!cache.Store(keyA, a.data(), numFrames, 48000));
+	}
+
+	{
+		// Broken files are removed instead of loaded
+		PcmCache cache;
+		cache.Open(directory, entrySize * 2);
+		TestEnsure(cache.Load(keyD));
+		File file;
+		TestEnsure(file.OpenWrite(directory + Path::sep + keyD + ".pcm", true));
+		file.Write(a.data(), 16);
+		file.Close();
+		TestEnsure(!cache.Load(keyD));
+		TestEnsure(cache.GetNumEntries() == 0 && cache.GetSize() == 0);
+	}
+
+	Path::ClearDir(directory);
+	Path::DeleteDir(directory);
+}
+
+Test("Audio.PcmCache.Int16")
+{
+	const String directory = GetTestDirectory();
+	const uint64 numFrames = 10000;
+	const Vector<float> pcm = MakePcm(numFrames, 0);
+	const String key = PcmCache::MakeKey("a", 1, "test");
+
+	PcmCache cache;
+	cache.Open(directory, 1 << 20);
+	cache.SetFormat(PcmCacheFormat::Int16);
+	TestEnsure(cache.Store(key, pcm.data(), numFrames, 48000));
+	TestEnsure(cache.GetSize() == 32 + numFrames * 2 * sizeof(int16));
+
+	Ref<CachedPcm> loaded = cache.Load(key);
+	TestEnsure(loaded && loaded->GetNumFrames() == numFrames);
+	float maxError = 0.0f;
+	for (size_t i = 0; i < pcm.size(); i++)
+		maxError = Math::Max(maxError, fabsf(loaded->GetData()[i] - pcm[i]));
+	TestEnsure(maxError <= 1.0f / 32767.0f);
+
+	loaded.reset();
+	Path::ClearDir(directory);
+	Path::DeleteDir(directory);
+}
+
+Test("Audio.PcmCache.LoadTime")
+{
+	const String directory = GetTestDirectory();
+	const uint64 numFrames = 48000 * 180;
+	const Vector<float> pcm = MakePcm(numFrames, 0);
+
+	PcmCache cache;
+	cache.Open(directory, 1ull << 30);
+	for (uint32 f = 0; f < (uint32)PcmCacheFormat::_Length; f++)
+	{
+		const PcmCacheFormat format = (PcmCacheFormat)f;
+		const String key = PcmCache::MakeKey(&f, sizeof(f), "test");
+		cache.SetFormat(format);
+		Timer timer;
+		TestEnsure(cache.Store(key, pcm.data(), numFrames, 48000));
+		const float storeTime = timer.SecondsAsFloat();
+
+		// Reads every sample, so all of the mapped file is loaded
+		timer.Restart();
+		Ref<CachedPcm> loaded = cache.Load(key);
+		TestEnsure(loaded);
+		const float mapTime = timer.SecondsAsFloat();
+		double sum = 0.0;
+		const float* data = loaded->GetData();
+		for (uint64 i = 0; i < numFrames * 2; i++)
+			sum += data[i];
+		const float loadTime = timer.SecondsAsFloat();
+		TestEnsure(sum != 0.0);
+
+		Logf("%s cache entry of 180 seconds: stored in %.1fms, loaded in %.1fms, read in %.1fms", Logger::Severity::Info,
+			Enum_PcmCacheFormat::ToString(format), storeTime * 1000.0f, mapTime * 1000.0f, loadTime * 1000.0f);
+	}
+
+	Path::ClearDir(directory);
+	Path::DeleteDir(directory);
+}
@@ -0,0 +1,188 @@
+#include "stdafx.h"
+#include <Audio/PreRenderer.hpp>
+#include <Audio/DSP.hpp>
+#include <Shared/WorkerPool.hpp>
+
+// Pcm of a whole song, like a preloaded stream
+class TestPcmSource : public AudioBase
+{
+public:
+	TestPcmSource(Vector<float>& pcm, uint32 sampleRate) : pcm(pcm), sampleRate(sampleRate)
+	{
+	}
+
+	void Process(float* out, uint32 numSamples) override
+	{
+	}
+	int32 GetPosition() const override
+	{
+		return (int32)(samplePos * 1000 / sampleRate);
+	}
+	uint32 GetSampleRate() const override
+	{
+		return sampleRate;
+	}
+	uint64 GetSamplePos() const override
+	{
+		return samplePos;
+	}
+	float* GetPCM() override
+	{
+		return pcm.data();
+	}
+	uint64 GetPCMCount() const override
+	{
+		return pcm.size() / 2;
+	}
+	void PreRenderDSPs(Vector<DSP*>& DSPs) override
+	{
+	}
+
+	Vector<float>& pcm;
+	uint32 sampleRate;
+	uint64 samplePos = 0;
+};
+
+// Applies every effect one after another, the way streams pre-rendered effects before they were split into groups
+static void RenderSerial(TestPcmSource& source, const Vector<DSP*>& DSPs)
+{
+	const uint64 numFrames = source.GetPCMCount();
+	for (DSP* dsp : DSPs)
+	{
+		const uint64 start = ((uint64)dsp->startTime * (uint64)source.sampleRate) / 1000;
+		const uint64 end = Math::Min(((uint64)dsp->endTime * (uint64)source.sampleRate) / 1000, numFrames);
+		if (start >= end)
+			continue;
+		source.samplePos = start;
+		const uint32 numSamples = (uint32)(end - start);
+		Vector<float> buffer(source.pcm.begin() + start * 2, source.pcm.begin() + end * 2);
+		dsp->Process(buffer.data(), numSamples);
+		memcpy(source.pcm.data() + start * 2, buffer.data(), numSamples * 2 * sizeof(float));
+	}
+}
+
+// Effects spread over a song, some of them overlapping
+static Vector<DSP*> MakeEffects(uint32 sampleRate, AudioBase* source)
+{
+	Vector<DSP*> DSPs;
+	auto add = [&](DSP* dsp, uint32 start, uint32 duration, uint32 priority)
+	{
+		dsp->startTime = start;
+		dsp->endTime = start + duration;
+		dsp->priority = priority;
+		dsp->SetAudioBase(source);
+		DSPs.Add(dsp);
+	};
+
+	for (uint32 i = 0; i < 4; i++)
+	{
+		const uint32 offset = i * 15000;
+		BQFDSP* bqf = new BQFDSP(sampleRate);
+		bqf->SetLowPass(1.0f, 800.0f);
+		add(bqf, offset + 1000, 3000, 1);
+
+		WobbleDSP* wobble = new WobbleDSP(sampleRate);
+		wobble->SetLength(250.0);
+		add(wobble, offset + 2500, 2000, 2);
+
+		RetriggerDSP* retrigger = new RetriggerDSP(sampleRate);
+		retrigger->SetLength(125.0);
+		retrigger->SetResetDuration(sampleRate / 2);
+		retrigger->SetGating(0.6f);
+		retrigger->lastTimingPoint = offset + 4000;
+		add(retrigger, offset + 6000, 1500, 0);
+
+		GateDSP* gate = new GateDSP(sampleRate);
+		gate->SetLength(100.0);
+		gate->SetGating(0.5f);
+		add(gate, offset + 7000, 1000, 1);
+
+		PhaserDSP* phaser = new PhaserDSP(sampleRate);
+		phaser->SetLength(500.0);
+		add(phaser, offset + 9000, 2000, 1);
+
+		FlangerDSP* flanger = new FlangerDSP(sampleRate);
+		flanger->SetLength(500.0);
+		add(flanger, offset + 10500, 1500, 2);
+
+		EchoDSP* echo = new EchoDSP(sampleRate);
+		echo->SetLength(200.0);
+		add(echo, offset + 12000, 1000, 1);
+
+		SidechainDSP* sidechain = new SidechainDSP(sampleRate);
+		sidechain->SetLength(300.0);
+		add(sidechain, offset + 12500, 1000, 0);
+
+		TapeStopDSP* tapeStop = new TapeStopDSP(sampleRate);
+		tapeStop->SetLength(1000.0);
+		add(tapeStop, offset + 13500, 1000, 3);
+
+		BitCrusherDSP* bitCrusher = new BitCrusherDSP(sampleRate);
+		bitCrusher->SetPeriod(4.0f);
+		add(bitCrusher, offset + 14000, 800, 1);
+	}
+
+	// Starts after the end of the song
+	BQFDSP* late = new BQFDSP(sampleRate);
+	late->SetHighPass(1.0f, 2000.0f);
+	add(late, 120000, 1000, 1);
+
+	DSPs.Sort(DSP::Sorter);
+	return DSPs;
+}
+
+static void DeleteEffects(Vector<DSP*>& DSPs)
+{
+	for (DSP* dsp : DSPs)
+	{
+		dsp->RemoveAudioBase();
+		delete dsp;
+	}
+	DSPs.clear();
+}
+
+Test("Audio.PreRender.MatchesSerial")
+{
+	const uint32 sampleRate = 44100;
+	const uint64 numFrames = sampleRate * 62;
+	Vector<float> pcm(numFrames * 2);
+	for (uint64 i = 0; i < numFrames; i++)
+	{
+		pcm[i * 2] = sinf((float)i * 0.031f) * 0.5f + sinf((float)i * 0.0007f) * 0.25f;
+		pcm[i * 2 + 1] = cosf((float)i * 0.027f) * 0.5f;
+	}
+
+	Vector<float> serial = pcm;
+	TestPcmSource serialSource(serial, sampleRate);
+	Vector<DSP*> serialDSPs = MakeEffects(sampleRate, &serialSource);
+	Timer timer;
+	RenderSerial(serialSource, serialDSPs);
+	const float serialTime = timer.SecondsAsFloat();
+
+	Vector<float> rendered = pcm;
+	TestPcmSource renderedSource(rendered, sampleRate);
+	Vector<DSP*> renderedDSPs = MakeEffects(sampleRate, &renderedSource);
+	WorkerPool pool(4);
+	timer.Restart();
+	PreRenderer::Render(rendered.data(), numFrames, sampleRate, renderedDSPs, &pool);
+	const float renderTime = timer.SecondsAsFloat();
+	Logf("Pre-rendered %d effects: %.1fms one after another, %.1fms in groups", Logger::Severity::Info,
+		serialDSPs.size(), serialTime * 1000.0f, renderTime * 1000.0f);
+
+	TestEnsure(serial != pcm);
+	TestEnsure(memcmp(serial.data(), rendered.data(), serial.size() * sizeof(float)) == 0);
+	// Effects are given back their stream
+	for (DSP* dsp : renderedDSPs)
+		TestEnsure(dsp->GetAudioBase() == &renderedSource);
+
+	// Rendering without a pool gives the same result
+	Vector<float> single = pcm;
+	TestPcmSource singleSource(single, sampleRate);
+	Vector<DSP*> singleDSPs = MakeEffects(sampleRate, &singleSource);
+	PreRenderer::Render(single.data(), numFrames, sampleRate, singleDSPs, nullptr);
+	TestEnsure(memcmp(serial.data(), single.data(), serial.size() * sizeof(float)) == 0);
+
+	DeleteEffects(serialDSPs);
+	DeleteEffects(renderedDSPs);
+	DeleteEffects(singleDSPs);
+}
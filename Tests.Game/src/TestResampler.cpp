@@ -0,0 +1,150 @@
+#include "stdafx.h"
+#include <Audio/Resampler.hpp>
+#include <Shared/WorkerPool.hpp>
+
+// Resamples all of the interleaved stereo input, pushing it in blocks like a decoder would
+static Vector<float> Resample(Resampler& resampler, const Vector<float>& in, double ratio)
+{
+	const uint32 numIn = (uint32)in.size() / 2;
+	const uint32 blockSize = 4096;
+	Vector<float> out((size_t)(numIn / ratio) * 2 + blockSize * 2);
+	uint32 numOut = 0;
+	for (uint32 i = 0; i < numIn; i += blockSize)
+	{
+		resampler.Push(in.data() + i * 2, Math::Min(blockSize, numIn - i));
+		uint32 written;
+		while ((written = resampler.Process(out.data() + numOut * 2, blockSize, ratio)) > 0)
+			numOut += written;
+	}
+	out.resize(numOut * 2);
+	return out;
+}
+
+// Linear sweep over the whole input frequency range
+static Vector<float> SweptSine(uint32 sampleRate, double startFrequency, double endFrequency, double duration)
+{
+	const uint32 numFrames = (uint32)(duration * sampleRate);
+	const double rate = (endFrequency - startFrequency) / duration;
+	Vector<float> sine(numFrames * 2);
+	for (uint32 i = 0; i < numFrames; i++)
+	{
+		const double t = (double)i / sampleRate;
+		const double phase = 2.0 * Math::pi * (startFrequency * t + 0.5 * rate * t * t);
+		sine[i * 2] = sine[i * 2 + 1] = (float)sin(phase);
+	}
+	return sine;
+}
+
+Test("Audio.Resampler.Aliasing")
+{
+	const uint32 inRate = 48000;
+	const uint32 outRate = 44100;
+	const double duration = 2.0;
+	const double endFrequency = inRate * 0.5;
+	const Vector<float> sweep = SweptSine(inRate, 0.0, endFrequency, duration);
+	const double ratio = (double)inRate / outRate;
+
+	float aliasing[(size_t)ResampleQuality::_Length];
+	for (uint32 q = 0; q < (uint32)ResampleQuality::_Length; q++)
+	{
+		Resampler resampler((ResampleQuality)q);
+		const Vector<float> out = Resample(resampler, sweep, ratio);
+
+		// Everything in the output while the sweep is above the output's nyquist frequency is aliasing
+		//	the passband should keep the sweep at full level
+		double aliasEnergy = 0.0, passEnergy = 0.0;
+		uint32 numAlias = 0, numPass = 0;
+		for (size_t i = 0; i < out.size() / 2; i++)
+		{
+			const double frequency = endFrequency * ((double)i / outRate) / duration;
+			const double energy = (double)out[i * 2] * out[i * 2] + (double)out[i * 2 + 1] * out[i * 2 + 1];
+			if (frequency > outRate * 0.5 + 500.0)
+			{
+				aliasEnergy += energy;
+				numAlias++;
+			}
+			else if (frequency > 1000.0 && frequency < 15000.0)
+			{
+				passEnergy += energy;
+				numPass++;
+			}
+		}
+		// Relative to a full scale sine in both channels
+		aliasing[q] = (float)(10.0 * log10(aliasEnergy / numAlias));
+		const float passband = (float)(10.0 * log10(passEnergy / numPass));
+		Logf("%s resampling: aliasing %.1fdB, passband %.2fdB", Logger::Severity::Info,
+			Enum_ResampleQuality::ToString((ResampleQuality)q), aliasing[q], passband);
+		// Linear interpolation already dulls high frequencies
+		if ((ResampleQuality)q != ResampleQuality::Linear)
+			TestEnsure(fabs(passband) < 0.1f);
+	}
+
+	TestEnsure(aliasing[(size_t)ResampleQuality::Medium] < -60.0f);
+	TestEnsure(aliasing[(size_t)ResampleQuality::High] < aliasing[(size_t)ResampleQuality::Medium]);
+	TestEnsure(aliasing[(size_t)ResampleQuality::Linear] > aliasing[(size_t)ResampleQuality::Medium]);
+}
+
+Test("Audio.Resampler.Throughput")
+{
+	// 44.1kHz songs on a 48kHz device is the most common case
+	const uint32 inRate = 44100;
+	const uint32 outRate = 48000;
+	const double duration = 10.0;
+	const Vector<float> sweep = SweptSine(inRate, 20.0, 20000.0, duration);
+
+	for (uint32 q = 0; q < (uint32)ResampleQuality::_Length; q++)
+	{
+		Resampler resampler((ResampleQuality)q);
+		Timer timer;
+		const Vector<float> out = Resample(resampler, sweep, (double)inRate / outRate);
+		const float seconds = timer.SecondsAsFloat();
+		TestEnsure(out.size() / 2 >= (size_t)(duration * outRate) - resampler.GetNumTaps());
+
+		Logf("%s resampling: %.1fms for %.0f seconds of audio (%.0fx realtime)", Logger::Severity::Info,
+			Enum_ResampleQuality::ToString((ResampleQuality)q), seconds * 1000.0f, duration, duration / seconds);
+		TestEnsure(seconds < duration);
+	}
+}
+
+Test("Audio.Resampler.Preconverted")
+{
+	const uint32 inRate = 44100;
+	const uint32 outRate = 48000;
+	const double ratio = (double)inRate / outRate;
+	const Vector<float> sweep = SweptSine(inRate, 20.0, 20000.0, 3.0);
+	const uint64 numFrames = sweep.size() / 2;
+
+	for (uint32 q = 0; q < (uint32)ResampleQuality::_Length; q++)
+	{
+		// Streams resample while playing
+		Resampler streaming((ResampleQuality)q);
+		const Vector<float> played = Resample(streaming, sweep, ratio);
+
+		// Preloaded streams are converted in parts on worker threads
+		Resampler resampler((ResampleQuality)q);
+		resampler.SetRatio(ratio);
+		const uint64 numOutput = Resampler::GetNumOutputFrames(numFrames, ratio);
+		TestEnsure(fabs((double)numOutput - numFrames / ratio) <= 1.0);
+		Vector<float> converted(numOutput * 2);
+		{
+			WorkerPool pool(3);
+			const uint64 partSize = 12345;
+			for (uint64 first = 0; first < numOutput; first += partSize)
+			{
+				pool.Queue([&, first]()
+				{
+					resampler.ProcessBuffer(sweep.data(), numFrames, converted.data() + first * 2, first, (uint32)Math::Min(partSize, numOutput - first), ratio);
+				});
+			}
+			pool.Wait();
+		}
+		TestEnsure(played.size() <= converted.size());
+		TestEnsure(memcmp(played.data(), converted.data(), played.size() * sizeof(float)) == 0);
+
+		// Playing the converted pcm at the output rate copies it
+		Resampler copy((ResampleQuality)q);
+		const Vector<float> copied = Resample(copy, converted, 1.0);
+		TestEnsure(copied.size() + copy.GetNumTaps() >= converted.size());
+		TestEnsure(memcmp(copied.data(), converted.data(), copied.size() * sizeof(float)) == 0);
+	}
+}
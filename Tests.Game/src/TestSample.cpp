@@ -0,0 +1,117 @@
+#include "stdafx.h"
+#include <Audio/Audio.hpp>
+#include <Audio/Sample.hpp>
+#include <atomic>
+#include <thread>
+
+// Every frame of the test sample has this value, so mixed output counts the plays that were heard
+static const float unit = 1.0f / 1024.0f;
+
+static Vector<float> MakeSamplePcm(uint64 numFrames)
+{
+	return Vector<float>(numFrames * 2, unit);
+}
+
+Test("Audio.Sample.Overlap")
+{
+	Audio* audio = new Audio();
+	const Vector<float> pcm = MakeSamplePcm(100);
+	Sample sample = SampleRes::Create(audio, pcm.data(), 100);
+	TestEnsure(sample && !sample->IsPlaying());
+
+	// Played twice before the mixer gets to it, both are heard
+	sample->Play();
+	sample->Play();
+	TestEnsure(sample->IsPlaying());
+	Vector<float> block(384 * 2, 0.0f);
+	sample->Process(block.data(), 384);
+	TestEnsure(block[0] == unit * 2 && block[99 * 2 + 1] == unit * 2 && block[100 * 2] == 0.0f);
+	TestEnsure(!sample->IsPlaying());
+
+	// Looping plays restart instead of stacking, until they are stopped
+	sample->Play(true);
+	sample->Play(true);
+	std::fill(block.begin(), block.end(), 0.0f);
+	sample->Process(block.data(), 384);
+	TestEnsure(block[0] == unit && block[383 * 2] == unit);
+	TestEnsure(sample->IsPlaying());
+	// Stopped right away, also before the mixer gets to it
+	sample->Stop();
+	TestEnsure(!sample->IsPlaying());
+	std::fill(block.begin(), block.end(), 0.0f);
+	sample->Process(block.data(), 384);
+	TestEnsure(block[0] == 0.0f && !sample->IsPlaying());
+
+	// Only plays after the last stop are pending
+	sample->Play();
+	sample->Stop();
+	TestEnsure(!sample->IsPlaying());
+	sample->Play();
+	TestEnsure(sample->IsPlaying());
+	std::fill(block.begin(), block.end(), 0.0f);
+	sample->Process(block.data(), 384);
+	TestEnsure(block[0] == unit && !sample->IsPlaying());
+
+	sample.reset();
+	delete audio;
+}
+
+Test("Audio.Sample.PlayFromOtherThread")
+{
+	Audio* audio = new Audio();
+	const uint64 length = 100;
+	const Vector<float> pcm = MakeSamplePcm(length);
+	Sample sample = SampleRes::Create(audio, pcm.data(), length);
+
+	const uint32 numPlays = 5000;
+	const uint32 playsPerBlock = 4;
+	std::atomic<uint32> numBlocks = { 0 };
+	std::atomic<bool> done = { false };
+	float maxPlayTime = 0.0f;
+
+	// Plays a few samples, then waits for a block to be mixed, so no play has to replace another one
+	std::thread player([&]()
+	{
+		for (uint32 i = 0; i < numPlays; i += playsPerBlock)
+		{
+			const uint32 block = numBlocks.load(std::memory_order_acquire);
+			for (uint32 j = 0; j < playsPerBlock; j++)
+			{
+				Timer timer;
+				sample->Play();
+				maxPlayTime = Math::Max(maxPlayTime, timer.SecondsAsFloat());
+			}
+			while (numBlocks.load(std::memory_order_acquire) == block)
+				std::this_thread::yield();
+		}
+		done.store(true, std::memory_order_release);
+	});
+
+	// Pulls blocks like the mixer does, until every play has ended
+	Vector<float> block(384 * 2);
+	double heard = 0.0;
+	bool valid = true;
+	while (!done.load(std::memory_order_acquire) || sample->IsPlaying())
+	{
+		std::fill(block.begin(), block.end(), 0.0f);
+		sample->Process(block.data(), 384);
+		for (float value : block)
+		{
+			const float count = value / unit;
+			// A block can start the plays of the current and the last turn of the player
+			valid = valid && count == floorf(count) && count <= (float)playsPerBlock * 2;
+			heard += count;
+		}
+		numBlocks.fetch_add(1, std::memory_order_release);
+	}
+	player.join();
+
+	Logf("Mixed %d plays over %d blocks, longest play call %.3fms", Logger::Severity::Info,
+		numPlays, numBlocks.load(), maxPlayTime * 1000.0f);
+	TestEnsure(valid);
+	// Both channels of every frame of every play
+	TestEnsure((uint64)heard == numPlays * length * 2);
+
+	sample.reset();
+	delete audio;
+}
@@ -0,0 +1,174 @@
+#include "stdafx.h"
+#include <Shared/Profiling.hpp>
+using namespace Graphics;
+
+// Counters of the frame in which the render queue is processed
+static ProfilerFrame ProcessInFrame(RenderQueue& queue)
+{
+	Profiler::SetEnabled(true);
+	Profiler::BeginFrame();
+	queue.Process();
+	Profiler::EndFrame();
+	Profiler::SetEnabled(false);
+	return Profiler::GetFrames().back();
+}
+
+// Queues a text without its glyphs, the atlas stands in for the texture of the font size
+static void QueueText(Vector<RenderQueueItem*>& items, const Transform& transform, int32 atlas, Rect scissor = Rect(Vector2(), Vector2(-1)))
+{
+	TextDrawCall* tdc = new TextDrawCall();
+	tdc->params.SetParameter("mainTex", atlas);
+	tdc->worldTransform = transform;
+	tdc->scissorRect = scissor;
+	items.Add(tdc);
+}
+// Number of text draw calls the queue makes for the items
+static size_t CountTextDrawCalls(const Vector<RenderQueueItem*>& items)
+{
+	size_t numTextDrawCalls = 0;
+	for(const RenderQueue::Batch& batch : RenderQueue::GetBatches(items))
+	{
+		if(Utility::Cast<TextDrawCall>(items[batch.begin]))
+			numTextDrawCalls++;
+	}
+	return numTextDrawCalls;
+}
+static void ClearItems(Vector<RenderQueueItem*>& items)
+{
+	for(RenderQueueItem* item : items)
+		delete item;
+	items.clear();
+}
+
+Test("Graphics.TextBatch.Batches")
+{
+	auto at = [](float x, float y) { return Transform::Translation(Vector3(x, y, 0.0f)); };
+	const int32 small = 1;
+	const int32 large = 2;
+	Vector<RenderQueueItem*> items;
+
+	// Texts drawn after each other using two fonts
+	for(int32 i = 0; i < 100; i++)
+		QueueText(items, at(0.0f, 10.0f * i), small);
+	for(int32 i = 0; i < 50; i++)
+		QueueText(items, at(100.0f, 10.0f * i), large);
+	Vector<RenderQueue::Batch> batches = RenderQueue::GetBatches(items);
+	TestEnsure(batches.size() == 2);
+	TestEnsure(batches[0].begin == 0 && batches[0].end == 100);
+	TestEnsure(batches[1].begin == 100 && batches[1].end == 150);
+	TestEnsure(CountTextDrawCalls(items) == 2);
+	ClearItems(items);
+
+	// Other draws split batches to keep the drawing order
+	for(int32 i = 0; i < 2; i++)
+		QueueText(items, at(0.0f, 10.0f * i), large);
+	items.Add(new SimpleDrawCall());
+	for(int32 i = 0; i < 2; i++)
+		QueueText(items, at(0.0f, 10.0f * i), large);
+	// So do different scissor rectangles
+	QueueText(items, Transform(), large, Rect(Vector2(0.0f, 0.0f), Vector2(10.0f, 10.0f)));
+	// Texts that aren't on the XY plane are drawn by themselves
+	QueueText(items, at(0.0f, 0.0f) * Transform::Rotation(Vector3(45.0f, 0.0f, 0.0f)), large);
+	QueueText(items, Transform(), large);
+	batches = RenderQueue::GetBatches(items);
+	TestEnsure(batches.size() == 6);
+	TestEnsure(batches[0].end == 2 && batches[2].end == 5);
+	TestEnsure(CountTextDrawCalls(items) == 5);
+	ClearItems(items);
+
+	// Scaled texts stay on the XY plane, rotating out of it ends the batch
+	QueueText(items, Transform(), small);
+	QueueText(items, Transform::Scale(Vector3(2.0f, 2.0f, 1.0f)), small);
+	QueueText(items, at(0.0f, 0.0f) * Transform::Rotation(Vector3(0.0f, 45.0f, 0.0f)), small);
+	TestEnsure(CountTextDrawCalls(items) == 2);
+	ClearItems(items);
+}
+
+Test("Graphics.TextBatch")
+{
+	// Needs a window for the OpenGL context, the batching itself is tested without one by Graphics.TextBatch.Batches
+	Window window;
+	OpenGL gl;
+	TestEnsure(gl.Init(window, 0));
+	TestEnsure(FontRes::InitLibrary());
+	{
+		Font font = FontRes::Create(&gl, Path::Absolute("fonts/settings/NotoSans-Regular.ttf"));
+		Material material = MaterialRes::Create(&gl, Path::Absolute("skins/Default/shaders/font.vs"), Path::Absolute("skins/Default/shaders/font.fs"));
+		TestEnsure(font && material);
+		material->opaque = false;
+		// Texts using a different font size get a different glyph atlas as their texture
+		Text small = font->CreateText(L"Small", 16);
+		Text large = font->CreateText(L"Large", 32);
+		Mesh mesh = MeshRes::Create(&gl);
+		mesh->SetPrimitiveType(PrimitiveType::TriangleList);
+		mesh->SetData(small->GetVertices());
+
+		RenderState renderState;
+		renderState.viewportSize = Vector2i(800, 600);
+		renderState.projectionTransform = ProjectionMatrix::CreateOrthographic(0.0f, 800.0f, 600.0f, 0.0f, 0.0f, 100.0f);
+		renderState.aspectRatio = 800.0f / 600.0f;
+		renderState.time = 0.0f;
+		auto at = [](float x, float y) { return Transform::Translation(Vector3(x, y, 0.0f)); };
+
+		// Texts drawn after each other using two fonts
+		RenderQueue queue(&gl, renderState);
+		for(int32 i = 0; i < 100; i++)
+			queue.Draw(at(0.0f, 10.0f * i), small, material);
+		for(int32 i = 0; i < 50; i++)
+			queue.Draw(at(100.0f, 10.0f * i), large, material);
+		ProfilerFrame frame = ProcessInFrame(queue);
+		TestEnsure(frame.counters[(size_t)ProfilerCounter::TextDrawCalls] == 2);
+		TestEnsure(frame.counters[(size_t)ProfilerCounter::DrawCalls] == 2);
+		// Both batches are streamed in one upload
+		TestEnsure(frame.counters[(size_t)ProfilerCounter::BufferAllocations] == 1);
+
+		// Other draws split batches to keep the drawing order
+		for(int32 i = 0; i < 2; i++)
+			queue.Draw(at(0.0f, 10.0f * i), large, material);
+		queue.Draw(Transform(), mesh, material);
+		for(int32 i = 0; i < 2; i++)
+			queue.Draw(at(0.0f, 10.0f * i), large, material);
+		// So do different scissor rectangles
+		queue.DrawScissored(Rect(Vector2(0.0f, 0.0f), Vector2(10.0f, 10.0f)), Transform(), large, material);
+		// Texts that aren't on the XY plane are drawn by themselves
+		queue.Draw(at(0.0f, 0.0f) * Transform::Rotation(Vector3(45.0f, 0.0f, 0.0f)), large, material);
+		queue.Draw(Transform(), large, material);
+		frame = ProcessInFrame(queue);
+		TestEnsure(frame.counters[(size_t)ProfilerCounter::TextDrawCalls] == 5);
+		TestEnsure(frame.counters[(size_t)ProfilerCounter::DrawCalls] == 6);
+		TestEnsure(frame.counters[(size_t)ProfilerCounter::BufferAllocations] == 1);
+
+		// The next frame's queue streams into the same mesh
+		RenderQueue nextQueue(&gl, renderState);
+		for(int32 i = 0; i < 10; i++)
+			nextQueue.Draw(at(0.0f, 10.0f * i), small, material);
+		frame = ProcessInFrame(nextQueue);
+		TestEnsure(frame.counters[(size_t)ProfilerCounter::TextDrawCalls] == 1);
+		TestEnsure(frame.counters[(size_t)ProfilerCounter::BufferAllocations] == 1);
+	}
+	FontRes::FreeLibrary();
+}
+
+Test("Graphics.TextBatch.Vertices")
+{
+	Vector<TextVertex> vertices;
+	vertices.emplace_back(Vector2(0.0f, 0.0f), Vector2(1.0f, 2.0f));
+	vertices.emplace_back(Vector2(10.0f, 0.0f), Vector2(3.0f, 4.0f));
+	vertices.emplace_back(Vector2(10.0f, 20.0f), Vector2(5.0f, 6.0f));
+
+	Transform transform = Transform::Translation(Vector3(5.0f, 7.0f, 0.0f));
+	transform *= Transform::Rotation(Vector3(0.0f, 0.0f, 30.0f));
+	transform *= Transform::Scale(Vector3(2.0f, 0.5f, 1.0f));
+
+	// Same positions as transforming them in the shader
+	Vector<TextVertex> batched;
+	RenderQueue::AppendTextVertices(vertices, transform, batched);
+	TestEnsure(batched.size() == vertices.size());
+	for(size_t i = 0; i < vertices.size(); i++)
+	{
+		Vector3 expected = transform * Vector3(vertices[i].pos.x, vertices[i].pos.y, 0.0f);
+		TestEnsure(fabsf(batched[i].pos.x - expected.x) < 0.001f);
+		TestEnsure(fabsf(batched[i].pos.y - expected.y) < 0.001f);
+		TestEnsure(batched[i].tex.x == vertices[i].tex.x && batched[i].tex.y == vertices[i].tex.y);
+	}
+}
@@ -0,0 +1,68 @@
+#include <Shared/Shared.hpp>
+#include <Shared/ExpiringCache.hpp>
+#include <Tests/Tests.hpp>
+
+Test("ExpiringCache.HitMiss")
+{
+	ExpiringCache<String, int32, std::hash<std::string>> cache(1.0f);
+	TestEnsure(cache.Get("a", 0.0f) == nullptr);
+
+	cache.Add("a", 1, 0.0f);
+	cache.Add("b", 2, 0.0f);
+	TestEnsure(cache.GetSize() == 2);
+
+	int32* a = cache.Get("a", 0.5f);
+	TestEnsure(a && *a == 1);
+	TestEnsure(cache.Get("c", 0.5f) == nullptr);
+
+	// Adding an existing key replaces the value
+	cache.Add("b", 3, 0.5f);
+	TestEnsure(cache.GetSize() == 2);
+	TestEnsure(*cache.Get("b", 0.5f) == 3);
+}
+
+Test("ExpiringCache.Expiry")
+{
+	ExpiringCache<String, int32, std::hash<std::string>> cache(1.0f);
+	cache.Add("old", 1, 0.0f);
+	cache.Add("used", 2, 0.0f);
+	cache.Add("new", 3, 0.8f);
+
+	// Using an entry keeps it alive
+	TestEnsure(cache.Get("used", 0.9f) != nullptr);
+
+	cache.Expire(1.0f);
+	TestEnsure(cache.GetSize() == 3);
+
+	cache.Expire(1.5f);
+	TestEnsure(cache.GetSize() == 2);
+	TestEnsure(cache.Get("old", 1.5f) == nullptr);
+	TestEnsure(cache.Get("new", 1.5f) != nullptr);
+	TestEnsure(cache.Get("used", 1.5f) != nullptr);
+
+	cache.Expire(3.0f);
+	TestEnsure(cache.GetSize() == 0);
+
+	// Expired keys can be added again
+	cache.Add("old", 4, 3.0f);
+	TestEnsure(*cache.Get("old", 3.0f) == 4);
+}
+
+Test("ExpiringCache.ManyEntries")
+{
+	// Expiring a large cache where nothing is expired only looks at the oldest entry
+	ExpiringCache<int32, int32> cache(1.0f);
+	const int32 count = 100000;
+	for (int32 i = 0; i < count; i++)
+	{
+		cache.Expire(0.5f);
+		cache.Add(i, i, 0.5f);
+	}
+	TestEnsure(cache.GetSize() == (size_t)count);
+	for (int32 i = 0; i < count; i += 2)
+		cache.Get(i, 1.0f);
+	cache.Expire(1.6f);
+	TestEnsure(cache.GetSize() == (size_t)count / 2);
+	TestEnsure(cache.Get(1, 1.6f) == nullptr);
+	TestEnsure(cache.Get(2, 1.6f) != nullptr);
+}
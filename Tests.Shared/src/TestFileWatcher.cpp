@@ -0,0 +1,98 @@
+#include <Shared/Shared.hpp>
+#include <Shared/FileWatcher.hpp>
+#include <Shared/Thread.hpp>
+#include <Tests/Tests.hpp>
+
+static void WriteTestFile(const String& path, const String& contents)
+{
+	File file;
+	TestEnsure(file.OpenWrite(path));
+	file.Write(*contents, contents.size());
+}
+
+// Waits for the next reported changes
+static Vector<FileChange> WaitForChanges(FileWatcher& watcher)
+{
+	Timer timer;
+	while(timer.SecondsAsFloat() < 10.0f)
+	{
+		Vector<FileChange> changes = watcher.GetChanges(0.1f);
+		if(!changes.empty())
+			return changes;
+	}
+	return Vector<FileChange>();
+}
+
+static void TestFileWatcher(bool native)
+{
+	const String root = Path::Normalize(Path::GetCurrentPath() + "/file_watcher_test");
+	if(Path::IsDirectory(root))
+		Path::DeleteDir(root);
+	TestEnsure(Path::CreateDir(root));
+	WriteTestFile(Path::Normalize(root + "/a.ksh"), "a");
+
+	Vector<String> exts = { "ksh" };
+	FileWatcher watcher(exts, native);
+	TestEnsure(watcher.IsNative() == native);
+	watcher.debounceTime = 0.3f;
+	watcher.pollInterval = 0.1f;
+	watcher.Watch(root);
+	Map<String, FileInfo> files;
+	for(FileInfo& fi : Files::ScanFilesRecursive(root, "ksh"))
+		files.Add(fi.fullPath, fi);
+	watcher.SetFiles(files);
+
+	// Known files aren't reported
+	TestEnsure(watcher.GetChanges(0.5f).empty());
+
+	// Only files with the given extension are reported
+	const String newPath = Path::Normalize(root + "/b.ksh");
+	WriteTestFile(newPath, "b");
+	WriteTestFile(Path::Normalize(root + "/b.txt"), "b");
+	Vector<FileChange> changes = WaitForChanges(watcher);
+	TestEnsure(changes.size() == 1);
+	TestEnsure(changes[0].path == newPath && !changes[0].removed);
+
+	// Files written shortly after each other are reported at once, including ones in new folders
+	const String packPath = Path::Normalize(root + "/pack");
+	const int32 numPackFiles = 20;
+	Thread writer([&]()
+	{
+		Path::CreateDir(packPath);
+		for(int32 i = 0; i < numPackFiles; i++)
+		{
+			WriteTestFile(Path::Normalize(packPath + Utility::Sprintf("/%d.ksh", i)), "pack");
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	});
+	changes = WaitForChanges(watcher);
+	writer.join();
+	TestEnsure(changes.size() == (size_t)numPackFiles);
+
+	// Removed files and folders
+	Path::Delete(newPath);
+	changes = WaitForChanges(watcher);
+	TestEnsure(changes.size() == 1);
+	TestEnsure(changes[0].path == newPath && changes[0].removed);
+
+	Path::DeleteDir(packPath);
+	changes = WaitForChanges(watcher);
+	TestEnsure(changes.size() == (size_t)numPackFiles);
+	for(FileChange& change : changes)
+		TestEnsure(change.removed);
+
+	TestEnsure(watcher.GetChanges(0.5f).empty());
+	Path::DeleteDir(root);
+}
+
+#ifdef __linux__
+Test("FileWatcher.Native")
+{
+	TestFileWatcher(true);
+}
+#endif
+
+Test("FileWatcher.Polling")
+{
+	TestFileWatcher(false);
+}
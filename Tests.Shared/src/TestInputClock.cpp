@@ -0,0 +1,12 @@
+#include <Shared/Shared.hpp>
+#include <Shared/InputClock.hpp>
+#include <Tests/Tests.hpp>
+
+Test("InputClock.ToMilliseconds")
+{
+	TestEnsure(InputClock::ToMilliseconds(0) == 0);
+	TestEnsure(InputClock::ToMilliseconds(499) == 0);
+	TestEnsure(InputClock::ToMilliseconds(500) == 1);
+	TestEnsure(InputClock::ToMilliseconds(2499) == 2);
+	TestEnsure(InputClock::ToMilliseconds(-1500) == -2);
+}
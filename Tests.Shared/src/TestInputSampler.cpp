@@ -0,0 +1,87 @@
+#include <Shared/Shared.hpp>
+#include <Shared/InputSampler.hpp>
+#include <Tests/Tests.hpp>
+
+Test("InputSampler.SyntheticLatency")
+{
+	auto source = Ref<SyntheticInputSource>(new SyntheticInputSource());
+	InputSampler sampler;
+	sampler.AddSource(source);
+
+	// Alternating press/release of a few buttons every 1.5ms
+	const uint32 numEvents = 200;
+	const int64 start = InputClock::Now() + 20000;
+	for (uint32 i = 0; i < numEvents; i++)
+		source->Schedule(start + i * 1500, 0, i % 4, (i / 4) % 2 == 0);
+
+	TestEnsure(sampler.Start(1000));
+
+	Vector<int64> latencies;
+	int64 lastTimestamp = 0;
+	bool inOrder = true;
+	const int64 timeout = start + numEvents * 1500 + 2000000;
+	while (latencies.size() < numEvents && InputClock::Now() < timeout)
+	{
+		TimedInputEvent evt;
+		while (sampler.Pop(evt))
+		{
+			latencies.Add(InputClock::Now() - evt.timestamp);
+			inOrder &= evt.timestamp >= lastTimestamp;
+			lastTimestamp = evt.timestamp;
+		}
+		std::this_thread::yield();
+	}
+	sampler.Stop();
+
+	TestEnsure(latencies.size() == numEvents);
+	TestEnsure(source->GetPendingCount() == 0);
+	TestEnsure(sampler.GetDroppedCount() == 0);
+	TestEnsure(inOrder);
+
+	int64 maxLatency = 0;
+	double mean = 0.0;
+	for (int64 l : latencies)
+	{
+		maxLatency = Math::Max(maxLatency, l);
+		mean += l;
+	}
+	mean /= latencies.size();
+	double variance = 0.0;
+	for (int64 l : latencies)
+		variance += (l - mean) * (l - mean);
+	const double jitter = sqrt(variance / latencies.size());
+
+	Logf("Input latency: mean %.1fus, max %dus, jitter %.1fus", Logger::Severity::Info, mean, (int32)maxLatency, jitter);
+
+	// Events are picked up within a sampling period of 1ms, the bounds are loose since scheduling on loaded machines
+	//	can add a lot on top of that
+	TestEnsure(mean >= 0.0 && mean < 20000.0);
+	TestEnsure(jitter < 10000.0);
+}
+
+Test("InputSampler.Dropped")
+{
+	auto source = Ref<SyntheticInputSource>(new SyntheticInputSource());
+	InputSampler sampler(16);
+	sampler.AddSource(source);
+
+	// Nothing is popped, so only the events that fit in the queue are kept
+	const uint32 numEvents = 40;
+	const int64 now = InputClock::Now();
+	for (uint32 i = 0; i < numEvents; i++)
+		source->Schedule(now + i, 0, i, true);
+	TestEnsure(sampler.Start(1000));
+	Timer timer;
+	while (source->GetPendingCount() > 0 && timer.SecondsAsFloat() < 5.0f)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	sampler.Stop();
+
+	TestEnsure(sampler.GetDroppedCount() == numEvents - 16);
+	TimedInputEvent evt;
+	for (uint32 i = 0; i < 16; i++)
+	{
+		TestEnsure(sampler.Pop(evt));
+		TestEnsure(evt.code == i);
+	}
+	TestEnsure(!sampler.Pop(evt));
+}
@@ -0,0 +1,116 @@
+#include <Shared/Shared.hpp>
+#include <Shared/LuaLazyList.hpp>
+#include <Tests/Tests.hpp>
+
+static bool RunLua(lua_State* L, const char* code)
+{
+	if (luaL_dostring(L, code) != 0)
+	{
+		Logf("Lua error: %s", Logger::Severity::Error, lua_tostring(L, -1));
+		lua_pop(L, 1);
+		return false;
+	}
+	return true;
+}
+
+static bool LuaCheck(lua_State* L, const char* expression)
+{
+	String code = Utility::Sprintf("return %s", expression);
+	if (luaL_dostring(L, *code) != 0)
+	{
+		Logf("Lua error: %s", Logger::Severity::Error, lua_tostring(L, -1));
+		lua_pop(L, 1);
+		return false;
+	}
+	bool result = lua_toboolean(L, -1);
+	lua_pop(L, 1);
+	return result;
+}
+
+Test("LuaLazyList.Songs")
+{
+	lua_State* L = luaL_newstate();
+	luaL_openlibs(L);
+
+	const size_t numSongs = 50000;
+	// Destroyed before the state is closed
+	std::unique_ptr<LuaLazyList> list = std::make_unique<LuaLazyList>(L, 16);
+	LuaLazyList& songs = *list;
+
+	Timer timer;
+	songs.Set(numSongs, [](lua_State* L, size_t index)
+	{
+		lua_newtable(L);
+		lua_pushinteger(L, (lua_Integer)index * 10);
+		lua_setfield(L, -2, "id");
+		lua_pushstring(L, *Utility::Sprintf("Song %d", (int32)index));
+		lua_setfield(L, -2, "title");
+	});
+	songs.Push();
+	lua_setglobal(L, "songs");
+	const float pushTime = timer.SecondsAsFloat();
+	Logf("Pushed %d songs in %.3fms", Logger::Severity::Info, (int32)numSongs, pushTime * 1000.0f);
+
+	// Nothing is created before it is used
+	TestEnsure(songs.GetNumCreated() == 0);
+	TestEnsure(lua_gettop(L) == 0);
+
+	TestEnsure(LuaCheck(L, "#songs == 50000"));
+	TestEnsure(LuaCheck(L, "type(songs) == 'table'"));
+	TestEnsure(LuaCheck(L, "songs[1].id == 0 and songs[1].title == 'Song 0'"));
+	TestEnsure(LuaCheck(L, "songs[50000].id == 499990"));
+	TestEnsure(LuaCheck(L, "songs[0] == nil and songs[50001] == nil and songs.title == nil"));
+	TestEnsure(songs.GetNumCreated() == 2);
+
+	// Cached elements are the same table
+	TestEnsure(LuaCheck(L, "songs[1] == songs[1]"));
+	TestEnsure(songs.GetNumCreated() == 2);
+
+	// Iterating the visible part repeatedly hits the cache
+	TestEnsure(RunLua(L, "for f = 1, 10 do for i = 100, 110 do assert(songs[i].id == (i - 1) * 10) end end"));
+	TestEnsure(songs.GetNumCreated() == 2 + 11);
+
+	// Least recently used elements are evicted
+	TestEnsure(RunLua(L, "for i = 1000, 1100 do local s = songs[i] end"));
+	const size_t created = songs.GetNumCreated();
+	TestEnsure(LuaCheck(L, "songs[100].id == 990"));
+	TestEnsure(songs.GetNumCreated() == created + 1);
+
+	TestEnsure(LuaCheck(L, "(function() local n = 0 for i, s in ipairs(songs) do n = n + 1 end return n end)() == 50000"));
+	TestEnsure(LuaCheck(L, "(function() local n = 0 for i, s in pairs(songs) do assert(s.id == (i - 1) * 10) n = n + 1 end return n end)() == 50000"));
+
+	// Replacing the contents is visible through the already pushed table
+	songs.Set(3, [](lua_State* L, size_t index)
+	{
+		lua_pushinteger(L, (lua_Integer)index);
+	});
+	TestEnsure(songs.GetNumCreated() == 0);
+	TestEnsure(LuaCheck(L, "#songs == 3 and songs[3] == 2 and songs[4] == nil"));
+
+	list.reset();
+	lua_close(L);
+}
+
+Test("LuaLazyList.ReleasesCache")
+{
+	lua_State* L = luaL_newstate();
+	luaL_openlibs(L);
+
+	std::unique_ptr<LuaLazyList> list = std::make_unique<LuaLazyList>(L);
+	list->Set(10, [](lua_State* L, size_t index)
+	{
+		lua_newtable(L);
+	});
+	list->Push();
+	lua_setglobal(L, "songs");
+
+	// Only the cache of the list refers to the created element
+	TestEnsure(RunLua(L, "weak = setmetatable({}, { __mode = 'v' }) weak[1] = songs[1] songs = nil collectgarbage()"));
+	TestEnsure(LuaCheck(L, "weak[1] ~= nil"));
+
+	list.reset();
+	TestEnsure(RunLua(L, "collectgarbage()"));
+	TestEnsure(LuaCheck(L, "weak[1] == nil"));
+
+	lua_close(L);
+}
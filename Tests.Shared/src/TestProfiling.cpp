@@ -0,0 +1,129 @@
+#include <Shared/Shared.hpp>
+#include <Shared/Profiling.hpp>
+#include <Shared/Thread.hpp>
+#include <Shared/File.hpp>
+#include <Tests/Tests.hpp>
+
+Test("Profiler.NestedZones")
+{
+	Profiler::SetEnabled(true);
+
+	const int64 begin = Profiler::Now();
+	{
+		ProfilerZone outer("Test.Outer");
+		for (int i = 0; i < 3; i++)
+		{
+			ProfilerZone inner("Test.Inner", ProfilerCounter::LuaTime);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+	uint32 otherThreadId = 0;
+	Thread thread([&]()
+	{
+		Profiler::SetThreadName("Test thread");
+		otherThreadId = Profiler::GetThreadId();
+		ProfilerZone zone("Test.Thread");
+	});
+	thread.join();
+	const int64 end = Profiler::Now() + 1;
+
+	TestEnsure(otherThreadId != Profiler::GetThreadId());
+
+	Vector<ProfilerZoneSummary> summary = Profiler::GetZoneSummary(begin, end);
+	const ProfilerZoneSummary* outer = nullptr;
+	const ProfilerZoneSummary* inner = nullptr;
+	const ProfilerZoneSummary* threaded = nullptr;
+	for (auto& s : summary)
+	{
+		if (strcmp(s.name, "Test.Outer") == 0) outer = &s;
+		if (strcmp(s.name, "Test.Inner") == 0) inner = &s;
+		if (strcmp(s.name, "Test.Thread") == 0) threaded = &s;
+	}
+	TestEnsure(outer && inner && threaded);
+	TestEnsure(outer->calls == 1);
+	TestEnsure(inner->calls == 3);
+	TestEnsure(outer->totalTime >= inner->totalTime);
+	TestEnsure(threaded->threadId == otherThreadId);
+
+	Profiler::SetEnabled(false);
+}
+
+Test("Profiler.FrameCounters")
+{
+	Profiler::SetEnabled(true);
+	for (int i = 0; i < (int)Profiler::frameBufferSize + 10; i++)
+	{
+		Profiler::BeginFrame();
+		Profiler::AddCounter(ProfilerCounter::DrawCalls, i);
+		Profiler::EndFrame();
+	}
+
+	Vector<ProfilerFrame> frames = Profiler::GetFrames();
+	TestEnsure(frames.size() == Profiler::frameBufferSize);
+	TestEnsure(frames.back().counters[(size_t)ProfilerCounter::DrawCalls] == (int64)Profiler::frameBufferSize + 9);
+	for (size_t i = 1; i < frames.size(); i++)
+		TestEnsure(frames[i].index == frames[i - 1].index + 1);
+
+	// Counters are not recorded while disabled
+	Profiler::SetEnabled(false);
+	Profiler::AddCounter(ProfilerCounter::DrawCalls, 100);
+	Profiler::SetEnabled(true);
+	Profiler::BeginFrame();
+	Profiler::EndFrame();
+	TestEnsure(Profiler::GetFrames().back().counters[(size_t)ProfilerCounter::DrawCalls] == 0);
+	Profiler::SetEnabled(false);
+}
+
+Test("Profiler.ExportChromeTrace")
+{
+	Profiler::SetEnabled(true);
+	{
+		ProfilerZone zone("Test \"Quoted\"");
+	}
+	Profiler::SetEnabled(false);
+
+	String path = TestFilename;
+	TestEnsure(Profiler::ExportChromeTrace(path));
+
+	File file;
+	TestEnsure(file.OpenRead(path));
+	String json;
+	json.resize(file.GetSize());
+	file.Read(&json[0], json.size());
+
+	TestEnsure(json.find("\"traceEvents\"") != String::npos);
+	TestEnsure(json.find("Test \\\"Quoted\\\"") != String::npos);
+	TestEnsure(json.find("\"thread_name\"") != String::npos);
+	TestEnsure(json.find("\"DrawCalls\"") != String::npos);
+}
+
+Test("Profiler.ThreadNameWhileDisabled")
+{
+	// Naming a thread doesn't allocate its zone buffer, it's only kept for when the thread records zones
+	Profiler::SetEnabled(false);
+	Thread idle([]()
+	{
+		Profiler::SetThreadName("Test idle thread");
+	});
+	idle.join();
+	Thread recording([]()
+	{
+		Profiler::SetThreadName("Test recording thread");
+		Profiler::SetEnabled(true);
+		ProfilerZone zone("Test.Named");
+	});
+	recording.join();
+	Profiler::SetEnabled(false);
+
+	String path = TestFilename;
+	TestEnsure(Profiler::ExportChromeTrace(path));
+
+	File file;
+	TestEnsure(file.OpenRead(path));
+	String json;
+	json.resize(file.GetSize());
+	file.Read(&json[0], json.size());
+
+	TestEnsure(json.find("Test idle thread") == String::npos);
+	TestEnsure(json.find("Test recording thread") != String::npos);
+}
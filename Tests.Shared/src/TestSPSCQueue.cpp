@@ -0,0 +1,75 @@
+#include <Shared/Shared.hpp>
+#include <Shared/SPSCQueue.hpp>
+#include <Shared/Thread.hpp>
+#include <Tests/Tests.hpp>
+
+Test("SPSCQueue.Order")
+{
+	SPSCQueue<int32> queue(5);
+	TestEnsure(queue.Capacity() == 8);
+
+	for (int32 i = 0; i < 8; i++)
+		TestEnsure(queue.TryPush(i));
+	TestEnsure(!queue.TryPush(8));
+
+	int32 value;
+	for (int32 i = 0; i < 8; i++)
+	{
+		TestEnsure(queue.TryPop(value));
+		TestEnsure(value == i);
+	}
+	TestEnsure(!queue.TryPop(value));
+}
+
+Test("SPSCQueue.Peek")
+{
+	SPSCQueue<int32> queue(4);
+	int32 value;
+	TestEnsure(!queue.TryPeek(value));
+
+	TestEnsure(queue.TryPush(1));
+	TestEnsure(queue.TryPush(2));
+	// Peeking leaves the item in the queue
+	TestEnsure(queue.TryPeek(value) && value == 1);
+	TestEnsure(queue.TryPeek(value) && value == 1);
+	TestEnsure(queue.Size() == 2);
+	TestEnsure(queue.TryPop(value) && value == 1);
+	TestEnsure(queue.TryPeek(value) && value == 2);
+}
+
+Test("SPSCQueue.Threaded")
+{
+	SPSCQueue<uint32> queue(64);
+	const uint32 count = 20000;
+
+	Thread producer([&]()
+	{
+		for (uint32 i = 0; i < count;)
+		{
+			if (queue.TryPush(i))
+				i++;
+			else
+				std::this_thread::yield();
+		}
+	});
+
+	uint32 expected = 0;
+	bool inOrder = true;
+	while (expected < count)
+	{
+		uint32 value;
+		if (queue.TryPop(value))
+		{
+			inOrder &= value == expected;
+			expected++;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+
+	TestEnsure(inOrder);
+	TestEnsure(queue.IsEmpty());
+}
@@ -0,0 +1,113 @@
+#include <Shared/Shared.hpp>
+#include <Shared/SortKey.hpp>
+#include <Tests/Tests.hpp>
+#include <random>
+
+static Vector<String> GenerateTitles(size_t count)
+{
+	static const char* words[] = { "night", "Sky", "LOVE", "dream", "star", "Fire", "world", "heart", "Light", "the", "of", "DRIVE" };
+	std::mt19937 rng(1234);
+	Vector<String> titles;
+	titles.reserve(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		String title;
+		const uint32 numWords = 1 + rng() % 4;
+		for (uint32 w = 0; w < numWords; w++)
+		{
+			if (w > 0)
+				title += ' ';
+			title += words[rng() % (sizeof(words) / sizeof(*words))];
+		}
+		titles.Add(title);
+	}
+	return titles;
+}
+
+// Comparator used by the song sorts before keys were precomputed
+static bool CompareUpperCopies(const Vector<String>& titles, uint32 ia, uint32 ib)
+{
+	String a = titles[ia];
+	String b = titles[ib];
+	a.ToUpper();
+	b.ToUpper();
+	int res = a.compare(b);
+	if (res == 0)
+		return ia < ib;
+	return res < 0;
+}
+
+// Entries the way the song sorts make them, the title is the key when sorting by title and there's no key when sorting by a value
+static Vector<SortKey::Entry> MakeEntries(const Vector<String>& titles, const Vector<String>* keys = nullptr, const Vector<uint64>* values = nullptr)
+{
+	Vector<SortKey::Entry> entries;
+	entries.reserve(titles.size());
+	for (uint32 i = 0; i < titles.size(); i++)
+	{
+		const String* key = keys ? &(*keys)[i] : (values ? nullptr : &titles[i]);
+		entries.Add({ values ? (*values)[i] : 0, key, &titles[i], i });
+	}
+	return entries;
+}
+
+Test("SortKey.Order")
+{
+	Vector<String> titles = { SortKey::Make("beta"), SortKey::Make("Alpha"), SortKey::Make("ALPHA"), SortKey::Make("gamma") };
+	Vector<SortKey::Entry> entries = MakeEntries(titles);
+
+	SortKey::Sort(entries);
+	TestEnsure(entries[0].id == 1 && entries[1].id == 2 && entries[2].id == 0 && entries[3].id == 3);
+
+	// Sorting by title in reverse reverses the ties too
+	SortKey::Sort(entries, true, true);
+	TestEnsure(entries[0].id == 3 && entries[1].id == 0 && entries[2].id == 2 && entries[3].id == 1);
+
+	// Sorting by a value in reverse keeps ties in ascending order of title and id
+	Vector<uint64> values = { 1, 1, 1, 2 };
+	entries = MakeEntries(titles, nullptr, &values);
+	SortKey::Sort(entries, true);
+	TestEnsure(entries[0].id == 3 && entries[1].id == 1 && entries[2].id == 2 && entries[3].id == 0);
+
+	// Same for a key, like the artist
+	Vector<String> artists = { SortKey::Make("b"), SortKey::Make("a"), SortKey::Make("a"), SortKey::Make("A") };
+	entries = MakeEntries(titles, &artists);
+	SortKey::Sort(entries, true);
+	TestEnsure(entries[0].id == 0 && entries[1].id == 1 && entries[2].id == 2 && entries[3].id == 3);
+}
+
+Test("SortKey.Benchmark")
+{
+	const size_t count = 50000;
+	Vector<String> titles = GenerateTitles(count);
+
+	Vector<uint32> before;
+	for (uint32 i = 0; i < count; i++)
+		before.Add(i);
+	Timer timer;
+	std::sort(before.begin(), before.end(), [&](uint32 a, uint32 b) { return CompareUpperCopies(titles, a, b); });
+	const float copyTime = timer.SecondsAsFloat();
+
+	// Keys are computed once at load time and are not part of the sort
+	Vector<String> keys;
+	keys.reserve(count);
+	for (auto& title : titles)
+		keys.Add(SortKey::Make(title));
+
+	// Gathering the entries is part of every sort by title
+	timer.Restart();
+	Vector<SortKey::Entry> entries = MakeEntries(keys);
+	SortKey::Sort(entries);
+	const float keyTime = timer.SecondsAsFloat();
+
+	Logf("Sorting %d titles: %.2fms comparing copies, %.2fms with sort keys", Logger::Severity::Info,
+		(int32)count, copyTime * 1000.0f, keyTime * 1000.0f);
+
+	// Same order as before
+	for (size_t i = 0; i < count; i++)
+		TestEnsure(entries[i].id == before[i]);
+
+	// And the exact reverse when sorting by title in reverse
+	SortKey::Sort(entries, true, true);
+	for (size_t i = 0; i < count; i++)
+		TestEnsure(entries[i].id == before[count - 1 - i]);
+}
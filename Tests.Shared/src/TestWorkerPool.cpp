@@ -0,0 +1,105 @@
+#include <Shared/Shared.hpp>
+#include <Shared/WorkerPool.hpp>
+#include <Tests/Tests.hpp>
+#include <atomic>
+#include <set>
+
+Test("WorkerPool.RunsAllTasks")
+{
+	WorkerPool pool(3);
+	TestEnsure(pool.GetNumThreads() == 3);
+
+	std::atomic<int32> sum(0);
+	Mutex lock;
+	std::set<std::thread::id> threadIds;
+	for(int32 i = 1; i <= 1000; i++)
+	{
+		pool.Queue([&, i]()
+		{
+			sum += i;
+			std::lock_guard<std::mutex> guard(lock);
+			threadIds.insert(std::this_thread::get_id());
+		});
+	}
+	pool.Wait();
+	TestEnsure(sum == 500500);
+	TestEnsure(pool.GetNumQueued() == 0);
+	// Tasks only ever run on the pool's threads
+	TestEnsure(threadIds.size() <= 3);
+	TestEnsure(threadIds.count(std::this_thread::get_id()) == 0);
+}
+
+Test("WorkerPool.TasksQueueTasks")
+{
+	// Tasks can queue follow up tasks, like decoding the next frame of an animation
+	WorkerPool pool(2);
+	std::atomic<int32> numRun(0);
+	std::function<void(int32)> chain = [&](int32 remaining)
+	{
+		numRun++;
+		if(remaining > 0)
+			pool.Queue([&chain, remaining]() { chain(remaining - 1); });
+	};
+	for(int32 i = 0; i < 10; i++)
+		pool.Queue([&chain]() { chain(99); });
+	pool.Wait();
+	TestEnsure(numRun == 1000);
+}
+
+Test("WorkerPool.DropsQueuedTasks")
+{
+	std::atomic<bool> release(false);
+	std::atomic<int32> numRun(0);
+	Thread releaser;
+	{
+		WorkerPool pool(1);
+		pool.Queue([&]()
+		{
+			while(!release)
+				std::this_thread::yield();
+			numRun++;
+		});
+		for(int32 i = 0; i < 10; i++)
+			pool.Queue([&]() { numRun++; });
+
+		// Let the running task finish while the pool is being destroyed
+		releaser = Thread([&]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			release = true;
+		});
+	}
+	releaser.join();
+	TestEnsure(numRun <= 1);
+}
+
+Test("WorkerPool.CancelsTasksOfOwner")
+{
+	std::atomic<bool> started(false);
+	std::atomic<bool> release(false);
+	std::atomic<int32> numRun(0);
+	// Released when a task is destroyed, whether it ran or was dropped
+	Ref<int32> held = std::make_shared<int32>(0);
+	int32 owner = 0;
+	WorkerPool pool(1);
+	pool.Queue([&]()
+	{
+		started = true;
+		while(!release)
+			std::this_thread::yield();
+	});
+	while(!started)
+		std::this_thread::yield();
+	for(int32 i = 0; i < 10; i++)
+	{
+		pool.Queue([&, held]() { numRun++; }, &owner);
+		pool.Queue([&]() { numRun++; });
+	}
+
+	TestEnsure(pool.Cancel(&owner) == 10);
+	TestEnsure(held.use_count() == 1);
+	TestEnsure(pool.GetNumQueued() == 10);
+	release = true;
+	pool.Wait();
+	TestEnsure(numRun == 10);
+}
@@ -4,6 +4,7 @@
 #  Vorbis_INCLUDE_DIR - where to find vorbis.h, etc.
 #  OGG_INCLUDE_DIR    - where to find ogg/ogg.h, etc.
 #  Vorbis_LIBRARIES   - List of libraries when using vorbis(file).
+#  VorbisENC_LIBRARY  - vorbisenc library if found, optional and only used by tests.
 #  Vorbis_FOUND       - True if vorbis found.
 
 if(Vorbis_INCLUDE_DIR)
@@ -16,6 +17,7 @@ find_path(Vorbis_INCLUDE_DIR vorbis/vorbisfile.h)
 find_library(OGG_LIBRARY NAMES ogg ogg_static)
 find_library(Vorbis_LIBRARY NAMES vorbis vorbis_static)
 find_library(VorbisFILE_LIBRARY NAMES vorbisfile vorbisfile_static)
+find_library(VorbisENC_LIBRARY NAMES vorbisenc vorbisenc_static)
 # Handle the QUIETLY and REQUIRED arguments and set Vorbis_FOUND
 # to TRUE if all listed variables are TRUE.
 include(FindPackageHandleStandardArgs)
@@ -31,5 +33,5 @@ else(Vorbis_FOUND)
 endif(Vorbis_FOUND)
 
 mark_as_advanced(OGG_INCLUDE_DIR Vorbis_INCLUDE_DIR)
-mark_as_advanced(OGG_LIBRARY Vorbis_LIBRARY VorbisFILE_LIBRARY)
+mark_as_advanced(OGG_LIBRARY Vorbis_LIBRARY VorbisFILE_LIBRARY VorbisENC_LIBRARY)
 